@@ -1,3 +1,5 @@
+#include <bit>
+#include <functional>
 #include <iomanip>
 #include <memory>
 
@@ -137,4 +139,124 @@ std::ostream& operator<<(std::ostream& stream, DisplayPretty const& self) {
     return stream;
 }
 
+bool structurally_equal(Element const& a, Element const& b) {
+    Element const* left = &a;
+    Element const* right = &b;
+
+    // Walk lists iteratively, so long lists don't overflow the stack
+    while (left->kind == ElementKind::CONS && right->kind == ElementKind::CONS) {
+        auto left_cons = static_cast<Cons const*>(left);
+        auto right_cons = static_cast<Cons const*>(right);
+        if (!structurally_equal(*left_cons->left, *right_cons->left)) {
+            return false;
+        }
+        left = left_cons->right.get();
+        right = right_cons->right.get();
+    }
+
+    if (left->kind != right->kind) {
+        return false;
+    }
+
+    switch (left->kind) {
+    case ElementKind::INTEGER:
+        return static_cast<Integer const*>(left)->value ==
+               static_cast<Integer const*>(right)->value;
+    case ElementKind::REAL:
+        return std::bit_cast<uint64_t>(static_cast<Real const*>(left)->value) ==
+               std::bit_cast<uint64_t>(static_cast<Real const*>(right)->value);
+    case ElementKind::BOOLEAN:
+        return static_cast<Boolean const*>(left)->value ==
+               static_cast<Boolean const*>(right)->value;
+    case ElementKind::SYMBOL:
+        return static_cast<Symbol const*>(left)->value ==
+               static_cast<Symbol const*>(right)->value;
+    case ElementKind::NULL_:
+        return true;
+    default:
+        return left == right;
+    }
+}
+
+size_t combine_hashes(size_t seed, size_t hash) {
+    return seed ^ (hash + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+}
+
+size_t structural_hash(Element const& element) {
+    size_t hash = static_cast<size_t>(element.kind);
+
+    Element const* current = &element;
+    while (current->kind == ElementKind::CONS) {
+        auto cons = static_cast<Cons const*>(current);
+        hash = combine_hashes(hash, structural_hash(*cons->left));
+        current = cons->right.get();
+    }
+
+    switch (current->kind) {
+    case ElementKind::INTEGER:
+        return combine_hashes(
+            hash, std::hash<int64_t>()(static_cast<Integer const*>(current)->value)
+        );
+    case ElementKind::REAL:
+        return combine_hashes(
+            hash,
+            std::hash<uint64_t>()(
+                std::bit_cast<uint64_t>(static_cast<Real const*>(current)->value)
+            )
+        );
+    case ElementKind::BOOLEAN:
+        return combine_hashes(hash, static_cast<Boolean const*>(current)->value);
+    case ElementKind::SYMBOL:
+        return combine_hashes(
+            hash,
+            std::hash<std::string>()(static_cast<Symbol const*>(current)->value)
+        );
+    case ElementKind::NULL_:
+        return combine_hashes(hash, 0);
+    default:
+        return combine_hashes(hash, std::hash<Element const*>()(current));
+    }
+}
+
+std::ostream& operator<<(std::ostream& stream, ElementKind kind) {
+    switch (kind) {
+    case ElementKind::INTEGER:
+        return stream << "integer";
+    case ElementKind::REAL:
+        return stream << "real";
+    case ElementKind::BOOLEAN:
+        return stream << "boolean";
+    case ElementKind::SYMBOL:
+        return stream << "symbol";
+    case ElementKind::NULL_:
+        return stream << "null";
+    case ElementKind::CONS:
+        return stream << "cons";
+    case ElementKind::FUNCTION:
+        return stream << "function";
+    }
+    return stream;
+}
+
+std::ostream& operator<<(std::ostream& stream, Kinds kinds) {
+    if (kinds == Kinds::all()) {
+        return stream << "any";
+    }
+
+    stream << '{';
+    bool first = true;
+    for (int kind = 0; kind <= static_cast<int>(ElementKind::FUNCTION);
+         ++kind) {
+        if (!kinds.contains(static_cast<ElementKind>(kind))) {
+            continue;
+        }
+        if (!first) {
+            stream << ", ";
+        }
+        stream << static_cast<ElementKind>(kind);
+        first = false;
+    }
+    return stream << '}';
+}
+
 } // namespace ast
@@ -107,6 +107,12 @@ class Cons : public List {
     virtual void _display_pretty(std::ostream& stream) const;
 };
 
+// Compare and hash elements by their contents, e.g. to use them as cache keys.
+// Reals are compared bitwise, so `0.0` and `-0.0` differ, and functions are
+// compared by identity.
+bool structurally_equal(Element const& a, Element const& b);
+size_t structural_hash(Element const& element);
+
 class DisplayVerbose {
     Element* element;
     size_t depth;
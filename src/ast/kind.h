@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <ostream>
+
 namespace ast {
 
 enum class ElementKind {
@@ -12,4 +15,41 @@ enum class ElementKind {
     FUNCTION,
 };
 
-}
+std::ostream& operator<<(std::ostream& stream, ElementKind kind);
+
+// A set of element kinds, e.g. the kinds an expression may evaluate to.
+class Kinds {
+    uint8_t bits;
+
+    constexpr explicit Kinds(uint8_t bits) : bits(bits) {}
+
+  public:
+    constexpr Kinds() : bits(0) {}
+    constexpr Kinds(ElementKind kind) : bits(1 << static_cast<int>(kind)) {}
+
+    static constexpr Kinds all() { return Kinds(uint8_t(0x7f)); }
+
+    constexpr bool empty() const { return this->bits == 0; }
+    constexpr bool contains(ElementKind kind) const {
+        return (this->bits & Kinds(kind).bits) != 0;
+    }
+    // Whether `kind` is the only kind in the set
+    constexpr bool is(ElementKind kind) const {
+        return this->bits == Kinds(kind).bits;
+    }
+    constexpr bool is_subset_of(Kinds other) const {
+        return (this->bits & ~other.bits) == 0;
+    }
+
+    constexpr Kinds operator|(Kinds other) const {
+        return Kinds(uint8_t(this->bits | other.bits));
+    }
+    constexpr Kinds operator&(Kinds other) const {
+        return Kinds(uint8_t(this->bits & other.bits));
+    }
+    constexpr bool operator==(Kinds const& other) const = default;
+
+    friend std::ostream& operator<<(std::ostream& stream, Kinds kinds);
+};
+
+} // namespace ast
@@ -0,0 +1,330 @@
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+
+#include "assembler.h"
+
+namespace evaluator {
+
+uint8_t encoding(Register value) { return static_cast<uint8_t>(value); }
+uint8_t encoding(FloatRegister value) { return static_cast<uint8_t>(value); }
+
+void Assembler::byte(uint8_t value) { this->code.push_back(value); }
+
+void Assembler::bytes32(uint32_t value) {
+    for (size_t index = 0; index < 4; ++index) {
+        this->byte(static_cast<uint8_t>(value >> (8 * index)));
+    }
+}
+
+void Assembler::rex(bool wide, uint8_t reg, uint8_t rm, bool force) {
+    uint8_t prefix = 0x40 | (wide << 3) | ((reg >> 3) << 2) | (rm >> 3);
+    if (prefix != 0x40 || force) {
+        this->byte(prefix);
+    }
+}
+
+void Assembler::modrm_register(uint8_t reg, uint8_t rm) {
+    this->byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+void Assembler::modrm_memory(
+    uint8_t reg, Register base, int32_t displacement
+) {
+    this->byte(0x80 | ((reg & 7) << 3) | (encoding(base) & 7));
+    // RSP and R12 as a base need a SIB byte without an index
+    if ((encoding(base) & 7) == 4) {
+        this->byte(0x24);
+    }
+    this->bytes32(static_cast<uint32_t>(displacement));
+}
+
+void Assembler::integer(uint8_t opcode, uint8_t reg, Register rm) {
+    this->rex(true, reg, encoding(rm));
+    this->byte(opcode);
+    this->modrm_register(reg, encoding(rm));
+}
+
+void Assembler::integer(
+    uint8_t opcode, uint8_t reg, Register base, int32_t displacement
+) {
+    this->rex(true, reg, encoding(base));
+    this->byte(opcode);
+    this->modrm_memory(reg, base, displacement);
+}
+
+void Assembler::sse(
+    uint8_t prefix, uint8_t opcode, uint8_t reg, uint8_t rm, bool wide
+) {
+    this->byte(prefix);
+    this->rex(wide, reg, rm);
+    this->byte(0x0F);
+    this->byte(opcode);
+    this->modrm_register(reg, rm);
+}
+
+void Assembler::sse(
+    uint8_t prefix,
+    uint8_t opcode,
+    uint8_t reg,
+    Register base,
+    int32_t displacement
+) {
+    this->byte(prefix);
+    this->rex(false, reg, encoding(base));
+    this->byte(0x0F);
+    this->byte(opcode);
+    this->modrm_memory(reg, base, displacement);
+}
+
+Assembler::Label Assembler::new_label() {
+    this->labels.push_back(UNBOUND);
+    return Label{this->labels.size() - 1};
+}
+
+void Assembler::bind(Label label) {
+    this->labels[label.index] = this->code.size();
+}
+
+void Assembler::push(Register source) {
+    this->rex(false, 0, encoding(source));
+    this->byte(0x50 | (encoding(source) & 7));
+}
+
+void Assembler::pop(Register destination) {
+    this->rex(false, 0, encoding(destination));
+    this->byte(0x58 | (encoding(destination) & 7));
+}
+
+void Assembler::move(Register destination, Register source) {
+    this->integer(0x89, encoding(source), destination);
+}
+
+void Assembler::move(Register destination, int64_t value) {
+    if (value == static_cast<int32_t>(value)) {
+        // Sign-extended from 32 bits
+        this->integer(0xC7, 0, destination);
+        this->bytes32(static_cast<uint32_t>(value));
+        return;
+    }
+
+    this->rex(true, 0, encoding(destination));
+    this->byte(0xB8 | (encoding(destination) & 7));
+    this->bytes32(static_cast<uint32_t>(value));
+    this->bytes32(static_cast<uint32_t>(static_cast<uint64_t>(value) >> 32));
+}
+
+void Assembler::load(Register destination, Register base, int32_t displacement) {
+    this->integer(0x8B, encoding(destination), base, displacement);
+}
+
+void Assembler::store(Register base, int32_t displacement, Register source) {
+    this->integer(0x89, encoding(source), base, displacement);
+}
+
+void Assembler::load_address(
+    Register destination, Register base, int32_t displacement
+) {
+    this->integer(0x8D, encoding(destination), base, displacement);
+}
+
+void Assembler::add(Register destination, Register source) {
+    this->integer(0x01, encoding(source), destination);
+}
+
+void Assembler::add(Register destination, int32_t value) {
+    this->integer(0x81, 0, destination);
+    this->bytes32(static_cast<uint32_t>(value));
+}
+
+void Assembler::subtract(Register destination, Register source) {
+    this->integer(0x29, encoding(source), destination);
+}
+
+void Assembler::subtract(Register destination, int32_t value) {
+    this->integer(0x81, 5, destination);
+    this->bytes32(static_cast<uint32_t>(value));
+}
+
+void Assembler::multiply(Register destination, Register source) {
+    this->rex(true, encoding(destination), encoding(source));
+    this->byte(0x0F);
+    this->byte(0xAF);
+    this->modrm_register(encoding(destination), encoding(source));
+}
+
+void Assembler::divide(Register divisor) { this->integer(0xF7, 7, divisor); }
+
+void Assembler::sign_extend() {
+    this->rex(true, 0, 0);
+    this->byte(0x99);
+}
+
+void Assembler::negate(Register destination) {
+    this->integer(0xF7, 3, destination);
+}
+
+void Assembler::bitwise_and(Register destination, Register source) {
+    this->integer(0x21, encoding(source), destination);
+}
+
+void Assembler::bitwise_or(Register destination, Register source) {
+    this->integer(0x09, encoding(source), destination);
+}
+
+void Assembler::bitwise_xor(Register destination, Register source) {
+    this->integer(0x31, encoding(source), destination);
+}
+
+void Assembler::bitwise_xor(Register destination, int32_t value) {
+    this->integer(0x81, 6, destination);
+    this->bytes32(static_cast<uint32_t>(value));
+}
+
+void Assembler::compare(Register left, Register right) {
+    this->integer(0x39, encoding(right), left);
+}
+
+void Assembler::compare(Register left, int32_t value) {
+    this->integer(0x81, 7, left);
+    this->bytes32(static_cast<uint32_t>(value));
+}
+
+void Assembler::test(Register left, Register right) {
+    this->integer(0x85, encoding(right), left);
+}
+
+void Assembler::set(Condition condition, Register destination) {
+    // Without a REX prefix, registers 4 to 7 would be AH to BH
+    auto reg = encoding(destination);
+    this->rex(false, 0, reg, reg >= 4);
+    this->byte(0x0F);
+    this->byte(0x90 | static_cast<uint8_t>(condition));
+    this->modrm_register(0, reg);
+
+    // movzx r32, r8 clears the upper half too
+    this->rex(false, reg, reg, reg >= 4);
+    this->byte(0x0F);
+    this->byte(0xB6);
+    this->modrm_register(reg, reg);
+}
+
+void Assembler::move(FloatRegister destination, FloatRegister source) {
+    this->sse(0xF2, 0x10, encoding(destination), encoding(source), false);
+}
+
+void Assembler::move(FloatRegister destination, Register source) {
+    this->sse(0x66, 0x6E, encoding(destination), encoding(source), true);
+}
+
+void Assembler::load(
+    FloatRegister destination, Register base, int32_t displacement
+) {
+    this->sse(0xF2, 0x10, encoding(destination), base, displacement);
+}
+
+void Assembler::store(
+    Register base, int32_t displacement, FloatRegister source
+) {
+    this->sse(0xF2, 0x11, encoding(source), base, displacement);
+}
+
+void Assembler::add(FloatRegister destination, FloatRegister source) {
+    this->sse(0xF2, 0x58, encoding(destination), encoding(source), false);
+}
+
+void Assembler::subtract(FloatRegister destination, FloatRegister source) {
+    this->sse(0xF2, 0x5C, encoding(destination), encoding(source), false);
+}
+
+void Assembler::multiply(FloatRegister destination, FloatRegister source) {
+    this->sse(0xF2, 0x59, encoding(destination), encoding(source), false);
+}
+
+void Assembler::divide(FloatRegister destination, FloatRegister source) {
+    this->sse(0xF2, 0x5E, encoding(destination), encoding(source), false);
+}
+
+void Assembler::convert(FloatRegister destination, Register source) {
+    this->sse(0xF2, 0x2A, encoding(destination), encoding(source), true);
+}
+
+void Assembler::compare(FloatRegister left, FloatRegister right) {
+    this->sse(0x66, 0x2E, encoding(left), encoding(right), false);
+}
+
+void Assembler::jump_offset(Label label) {
+    this->jumps.emplace_back(this->code.size(), label.index);
+    this->bytes32(0);
+}
+
+void Assembler::jump(Label label) {
+    this->byte(0xE9);
+    this->jump_offset(label);
+}
+
+void Assembler::jump_if(Condition condition, Label label) {
+    this->byte(0x0F);
+    this->byte(0x80 | static_cast<uint8_t>(condition));
+    this->jump_offset(label);
+}
+
+void Assembler::ret() { this->byte(0xC3); }
+
+std::vector<uint8_t> Assembler::finish() {
+    for (auto [position, label] : this->jumps) {
+        auto target = this->labels[label];
+        if (target == UNBOUND) {
+            throw std::logic_error(
+                "Jumped to a label that was never bound. This is a bug."
+            );
+        }
+
+        // Offsets are relative to the end of the jump
+        auto offset = static_cast<int64_t>(target) -
+                      static_cast<int64_t>(position + 4);
+        auto value = static_cast<uint32_t>(static_cast<int32_t>(offset));
+        for (size_t index = 0; index < 4; ++index) {
+            this->code[position + index] =
+                static_cast<uint8_t>(value >> (8 * index));
+        }
+    }
+    this->jumps.clear();
+
+    return std::move(this->code);
+}
+
+ExecutableCode::ExecutableCode(void* memory, size_t size)
+    : memory(memory), size(size) {}
+
+ExecutableCode::~ExecutableCode() { munmap(this->memory, this->size); }
+
+std::unique_ptr<ExecutableCode>
+ExecutableCode::map(std::span<uint8_t const> code) {
+    auto memory = mmap(
+        nullptr,
+        code.size(),
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, code.size());
+        return nullptr;
+    }
+
+    return std::unique_ptr<ExecutableCode>(
+        new ExecutableCode(memory, code.size())
+    );
+}
+
+void const* ExecutableCode::start() const { return this->memory; }
+size_t ExecutableCode::length() const { return this->size; }
+
+} // namespace evaluator
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace evaluator {
+
+// General-purpose x86-64 registers, numbered as in instruction encodings.
+enum class Register : uint8_t {
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RSP = 4,
+    RBP = 5,
+    RSI = 6,
+    RDI = 7,
+    R12 = 12,
+};
+
+enum class FloatRegister : uint8_t { XMM0 = 0, XMM1 = 1 };
+
+// Conditions of jumps and `setcc`, numbered as in instruction encodings.
+enum class Condition : uint8_t {
+    BELOW = 0x2,
+    ABOVE_OR_EQUAL = 0x3,
+    EQUAL = 0x4,
+    NOT_EQUAL = 0x5,
+    ABOVE = 0x7,
+    PARITY = 0xA,
+    NO_PARITY = 0xB,
+    LESS = 0xC,
+    GREATER_OR_EQUAL = 0xD,
+    LESS_OR_EQUAL = 0xE,
+    GREATER = 0xF,
+};
+
+// Encodes x86-64 instructions into a buffer. Memory operands are always a
+// base register plus a 32-bit displacement. Jumps go to labels, which may be
+// bound after the jumps and are resolved by `finish`.
+class Assembler {
+  public:
+    struct Label {
+        size_t index;
+    };
+
+  private:
+    std::vector<uint8_t> code;
+    // Positions labels are bound to, or `UNBOUND`
+    std::vector<size_t> labels;
+    // Positions of 32-bit jump offsets and the labels they jump to
+    std::vector<std::pair<size_t, size_t>> jumps;
+
+    static constexpr size_t UNBOUND = SIZE_MAX;
+
+    void byte(uint8_t value);
+    void bytes32(uint32_t value);
+    void rex(bool wide, uint8_t reg, uint8_t rm, bool force = false);
+    void modrm_register(uint8_t reg, uint8_t rm);
+    void modrm_memory(uint8_t reg, Register base, int32_t displacement);
+    // An instruction `opcode` of a 64-bit register or memory operand and a
+    // register operand, or an opcode extension in `reg`
+    void integer(uint8_t opcode, uint8_t reg, Register rm);
+    void integer(uint8_t opcode, uint8_t reg, Register base, int32_t displacement);
+    // An SSE instruction with a mandatory `prefix`, like `F2 0F opcode`
+    void sse(uint8_t prefix, uint8_t opcode, uint8_t reg, uint8_t rm, bool wide);
+    void sse(
+        uint8_t prefix,
+        uint8_t opcode,
+        uint8_t reg,
+        Register base,
+        int32_t displacement
+    );
+    void jump_offset(Label label);
+
+  public:
+    Label new_label();
+    void bind(Label label);
+
+    void push(Register source);
+    void pop(Register destination);
+    void move(Register destination, Register source);
+    void move(Register destination, int64_t value);
+    void load(Register destination, Register base, int32_t displacement);
+    void store(Register base, int32_t displacement, Register source);
+    void load_address(Register destination, Register base, int32_t displacement);
+
+    void add(Register destination, Register source);
+    void add(Register destination, int32_t value);
+    void subtract(Register destination, Register source);
+    void subtract(Register destination, int32_t value);
+    void multiply(Register destination, Register source);
+    // Divides RDX:RAX by `divisor`, leaving the quotient in RAX.
+    void divide(Register divisor);
+    // Sign-extends RAX into RDX:RAX.
+    void sign_extend();
+    void negate(Register destination);
+    void bitwise_and(Register destination, Register source);
+    void bitwise_or(Register destination, Register source);
+    void bitwise_xor(Register destination, Register source);
+    void bitwise_xor(Register destination, int32_t value);
+    void compare(Register left, Register right);
+    void compare(Register left, int32_t value);
+    void test(Register left, Register right);
+    // Sets `destination` to 1 if `condition` holds and to 0 otherwise.
+    void set(Condition condition, Register destination);
+
+    void move(FloatRegister destination, FloatRegister source);
+    // Moves the bits of `source` unchanged.
+    void move(FloatRegister destination, Register source);
+    void load(FloatRegister destination, Register base, int32_t displacement);
+    void store(Register base, int32_t displacement, FloatRegister source);
+    void add(FloatRegister destination, FloatRegister source);
+    void subtract(FloatRegister destination, FloatRegister source);
+    void multiply(FloatRegister destination, FloatRegister source);
+    void divide(FloatRegister destination, FloatRegister source);
+    // Converts the integer in `source` to a double.
+    void convert(FloatRegister destination, Register source);
+    // Compares without signaling on NaN, setting the flags like an unsigned
+    // comparison, and the parity flag if either operand is NaN.
+    void compare(FloatRegister left, FloatRegister right);
+
+    void jump(Label label);
+    void jump_if(Condition condition, Label label);
+    void ret();
+
+    // Resolves jumps and returns the code. All labels jumped to must be bound.
+    std::vector<uint8_t> finish();
+};
+
+// Machine code copied into memory mapped for it, which is executable and no
+// longer writable.
+class ExecutableCode {
+    void* memory;
+    size_t size;
+
+    ExecutableCode(void* memory, size_t size);
+
+  public:
+    ExecutableCode(ExecutableCode const&) = delete;
+    ExecutableCode& operator=(ExecutableCode const&) = delete;
+    ~ExecutableCode();
+
+    // Returns the mapped code, or `nullptr` if memory couldn't be mapped.
+    static std::unique_ptr<ExecutableCode> map(std::span<uint8_t const> code);
+
+    void const* start() const;
+    size_t length() const;
+};
+
+} // namespace evaluator
@@ -0,0 +1,109 @@
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "background_optimizer.h"
+#include "function.h"
+#include "optimizer.h"
+#include "pass_manager.h"
+
+namespace evaluator {
+
+OptimizationJob::OptimizationJob()
+    : global(this->garbage_collector.create_scope(nullptr)) {}
+
+void OptimizationJob::run() {
+    try {
+        Optimizer optimizer(&this->garbage_collector, *this->global, true);
+        PassManager::run_detached(*this->program, optimizer);
+        this->result = this->definition->body;
+    } catch (std::exception const&) {
+        // The function keeps its current body
+        this->result = nullptr;
+    }
+    this->done.store(true, std::memory_order_release);
+}
+
+// Runs queued jobs one at a time until the program exits.
+class OptimizerThread {
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::deque<std::shared_ptr<OptimizationJob>> jobs;
+    bool stopping = false;
+    // Declared last, so the thread starts once the rest is initialized
+    std::thread thread;
+
+    void run();
+
+  public:
+    OptimizerThread();
+    ~OptimizerThread();
+
+    void push(std::shared_ptr<OptimizationJob> job);
+};
+
+OptimizerThread::OptimizerThread() : thread(&OptimizerThread::run, this) {}
+
+OptimizerThread::~OptimizerThread() {
+    {
+        std::lock_guard lock(this->mutex);
+        this->stopping = true;
+    }
+    this->queued.notify_one();
+    this->thread.join();
+}
+
+void OptimizerThread::run() {
+    while (true) {
+        std::shared_ptr<OptimizationJob> job;
+        {
+            std::unique_lock lock(this->mutex);
+            this->queued.wait(lock, [this] {
+                return this->stopping || !this->jobs.empty();
+            });
+            if (this->stopping) {
+                return;
+            }
+            job = std::move(this->jobs.front());
+            this->jobs.pop_front();
+        }
+        job->run();
+    }
+}
+
+void OptimizerThread::push(std::shared_ptr<OptimizationJob> job) {
+    {
+        std::lock_guard lock(this->mutex);
+        this->jobs.push_back(std::move(job));
+    }
+    this->queued.notify_one();
+}
+
+bool BackgroundOptimizer::enabled = false;
+
+std::shared_ptr<OptimizationJob>
+BackgroundOptimizer::submit(Func const& definition, Scope& global) {
+    auto job = std::make_shared<OptimizationJob>();
+
+    // Built-ins are the only globals the passes look up, and only the ones
+    // that no local variable may shadow
+    for (auto const& [name, value] : global.variables) {
+        if (std::dynamic_pointer_cast<BuiltInFunction>(value) &&
+            !Scope::is_declared_local(name)) {
+            job->global->define(ast::Symbol(name, value->span), value);
+        }
+    }
+
+    auto copy = definition.clone();
+    job->definition = static_cast<Func*>(copy.get());
+    std::vector<std::unique_ptr<Expression>> program;
+    program.push_back(std::move(copy));
+    job->program = std::make_unique<Program>(Body(std::move(program)));
+
+    static OptimizerThread thread;
+    thread.push(job);
+    return job;
+}
+
+} // namespace evaluator
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "expression.h"
+#include "scope.h"
+
+namespace evaluator {
+
+// A copy of a function definition being optimized in the background. The
+// garbage collector and the copy of the global scope belong to the job, so
+// nothing the evaluation uses is touched while it runs.
+class OptimizationJob {
+  public:
+    GarbageCollector garbage_collector;
+    ScopeGuard global;
+    std::unique_ptr<Program> program;
+    // The copy of the definition in `program`, which passes only rewrite the
+    // body of
+    Func* definition = nullptr;
+    // Set before `done`, to `nullptr` if the definition couldn't be optimized
+    std::shared_ptr<Body> result;
+    std::atomic<bool> done = false;
+
+    OptimizationJob();
+
+    // Optimizes the copy on the calling thread.
+    void run();
+};
+
+// Optimizes hot functions on a background thread. When it is enabled,
+// programs only get the optimizations up to `EAGER_LEVEL` before they run, so
+// short scripts start quickly. A global function called `HOT` times has a
+// copy of its definition as parsed optimized at the full level, and switches
+// to the optimized body on a call after it is done. Calls in progress keep
+// evaluating the body they started with.
+//
+// The passes read built-ins from a copy of the global scope taken when the
+// function got hot. What they assume about them is checked at runtime by
+// guards, like for any optimized code, so the copy may go stale.
+class BackgroundOptimizer {
+  public:
+    static constexpr size_t HOT = 64;
+    static constexpr unsigned EAGER_LEVEL = 1;
+
+    static bool enabled;
+
+    // Queues the optimization of a copy of `definition`, a function defined
+    // in `global`.
+    static std::shared_ptr<OptimizationJob>
+    submit(Func const& definition, Scope& global);
+};
+
+} // namespace evaluator
@@ -0,0 +1,155 @@
+#include "closure_conversion.h"
+#include "optimizer.h"
+
+namespace evaluator {
+
+ClosureConverter::ClosureConverter(Optimizer& optimizer)
+    : optimizer(optimizer) {}
+
+void ClosureConverter::convert(std::unique_ptr<Expression>& expression) {
+    expression->convert_closures(*this);
+}
+
+void ClosureConverter::convert(Body& body) {
+    for (auto& expression : body.body) {
+        this->convert(expression);
+    }
+}
+
+void ClosureConverter::convert_program(Body& program) {
+    this->convert(program);
+
+    for (auto const& closure : this->closures) {
+        if (!this->is_convertible(closure)) {
+            continue;
+        }
+
+        closure.captures->converted = true;
+        closure.captures->variables.clear();
+        for (auto const& [variable, frame] : closure.variables) {
+            closure.captures->variables.push_back(variable);
+        }
+    }
+
+    for (auto body : this->bodies) {
+        body->update_captures_scope();
+    }
+}
+
+void ClosureConverter::convert_scope(Parameters const& variables, Body& body) {
+    Frame frame;
+    for (auto const& variable : variables.parameters) {
+        frame.variables.insert(variable->value);
+    }
+    this->active.push_back(this->frames.size());
+    this->frames.push_back(std::move(frame));
+
+    this->convert(body);
+    this->bodies.push_back(&body);
+
+    this->active.pop_back();
+}
+
+void ClosureConverter::convert_closure(
+    Captures& captures, Parameters const& parameters, Body& body
+) {
+    // Closures created in the global scope already keep nothing else
+    if (this->active.empty()) {
+        this->convert_scope(parameters, body);
+        return;
+    }
+
+    Closure closure{&captures, this->active, {}, {}};
+    closure.frames.push_back(this->frames.size());
+
+    this->open.push_back(this->closures.size());
+    this->closures.push_back(std::move(closure));
+    this->convert_scope(parameters, body);
+    this->open.pop_back();
+}
+
+std::optional<size_t>
+ClosureConverter::find_frame(ast::Symbol const& variable) const {
+    for (size_t index = this->active.size(); index > 0; --index) {
+        auto const& frame = this->frames[this->active[index - 1]];
+        if (frame.variables.contains(variable.value)) {
+            return index - 1;
+        }
+    }
+    return std::nullopt;
+}
+
+void ClosureConverter::read(std::shared_ptr<ast::Symbol> const& variable) {
+    auto frame = this->find_frame(*variable);
+
+    for (auto index : this->open) {
+        auto& closure = this->closures[index];
+        // The parameters of the closure are the last of its frames
+        auto parameters = closure.frames.size() - 1;
+        if (frame && *frame >= parameters) {
+            continue;
+        }
+
+        if (closure.free.insert(variable->value).second && frame) {
+            closure.variables.emplace_back(variable, this->active[*frame]);
+        }
+    }
+}
+
+void ClosureConverter::assign(std::shared_ptr<ast::Symbol> const& variable) {
+    this->read(variable);
+
+    if (auto frame = this->find_frame(*variable)) {
+        this->frames[this->active[*frame]].assigned.insert(variable->value);
+    } else if (!this->active.empty()) {
+        // Defines the variable in the current scope unless it's global by then
+        this->frames[this->active.back()].defined.insert(variable->value);
+    }
+}
+
+void ClosureConverter::define(std::shared_ptr<ast::Symbol> const& variable) {
+    if (!this->active.empty()) {
+        this->frames[this->active.back()].defined.insert(variable->value);
+    }
+}
+
+void ClosureConverter::call(ast::Symbol const* callee) {
+    if (!callee || !this->optimizer.never_evaluates(*callee)) {
+        this->evaluate();
+    }
+}
+
+void ClosureConverter::evaluate() {
+    for (auto frame : this->active) {
+        this->frames[frame].evaluates = true;
+    }
+}
+
+bool ClosureConverter::is_convertible(Closure const& closure) const {
+    for (auto index : closure.frames) {
+        if (this->frames[index].evaluates) {
+            return false;
+        }
+    }
+
+    auto parameters = closure.frames.back();
+    for (auto index : closure.frames) {
+        if (index == parameters) {
+            continue;
+        }
+        for (auto const& name : closure.free) {
+            if (this->frames[index].defined.contains(name)) {
+                return false;
+            }
+        }
+    }
+
+    for (auto const& [variable, frame] : closure.variables) {
+        if (this->frames[frame].assigned.contains(variable->value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace evaluator
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../ast/element.h"
+#include "expression.h"
+
+namespace evaluator {
+
+class Optimizer;
+
+// Decides which closures can keep copies of the variables they read from
+// enclosing functions and `prog` blocks, instead of the whole chain of scopes
+// they are created in. Such closures keep a scope of their own under the
+// global one, so the scopes around them don't outlive their calls.
+//
+// A closure is converted if none of the variables it reads from enclosing
+// scopes is ever assigned after being declared, so a copy can't go stale, and
+// no code in enclosing scopes may define a variable it reads at runtime: by
+// `func`, by `setq` of a variable declared nowhere, or by `eval`. Any function
+// but the other built-ins may be `eval` under another name. Variables declared
+// nowhere are still looked up in the global scope when read.
+class ClosureConverter {
+    struct Frame {
+        std::unordered_set<std::string> variables;
+        // Variables of the frame assigned anywhere
+        std::unordered_set<std::string> assigned;
+        // Names code in the frame may define at runtime
+        std::unordered_set<std::string> defined;
+        bool evaluates = false;
+    };
+
+    struct Closure {
+        Captures* captures;
+        // Frames around the closure, then the frame of its parameters
+        std::vector<size_t> frames;
+        // Names the closure reads but doesn't declare
+        std::unordered_set<std::string> free;
+        // Free variables declared by enclosing frames, with those frames
+        std::vector<std::pair<std::shared_ptr<ast::Symbol>, size_t>> variables;
+    };
+
+    std::vector<Frame> frames;
+    // Frames around the current expression, innermost last
+    std::vector<size_t> active;
+    std::vector<Closure> closures;
+    // Closures around the current expression
+    std::vector<size_t> open;
+    std::vector<Body*> bodies;
+    Optimizer& optimizer;
+
+    // Returns the position in `active` of the innermost frame declaring
+    // `variable`, or nothing if it is global.
+    std::optional<size_t> find_frame(ast::Symbol const& variable) const;
+    bool is_convertible(Closure const& closure) const;
+
+  public:
+    ClosureConverter(Optimizer& optimizer);
+
+    void convert(std::unique_ptr<Expression>& expression);
+    void convert(Body& body);
+    // Converts closures in the whole program, then updates the bodies whose
+    // scopes closures no longer capture.
+    void convert_program(Body& program);
+
+    void convert_scope(Parameters const& variables, Body& body);
+    void convert_closure(
+        Captures& captures, Parameters const& parameters, Body& body
+    );
+
+    void read(std::shared_ptr<ast::Symbol> const& variable);
+    void assign(std::shared_ptr<ast::Symbol> const& variable);
+    // A variable `func` defines in the current scope.
+    void define(std::shared_ptr<ast::Symbol> const& variable);
+    // A call of `callee`, or of a computed function if it's null.
+    void call(ast::Symbol const* callee);
+    // Code evaluated by `eval` may read or define anything.
+    void evaluate();
+};
+
+} // namespace evaluator
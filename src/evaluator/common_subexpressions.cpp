@@ -0,0 +1,157 @@
+#include <sstream>
+#include <utility>
+
+#include "common_subexpressions.h"
+#include "optimizer.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+
+CommonSubexpressionEliminator::CommonSubexpressionEliminator(
+    Optimizer& optimizer
+)
+    : optimizer(optimizer) {}
+
+std::optional<std::string>
+CommonSubexpressionEliminator::eliminate(std::unique_ptr<Expression>& expression
+) {
+    auto key = expression->eliminate_common_subexpressions(*this);
+
+    // Keys of calls start with a parenthesis, and keys of variables contain
+    // `@`. Calls of constants alone are left to constant folding.
+    if (key && key->front() == '(' && key->find('@') != std::string::npos) {
+        this->bodies.back()[*key].push_back(&expression);
+    }
+    return key;
+}
+
+void CommonSubexpressionEliminator::eliminate(Body& body) {
+    for (auto& expression : body.body) {
+        this->eliminate(expression);
+    }
+}
+
+void CommonSubexpressionEliminator::share(Body& body) {
+    this->bodies.emplace_back();
+    this->eliminate(body);
+    auto occurrences = std::move(this->bodies.back());
+    this->bodies.pop_back();
+
+    for (auto& [key, expressions] : occurrences) {
+        if (expressions.size() < 2) {
+            continue;
+        }
+
+        // Occurrences nested in other ones stay valid, since wrapping an
+        // expression doesn't move it
+        auto value = std::make_shared<CommonValue>();
+        for (auto expression : expressions) {
+            *expression = std::make_unique<Common>(value, std::move(*expression));
+        }
+        body.common.push_back(std::move(value));
+        this->shared += expressions.size();
+    }
+}
+
+void CommonSubexpressionEliminator::eliminate_program(Body& program) {
+    // Top-level code only reads global variables, which are never shared
+    this->bodies.emplace_back();
+    this->eliminate(program);
+    this->bodies.pop_back();
+}
+
+void CommonSubexpressionEliminator::eliminate_function(
+    Parameters const& parameters, Body& body
+) {
+    auto scopes = std::exchange(this->scopes, ScopeTracker());
+    this->eliminate_scope(parameters, body);
+    this->scopes = std::move(scopes);
+}
+
+void CommonSubexpressionEliminator::eliminate_scope(
+    Parameters const& parameters, Body& body
+) {
+    this->scopes.enter_scope(parameters, !body.may_capture_scope());
+    this->share(body);
+    this->scopes.exit_scope();
+}
+
+void CommonSubexpressionEliminator::eliminate_loop(
+    std::unique_ptr<Expression>& condition, Body& body
+) {
+    // The condition is evaluated again after the body assigns variables
+    this->bodies.emplace_back();
+    this->eliminate(condition);
+    this->bodies.pop_back();
+
+    this->share(body);
+}
+
+std::optional<std::string>
+CommonSubexpressionEliminator::read(ast::Symbol const& variable) const {
+    auto frame = this->scopes.find_tracked(variable);
+    if (!frame) {
+        return std::nullopt;
+    }
+
+    size_t assigned = 0;
+    auto found = this->assignments.find({*frame, variable.value});
+    if (found != this->assignments.end()) {
+        assigned = found->second;
+    }
+    return variable.value + '@' + std::to_string(*frame) + '#' +
+           std::to_string(assigned);
+}
+
+std::optional<std::string>
+CommonSubexpressionEliminator::constant(ast::Element const& element) const {
+    switch (element.kind) {
+    case ElementKind::INTEGER:
+        return std::to_string(static_cast<ast::Integer const&>(element).value);
+    case ElementKind::REAL: {
+        // Exact, so different reals never share a key
+        std::ostringstream stream;
+        stream << std::hexfloat << static_cast<ast::Real const&>(element).value;
+        return stream.str();
+    }
+    case ElementKind::BOOLEAN:
+        return static_cast<ast::Boolean const&>(element).value ? "true"
+                                                                : "false";
+    default:
+        // Calls of other constants aren't shared
+        return std::nullopt;
+    }
+}
+
+std::optional<std::string> CommonSubexpressionEliminator::call(
+    ast::Symbol const& callee,
+    std::vector<std::optional<std::string>> const& arguments
+) const {
+    if (!this->optimizer.pure_built_in(callee)) {
+        return std::nullopt;
+    }
+
+    std::string key = '(' + callee.value;
+    for (auto const& argument : arguments) {
+        if (!argument) {
+            return std::nullopt;
+        }
+        key += ' ' + *argument;
+    }
+    return key + ')';
+}
+
+void CommonSubexpressionEliminator::assign(ast::Symbol const& variable) {
+    auto frame = this->scopes.find_frame(variable);
+    if (frame == this->scopes.size()) {
+        return;
+    }
+    ++this->assignments[{frame, variable.value}];
+}
+
+size_t CommonSubexpressionEliminator::get_shared() const {
+    return this->shared;
+}
+
+} // namespace evaluator
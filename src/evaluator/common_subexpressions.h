@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../ast/element.h"
+#include "expression.h"
+#include "scope_tracker.h"
+
+namespace evaluator {
+
+class Optimizer;
+
+// Shares the values of pure expressions repeated in a body, like
+// `(head (tail list))` or `(times x x)`, by wrapping their occurrences in
+// `Common`. The first occurrence evaluated computes the value and the others
+// reuse it, so an occurrence in a branch never taken isn't evaluated early.
+//
+// An expression is shared if it only calls pure built-ins and reads variables
+// of scopes `ScopeTracker` tracks that no code between its occurrences
+// assigns. `eval` called under another name changes `Scope::version`, which
+// makes occurrences compute values again.
+//
+// Each body shares values of its own: a nested body may be evaluated any
+// number of times, and so may the condition of a loop, which isn't shared
+// with anything.
+class CommonSubexpressionEliminator {
+    using Occurrences =
+        std::map<std::string, std::vector<std::unique_ptr<Expression>*>>;
+
+    Optimizer& optimizer;
+    ScopeTracker scopes;
+    // How many times each variable was assigned so far, which tells values it
+    // holds apart
+    std::map<std::pair<size_t, std::string>, size_t> assignments;
+    // Occurrences of shareable calls in the bodies being visited, by key,
+    // innermost body last
+    std::vector<Occurrences> bodies;
+    size_t shared = 0;
+
+    // Visits a body whose common subexpressions are forgotten each time it is
+    // evaluated.
+    void share(Body& body);
+
+  public:
+    CommonSubexpressionEliminator(Optimizer& optimizer);
+
+    std::optional<std::string> eliminate(std::unique_ptr<Expression>& expression
+    );
+    void eliminate(Body& body);
+    void eliminate_program(Body& program);
+    void eliminate_function(Parameters const& parameters, Body& body);
+    void eliminate_scope(Parameters const& parameters, Body& body);
+    void eliminate_loop(std::unique_ptr<Expression>& condition, Body& body);
+
+    // Keys of reads of variables, constants, and calls. Reads only have keys
+    // if all assignments to the variable are visible.
+    std::optional<std::string> read(ast::Symbol const& variable) const;
+    std::optional<std::string> constant(ast::Element const& element) const;
+    std::optional<std::string> call(
+        ast::Symbol const& callee,
+        std::vector<std::optional<std::string>> const& arguments
+    ) const;
+    void assign(ast::Symbol const& variable);
+
+    // Returns the number of occurrences whose values are shared.
+    size_t get_shared() const;
+};
+
+} // namespace evaluator
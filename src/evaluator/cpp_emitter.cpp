@@ -0,0 +1,625 @@
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <iomanip>
+#include <stdexcept>
+
+#include "cpp_emitter.h"
+#include "macros.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+using ast::Position;
+using ast::Span;
+
+// Writes `value` as a C++ literal of type `int64_t`.
+static std::string integer_literal(int64_t value) {
+    // The literal of the smallest integer would overflow before negation
+    if (value == INT64_MIN) {
+        return "INT64_MIN";
+    }
+    return "INT64_C(" + std::to_string(value) + ")";
+}
+
+// Quotes `text` as a C++ string literal.
+std::string string_literal(std::string_view text) {
+    std::ostringstream stream;
+    stream << '"';
+    for (auto character : text) {
+        auto byte = static_cast<unsigned char>(character);
+        if (character == '"' || character == '\\') {
+            stream << '\\' << character;
+        } else if (std::isprint(byte)) {
+            stream << character;
+        } else {
+            stream << '\\' << std::oct << std::setw(3) << std::setfill('0')
+                   << static_cast<unsigned>(byte) << std::dec;
+        }
+    }
+    stream << '"';
+    return stream.str();
+}
+
+// A value to return from a C++ function. Values held in optionals have to be
+// moved out, while local variables are moved implicitly.
+std::string returned(std::string const& value) {
+    if (value.starts_with("(*")) {
+        return "std::move(" + value + ")";
+    }
+    return value;
+}
+
+CppEmitter::CppEmitter() {}
+
+std::string CppEmitter::name(std::string_view prefix) {
+    return std::string(prefix) + "_" + std::to_string(this->next++);
+}
+
+CppEmitter::Function& CppEmitter::function() { return *this->functions.back(); }
+
+std::string const& CppEmitter::context() {
+    return this->function().contexts.back();
+}
+
+void CppEmitter::line(std::string const& text) {
+    auto& function = this->function();
+    function.code << std::string(4 * function.indentation, ' ') << text
+                  << '\n';
+}
+
+void CppEmitter::open(std::string const& text) {
+    this->line(text.empty() ? "{" : text + " {");
+    ++this->function().indentation;
+}
+
+void CppEmitter::close(std::string const& text) {
+    --this->function().indentation;
+    this->line(text);
+}
+
+std::string CppEmitter::constant(
+    std::string_view prefix,
+    std::string_view type,
+    std::string const& initializer
+) {
+    auto key = std::string(type) + " " + initializer;
+    if (auto found = this->interned.find(key); found != this->interned.end()) {
+        return found->second;
+    }
+
+    auto name = this->name(prefix);
+    this->constants << type << " const " << name << " = " << initializer
+                    << ";\n";
+    this->interned.emplace(std::move(key), name);
+    return name;
+}
+
+std::string CppEmitter::span(Span const& span) {
+    std::ostringstream initializer;
+    initializer << "ast::Span(ast::Position(" << span.start.line << ", "
+                << span.start.column << "), ast::Position(" << span.end.line
+                << ", " << span.end.column << "))";
+    return this->constant("span", "ast::Span", initializer.str());
+}
+
+std::string CppEmitter::symbol(ast::Symbol const& symbol) {
+    return this->constant(
+        "symbol",
+        "auto",
+        "std::make_shared<ast::Symbol>(" + string_literal(symbol.value) + ", " +
+            this->span(symbol.span) + ")"
+    );
+}
+
+std::string CppEmitter::element(ast::Element const& element) {
+    auto span = this->span(element.span);
+
+    switch (element.kind) {
+    case ElementKind::INTEGER: {
+        auto value = static_cast<ast::Integer const&>(element).value;
+        return this->constant(
+            "element",
+            "auto",
+            "std::make_shared<ast::Integer>(" + integer_literal(value) + ", " +
+                span + ")"
+        );
+    }
+    case ElementKind::REAL: {
+        // Written bitwise, so that the value survives exactly
+        auto value = static_cast<ast::Real const&>(element).value;
+        std::ostringstream bits;
+        bits << "std::bit_cast<double>(UINT64_C(0x" << std::hex
+             << std::bit_cast<uint64_t>(value) << "))";
+        return this->constant(
+            "element",
+            "auto",
+            "std::make_shared<ast::Real>(" + bits.str() + ", " + span + ")"
+        );
+    }
+    case ElementKind::BOOLEAN: {
+        auto value = static_cast<ast::Boolean const&>(element).value;
+        return this->constant(
+            "element",
+            "auto",
+            "std::make_shared<ast::Boolean>(" +
+                std::string(value ? "true" : "false") + ", " + span + ")"
+        );
+    }
+    case ElementKind::SYMBOL:
+        return this->symbol(static_cast<ast::Symbol const&>(element));
+    case ElementKind::NULL_:
+        return this->constant(
+            "element", "auto", "std::make_shared<ast::Null>(" + span + ")"
+        );
+    case ElementKind::CONS: {
+        auto const& cons = static_cast<ast::Cons const&>(element);
+        auto left = this->element(*cons.left);
+        auto right = this->element(*cons.right);
+        return this->constant(
+            "element",
+            "auto",
+            "std::make_shared<ast::Cons>(" + left + ", " + right + ", " + span +
+                ")"
+        );
+    }
+    case ElementKind::FUNCTION:
+        break;
+    }
+
+    throw std::logic_error(
+        "Only elements read from source can be emitted as C++. This is a bug."
+    );
+}
+
+std::string
+CppEmitter::parameters(Span span, Parameters const& parameters) {
+    std::string symbols;
+    for (auto const& parameter : parameters.parameters) {
+        if (!symbols.empty()) {
+            symbols += ", ";
+        }
+        symbols += this->symbol(*parameter);
+    }
+    return this->constant(
+        "parameters",
+        "Parameters",
+        "Parameters(" + this->span(span) + ", {" + symbols + "})"
+    );
+}
+
+std::string CppEmitter::body(Body const& body) {
+    auto name = this->name("function");
+    this->declarations << "ElementGuard " << name
+                       << "(EvaluationContext context);\n";
+
+    this->functions.push_back(std::make_unique<Function>());
+    auto value = this->emit(body);
+    this->line("return " + returned(value) + ";");
+    this->definitions << "\nElementGuard " << name
+                      << "(EvaluationContext context) {\n"
+                      << this->function().code.str() << "}\n";
+    this->functions.pop_back();
+
+    return this->constant(
+        "body",
+        "auto",
+        "std::make_shared<Body>(Closure(" + name + "), " +
+            (body.may_capture_scope() ? "true" : "false") + ")"
+    );
+}
+
+std::string
+CppEmitter::boolean(std::string const& value, std::string_view message) {
+    auto boolean = this->name("boolean");
+    this->line(
+        "auto " + boolean + " = std::dynamic_pointer_cast<ast::Boolean>(*" +
+        value + ");"
+    );
+    this->open("if (!" + boolean + ")");
+    this->line(
+        "throw EvaluationError(" + string_literal(message) + ", " + value +
+        "->span);"
+    );
+    this->close();
+    return boolean;
+}
+
+void CppEmitter::emit(Program const& program, std::ostream& stream) {
+    program.emit_cpp(*this);
+
+    // Macros expanded while parsing, but `eval` may still use them
+    std::ostringstream macros;
+    for (auto const& definition : Macros::definitions()) {
+        macros << "        Macros::define(" << this->span(definition.span)
+               << ", " << this->element(*definition.arguments) << ");\n";
+    }
+
+    stream << "// Translated from F by `--emit-cpp`. Build it with `src` on "
+              "the include path,\n"
+              "// and link it against the `internals` library.\n"
+              "#include <bit>\n"
+              "#include <cstdint>\n"
+              "#include <iostream>\n"
+              "#include <memory>\n"
+              "#include <optional>\n"
+              "\n"
+              "#include \"ast/element.h\"\n"
+              "#include \"evaluator/error.h\"\n"
+              "#include \"evaluator/evaluator.h\"\n"
+              "#include \"evaluator/function.h\"\n"
+              "#include \"evaluator/macros.h\"\n"
+              "\n"
+              "using evaluator::Body;\n"
+              "using evaluator::CallFrame;\n"
+              "using evaluator::Closure;\n"
+              "using evaluator::ElementGuard;\n"
+              "using evaluator::EvaluationContext;\n"
+              "using evaluator::EvaluationError;\n"
+              "using evaluator::Evaluator;\n"
+              "using evaluator::FuncFunction;\n"
+              "using evaluator::Function;\n"
+              "using evaluator::InlineCache;\n"
+              "using evaluator::LambdaFunction;\n"
+              "using evaluator::Macros;\n"
+              "using evaluator::Parameters;\n"
+              "\n"
+              "namespace {\n"
+              "\n";
+    stream << this->declarations.str() << "ElementGuard "
+           << "evaluate_program(EvaluationContext context);\n\n";
+    stream << this->constants.str();
+    stream << this->definitions.str();
+    stream << "\n"
+              "} // namespace\n"
+              "\n"
+              "int main() {\n"
+              "    Evaluator evaluator;\n"
+              "    try {\n"
+           << macros.str()
+           << "        auto value = "
+              "evaluator.evaluate(Closure(evaluate_program));\n"
+              "        std::cout << value->display_pretty() << std::endl;\n"
+              "    } catch (EvaluationError const& error) {\n"
+              "        std::cerr << error << std::endl;\n"
+              "        return 1;\n"
+              "    }\n"
+              "    return 0;\n"
+              "}\n";
+}
+
+void CppEmitter::emit_program(Body const& program) {
+    this->functions.push_back(std::make_unique<Function>());
+    auto value = this->emit(program);
+    this->line("return " + returned(value) + ";");
+    this->definitions << "\nElementGuard "
+                      << "evaluate_program(EvaluationContext context) {\n"
+                      << this->function().code.str() << "}\n";
+    this->functions.pop_back();
+}
+
+std::string CppEmitter::emit(Expression const& expression) {
+    return expression.emit_cpp(*this);
+}
+
+std::string CppEmitter::emit(Body const& body) {
+    if (body.body.empty()) {
+        auto value = this->name("value");
+        this->line(
+            "ElementGuard " + value + " = " + this->context() +
+            ".garbage_collector->temporary(std::make_shared<ast::Null>(" +
+            this->span(Span(Position(0, 0), Position(0, 0))) + "));"
+        );
+        return value;
+    }
+
+    for (size_t index = 0; index + 1 < body.body.size(); ++index) {
+        this->open("");
+        this->emit(*body.body[index]);
+        this->close();
+    }
+    return this->emit(*body.body.back());
+}
+
+std::string CppEmitter::emit_read(ast::Symbol const& variable) {
+    auto value = this->name("value");
+    auto const& context = this->context();
+    this->line(
+        "ElementGuard " + value + " = " + context +
+        ".garbage_collector->temporary(" + context + ".scope->lookup(*" +
+        this->symbol(variable) + "));"
+    );
+    return value;
+}
+
+std::string CppEmitter::emit_constant(ast::Element const& element) {
+    auto value = this->name("value");
+    this->line(
+        "ElementGuard " + value + " = " + this->context() +
+        ".garbage_collector->temporary(" + this->element(element) + ");"
+    );
+    return value;
+}
+
+std::string CppEmitter::emit_assignment(
+    ast::Symbol const& variable, Expression const& initializer
+) {
+    auto value = this->emit(initializer);
+    this->line(
+        this->context() + ".scope->set_or_define(*" + this->symbol(variable) +
+        ", *" + value + ");"
+    );
+    return value;
+}
+
+std::string CppEmitter::emit_cond(
+    Expression const& condition,
+    Expression const& then,
+    Expression const& otherwise
+) {
+    auto result = this->name("result");
+    this->line("std::optional<ElementGuard> " + result + ";");
+    this->open("");
+
+    auto boolean = this->boolean(
+        this->emit(condition), "condition did not evaluate to a boolean"
+    );
+    this->open("if (" + boolean + "->value)");
+    auto value = this->emit(then);
+    this->line(result + ".emplace(std::move(" + value + "));");
+    this->close("} else {");
+    ++this->function().indentation;
+    value = this->emit(otherwise);
+    this->line(result + ".emplace(std::move(" + value + "));");
+    this->close();
+
+    this->close();
+    return "(*" + result + ")";
+}
+
+// Emits a C++ `switch`, which compilers turn into a jump table when the cases
+// are dense enough.
+std::string CppEmitter::emit_switch(
+    Expression const& value,
+    ElementKind kind,
+    std::vector<std::shared_ptr<ast::Element>> const& cases,
+    std::vector<std::unique_ptr<Expression>> const& branches
+) {
+    auto result = this->name("result");
+    this->line("std::optional<ElementGuard> " + result + ";");
+    this->open("");
+
+    auto evaluated = this->emit(value);
+    bool boolean = kind == ElementKind::BOOLEAN;
+    auto type = boolean ? "ast::Boolean" : "ast::Integer";
+    this->open(
+        "if (" + evaluated + ".get()->kind != ast::ElementKind::" +
+        (boolean ? "BOOLEAN" : "INTEGER") + ")"
+    );
+    this->line(
+        "throw EvaluationError(" +
+        string_literal(
+            std::string("switch value did not evaluate to ") +
+            (boolean ? "a boolean" : "an integer")
+        ) +
+        ", " + evaluated + "->span);"
+    );
+    this->close();
+
+    // Booleans are switched on as integers, which compilers don't warn about
+    this->open(
+        "switch (static_cast<int64_t>(static_cast<" + std::string(type) +
+        " const*>(" + evaluated + ".get())->value))"
+    );
+    for (size_t index = 0; index < branches.size(); ++index) {
+        if (index == cases.size()) {
+            this->open("default:");
+        } else if (boolean) {
+            auto value = static_cast<ast::Boolean const&>(*cases[index]).value;
+            this->open("case " + integer_literal(value) + ":");
+        } else {
+            auto value = static_cast<ast::Integer const&>(*cases[index]).value;
+            this->open("case " + integer_literal(value) + ":");
+        }
+        auto branch = this->emit(*branches[index]);
+        this->line(result + ".emplace(std::move(" + branch + "));");
+        this->line("break;");
+        this->close();
+    }
+    this->close();
+
+    this->close();
+    return "(*" + result + ")";
+}
+
+std::string CppEmitter::emit_return(Expression const& expression) {
+    auto value = this->emit(expression);
+    this->line("return " + returned(value) + ";");
+    return value;
+}
+
+std::string CppEmitter::emit_break(Expression const& expression) {
+    auto value = this->emit(expression);
+
+    auto& target = this->function().targets.back();
+    target.jumped = true;
+    if (!target.result.empty()) {
+        this->line(target.result + ".emplace(std::move(" + value + "));");
+    }
+    this->line("goto " + target.label + ";");
+    return value;
+}
+
+std::string CppEmitter::emit_call(
+    Span span,
+    Expression const& function,
+    std::shared_ptr<ast::Symbol> const& callee,
+    std::vector<std::unique_ptr<Expression>> const& arguments
+) {
+    auto result = this->name("result");
+    this->line("std::optional<ElementGuard> " + result + ";");
+    this->open("");
+
+    auto resolved = this->name("function");
+    if (callee) {
+        auto cache = this->name("cache");
+        this->constants << "InlineCache " << cache << ";\n";
+        this->line(
+            "auto " + resolved + " = " + cache + ".lookup(*" +
+            this->symbol(*callee) + ", *" + this->context() + ".scope);"
+        );
+    } else {
+        auto value = this->emit(function);
+        this->line(
+            "auto " + resolved + " = std::dynamic_pointer_cast<Function>(*" +
+            value + ");"
+        );
+    }
+    this->open("if (!" + resolved + ")");
+    this->line(
+        "throw EvaluationError(\"Cannot call a non-function\", " +
+        this->span(span) + ");"
+    );
+    this->close();
+
+    auto window = this->name("arguments");
+    this->line(
+        "auto " + window + " = " + this->context() +
+        ".garbage_collector->allocate_arguments(" +
+        std::to_string(arguments.size()) + ");"
+    );
+    for (size_t index = 0; index < arguments.size(); ++index) {
+        this->open("");
+        auto value = this->emit(*arguments[index]);
+        this->line(value + ".deactivate();");
+        this->line(
+            window + "[" + std::to_string(index) + "] = *" + value + ";"
+        );
+        this->close();
+    }
+    this->line(
+        result + ".emplace(" + resolved + "->call(CallFrame(" + window +
+        ".arguments(), " + this->span(span) + ", " + this->context() + ")));"
+    );
+
+    this->close();
+    return "(*" + result + ")";
+}
+
+std::string CppEmitter::emit_func(
+    Span span,
+    ast::Symbol const& name,
+    Parameters const& parameters,
+    Body const& body
+) {
+    auto shared = this->body(body);
+    auto function = this->name("function");
+    auto const& context = this->context();
+    this->line(
+        "auto " + function + " = std::make_shared<FuncFunction>(" +
+        this->span(span) + ", " + string_literal(name.value) + ", " +
+        this->parameters(span, parameters) + ", " + shared + ", " + context +
+        ".scope->capture());"
+    );
+    this->line(
+        context + ".scope->define(*" + this->symbol(name) + ", " + function +
+        ");"
+    );
+
+    auto value = this->name("value");
+    this->line(
+        "ElementGuard " + value + " = " + context +
+        ".garbage_collector->temporary(" + function + ");"
+    );
+    return value;
+}
+
+std::string CppEmitter::emit_lambda(
+    Span span, Parameters const& parameters, Body const& body
+) {
+    auto shared = this->body(body);
+    auto value = this->name("value");
+    auto const& context = this->context();
+    this->line(
+        "ElementGuard " + value + " = " + context +
+        ".garbage_collector->temporary(std::make_shared<LambdaFunction>(" +
+        this->span(span) + ", " + this->parameters(span, parameters) + ", " +
+        shared + ", " + context + ".scope->capture()));"
+    );
+    return value;
+}
+
+std::string
+CppEmitter::emit_prog(Parameters const& variables, Body const& body) {
+    auto result = this->name("result");
+    auto label = this->name("exit");
+    this->line("std::optional<ElementGuard> " + result + ";");
+    this->open("");
+
+    auto scope = this->name("scope");
+    auto const& outer = this->context();
+    this->line(
+        "auto " + scope + " = " + outer + ".garbage_collector->" +
+        (body.may_capture_scope() ? "create_scope" : "create_local_scope") +
+        "(" + outer + ".scope->shared_from_this());"
+    );
+    for (auto const& variable : variables.parameters) {
+        auto symbol = this->symbol(*variable);
+        this->line(
+            scope + "->define(*" + symbol + ", std::make_shared<ast::Null>(" +
+            symbol + "->span));"
+        );
+    }
+    auto context = this->name("context");
+    this->line(
+        "EvaluationContext " + context + "(" + outer + ".garbage_collector, " +
+        scope + ".get());"
+    );
+
+    this->function().contexts.push_back(context);
+    this->function().targets.push_back(Target{label, result});
+    auto value = this->emit(body);
+    this->line(result + ".emplace(std::move(" + value + "));");
+    auto target = std::move(this->function().targets.back());
+    this->function().targets.pop_back();
+    this->function().contexts.pop_back();
+
+    this->close();
+    if (target.jumped) {
+        this->line(label + ":;");
+    }
+    return "(*" + result + ")";
+}
+
+std::string CppEmitter::emit_loop(
+    Expression const& condition, Body const& body, ast::Null const& result
+) {
+    auto label = this->name("exit");
+    this->function().targets.push_back(Target{label, ""});
+
+    this->open("while (true)");
+    auto boolean =
+        this->boolean(this->emit(condition), "a boolean is expected");
+    this->open("if (!" + boolean + "->value)");
+    this->line("break;");
+    this->close();
+    this->open("");
+    this->emit(body);
+    this->close();
+    this->close();
+
+    auto target = std::move(this->function().targets.back());
+    this->function().targets.pop_back();
+    if (target.jumped) {
+        this->line(label + ":;");
+    }
+
+    auto value = this->name("value");
+    this->line(
+        "ElementGuard " + value + " = " + this->context() +
+        ".garbage_collector->temporary(" + this->element(result) + ");"
+    );
+    return value;
+}
+
+} // namespace evaluator
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../ast/element.h"
+#include "expression.h"
+
+namespace evaluator {
+
+// Translates a parsed program into a standalone C++ program, which evaluates
+// it through the same runtime as the evaluator and prints its value. Each node
+// becomes the statements its `evaluate` would run, so the translated program
+// skips dispatching on nodes, and `break` and `return` jump out of the C++
+// function instead of throwing. Bodies of `func` and `lambda` become C++
+// functions, which functions created at run time evaluate instead of nodes.
+//
+// Values of expressions are held in `ElementGuard`s, so the garbage collector
+// sees the same roots it would while evaluating the program.
+class CppEmitter {
+    // A `while` or `prog` that `break` jumps out of
+    struct Target {
+        std::string label;
+        // The variable holding the value of a `prog`, empty for `while`
+        std::string result;
+        bool jumped = false;
+    };
+
+    // A C++ function being emitted
+    struct Function {
+        std::ostringstream code;
+        size_t indentation = 1;
+        // Variables holding the evaluation context, innermost last
+        std::vector<std::string> contexts{"context"};
+        std::vector<Target> targets;
+    };
+
+    // Constants at file scope, like spans, symbols and quoted elements
+    std::ostringstream constants;
+    std::unordered_map<std::string, std::string> interned;
+    std::ostringstream declarations;
+    std::ostringstream definitions;
+    std::vector<std::unique_ptr<Function>> functions;
+    size_t next = 0;
+
+    std::string name(std::string_view prefix);
+    Function& function();
+    std::string const& context();
+    void line(std::string const& text);
+    void open(std::string const& text);
+    void close(std::string const& text = "}");
+
+    // Returns the name of a constant defined by `initializer`, shared by equal
+    // initializers.
+    std::string constant(
+        std::string_view prefix,
+        std::string_view type,
+        std::string const& initializer
+    );
+    std::string span(ast::Span const& span);
+    std::string symbol(ast::Symbol const& symbol);
+    std::string element(ast::Element const& element);
+    std::string parameters(ast::Span span, Parameters const& parameters);
+    // Emits a C++ function evaluating `body`, and returns the name of the
+    // `Body` that functions created from it share.
+    std::string body(Body const& body);
+    // Emits a check that `value` holds a boolean, and returns the variable
+    // holding the boolean.
+    std::string boolean(std::string const& value, std::string_view message);
+
+  public:
+    CppEmitter();
+
+    // Writes the translation of `program`.
+    void emit(Program const& program, std::ostream& stream);
+    void emit_program(Body const& program);
+
+    // Emits statements evaluating the expression in the current C++ function,
+    // and returns an expression naming the `ElementGuard` holding its value.
+    std::string emit(Expression const& expression);
+    std::string emit(Body const& body);
+
+    std::string emit_read(ast::Symbol const& variable);
+    std::string emit_constant(ast::Element const& element);
+    std::string
+    emit_assignment(ast::Symbol const& variable, Expression const& initializer);
+    std::string emit_cond(
+        Expression const& condition,
+        Expression const& then,
+        Expression const& otherwise
+    );
+    std::string emit_switch(
+        Expression const& value,
+        ast::ElementKind kind,
+        std::vector<std::shared_ptr<ast::Element>> const& cases,
+        std::vector<std::unique_ptr<Expression>> const& branches
+    );
+    std::string emit_return(Expression const& expression);
+    std::string emit_break(Expression const& expression);
+    std::string emit_call(
+        ast::Span span,
+        Expression const& function,
+        std::shared_ptr<ast::Symbol> const& callee,
+        std::vector<std::unique_ptr<Expression>> const& arguments
+    );
+    std::string emit_func(
+        ast::Span span,
+        ast::Symbol const& name,
+        Parameters const& parameters,
+        Body const& body
+    );
+    std::string
+    emit_lambda(ast::Span span, Parameters const& parameters, Body const& body);
+    std::string emit_prog(Parameters const& variables, Body const& body);
+    std::string emit_loop(
+        Expression const& condition, Body const& body, ast::Null const& result
+    );
+};
+
+} // namespace evaluator
@@ -0,0 +1,51 @@
+#include "dead_code.h"
+
+namespace evaluator {
+
+void DeadCodeEliminator::eliminate(std::unique_ptr<Expression>& expression) {
+    if (auto replacement = expression->eliminate_dead_code(*this)) {
+        expression = std::move(replacement);
+    }
+}
+
+void DeadCodeEliminator::eliminate(Body& body) {
+    auto& statements = body.body;
+
+    std::vector<std::unique_ptr<Expression>> kept;
+    for (size_t index = 0; index < statements.size(); ++index) {
+        this->eliminate(statements[index]);
+
+        bool last = index + 1 == statements.size();
+        if (!last && DeadCodeEliminator::is_removable(*statements[index])) {
+            continue;
+        }
+        kept.push_back(std::move(statements[index]));
+
+        // Nothing after it is ever evaluated
+        if (kept.back()->diverges()) {
+            break;
+        }
+    }
+
+    auto removed = statements.size() - kept.size();
+    statements = std::move(kept);
+    if (removed > 0) {
+        this->remove(removed);
+        body.update_captures_scope();
+    }
+}
+
+void DeadCodeEliminator::remove(size_t count) { this->removed += count; }
+
+size_t DeadCodeEliminator::get_removed() const { return this->removed; }
+
+bool DeadCodeEliminator::is_removable(Expression const& expression) {
+    // Constants that rely on built-ins may fall back to calling something else
+    BuiltInGuard guard;
+    if (expression.constant(guard) && guard.empty()) {
+        return true;
+    }
+    return dynamic_cast<Lambda const*>(&expression) != nullptr;
+}
+
+} // namespace evaluator
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "expression.h"
+
+namespace evaluator {
+
+// Removes code that never runs or whose only effect is computing a value
+// nothing uses: statements after one that always returns or breaks, `cond`
+// branches a literal condition never picks, and statements of bodies besides
+// the last one that can neither fail nor have effects.
+//
+// Runs before the other optimizations, and counts the expressions it removes
+// so `--semantic` can report them.
+class DeadCodeEliminator {
+    size_t removed = 0;
+
+    // Whether evaluating the expression can neither fail nor have effects.
+    static bool is_removable(Expression const& expression);
+
+  public:
+    void eliminate(std::unique_ptr<Expression>& expression);
+    void eliminate(Body& body);
+    // Records that an expression dropped `count` of its subexpressions.
+    void remove(size_t count);
+
+    size_t get_removed() const;
+};
+
+} // namespace evaluator
@@ -1,5 +1,11 @@
+#include <algorithm>
+
+#include "background_optimizer.h"
+#include "dead_code.h"
 #include "evaluator.h"
 #include "function.h"
+#include "optimizer.h"
+#include "pass_manager.h"
 
 namespace evaluator {
 
@@ -36,6 +42,14 @@ Evaluator::Evaluator() : global(this->garbage_collector.create_scope(nullptr)) {
         ast::Symbol("eval", nowhere), std::make_shared<EvalFunction>()
     );
 
+    this->global->define(
+        ast::Symbol("memo", nowhere), std::make_shared<MemoFunction>()
+    );
+    this->global->define(
+        ast::Symbol("specialize", nowhere),
+        std::make_shared<SpecializeFunction>()
+    );
+
     this->global->define(
         ast::Symbol("equal", nowhere), std::make_shared<EqualFunction>()
     );
@@ -91,10 +105,45 @@ Evaluator::Evaluator() : global(this->garbage_collector.create_scope(nullptr)) {
     );
 }
 
+size_t Evaluator::eliminate_dead_code(Program& program) {
+    DeadCodeEliminator eliminator;
+    program.eliminate_dead_code(eliminator);
+    return eliminator.get_removed();
+}
+
+void Evaluator::optimize(Program& program) {
+    // Functions get the rest once they are hot
+    auto level = PassManager::level;
+    if (BackgroundOptimizer::enabled) {
+        level = std::min(level, BackgroundOptimizer::EAGER_LEVEL);
+    }
+
+    Optimizer optimizer(&this->garbage_collector, *this->global);
+    PassManager::run(program, optimizer, level);
+}
+
 ElementGuard Evaluator::evaluate(Program program) {
     return program.evaluate(
-        EvaluationContext(&this->garbage_collector, *this->global)
+        EvaluationContext(&this->garbage_collector, this->global.get())
+    );
+}
+
+ElementGuard Evaluator::evaluate(Closure const& program) {
+    return program(
+        EvaluationContext(&this->garbage_collector, this->global.get())
     );
 }
 
+ElementGuard Evaluator::call(
+    Function const& function,
+    std::span<std::shared_ptr<ast::Element> const> arguments,
+    ast::Span call_site
+) {
+    return function.call(CallFrame(
+        arguments,
+        call_site,
+        EvaluationContext(&this->garbage_collector, this->global.get())
+    ));
+}
+
 } // namespace evaluator
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <span>
+
 #include "../ast/element.h"
 #include "expression.h"
 
@@ -12,7 +15,22 @@ class Evaluator {
   public:
     Evaluator();
 
+    // Removes dead code from the program, returning how many expressions were
+    // removed. Optimizing the program does this first.
+    size_t eliminate_dead_code(Program& program);
+    // Optimizes the program for evaluation in this evaluator's global scope,
+    // running the passes of `PassManager::level`.
+    void optimize(Program& program);
     ElementGuard evaluate(Program program);
+    // Evaluates a program translated by `CppEmitter` and compiled into
+    // `program`.
+    ElementGuard evaluate(Closure const& program);
+    // Calls `function` from the global scope.
+    ElementGuard call(
+        Function const& function,
+        std::span<std::shared_ptr<ast::Element> const> arguments,
+        ast::Span call_site
+    );
 };
 
 } // namespace evaluator
@@ -2,20 +2,49 @@
 
 #include "../ast/element.h"
 #include "../ast/kind.h"
+#include "inline_cache.h"
 #include "scope.h"
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace evaluator {
 
+class BuiltInGuard;
+class ClosureConverter;
+class CommonSubexpressionEliminator;
+class CppEmitter;
+class DeadCodeEliminator;
+class Function;
+class Inliner;
+class JitCompiler;
+class LoopOptimizer;
+class Native;
+class Optimizer;
+class PartialEvaluator;
+class PurityAnalysis;
+class TypeInference;
+class TypeProfile;
+class Unboxer;
+
+// Borrows the garbage collector and the scope from the caller, who keeps them
+// alive during evaluation, so passing the context around doesn't touch
+// reference counts.
 class EvaluationContext {
   public:
     GarbageCollector* garbage_collector;
-    std::shared_ptr<Scope> scope;
+    Scope* scope;
 
-    EvaluationContext(GarbageCollector*, std::shared_ptr<Scope>);
+    EvaluationContext(GarbageCollector*, Scope*);
 };
 
+// Code translated into C++ ahead of time by `CppEmitter`.
+using Closure = std::function<ElementGuard(EvaluationContext)>;
+
 class Expression {
   public:
     ast::Span span;
@@ -32,13 +61,110 @@ class Expression {
 
     // Returns in the sense "evaluating this expression will always end up
     // calling `return`"
-    virtual bool returns() const = 0;
-    virtual bool breaks() const = 0;
-    virtual bool diverges() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const = 0;
-    virtual bool can_break_with(ast::ElementKind kind) const = 0;
-    virtual void validate_no_free_break() const = 0;
-    virtual void validate_no_break_with_value() const = 0;
+    bool returns() const;
+    bool breaks() const;
+    bool diverges() const;
+    bool can_evaluate_to(ast::ElementKind kind) const;
+    bool can_break_with(ast::ElementKind kind) const;
+    void validate_no_free_break() const;
+    void validate_no_break_with_value() const;
+
+    virtual std::unique_ptr<Expression> clone() const = 0;
+
+    // Removes unreachable and unused subexpressions in place through
+    // `eliminator`. Returns an expression to replace this one with, or
+    // `nullptr` if this one should be kept.
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator) = 0;
+    // Folds constant subexpressions in place. Returns an expression to replace
+    // this one with, or `nullptr` if this one should be kept.
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer
+    ) = 0;
+    // Returns the value this expression always evaluates to if it is known
+    // before evaluation, adding assumptions the value relies on to `guard`.
+    virtual std::shared_ptr<ast::Element> constant(BuiltInGuard& guard) const;
+
+    // Returns the kinds of values the expression may evaluate to, replacing
+    // itself with a specialized version through `inference` if possible.
+    virtual ast::Kinds infer_types(TypeInference& inference) = 0;
+    // Whether the expression may create a closure or call `eval`, either of
+    // which can assign variables of the current scope out of sight.
+    virtual bool may_capture_scope() const = 0;
+    // Whether evaluating the expression has no effects visible outside of the
+    // function being analyzed and depends on nothing but its variables.
+    virtual bool is_pure(PurityAnalysis& analysis) const = 0;
+
+    // Emits machine code computing the expression through `compiler`, and
+    // returns the kind of its value. By default, the expression can't be
+    // compiled.
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    // Emits C++ statements computing the expression through `emitter`, and
+    // returns the C++ expression holding its value. Only expressions of parsed
+    // programs can be emitted.
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+
+    // Wraps loop-invariant subexpressions in `Invariant` through `optimizer`.
+    // Returns whether the whole expression is invariant in the current loop.
+    virtual bool hoist_invariants(LoopOptimizer& optimizer) = 0;
+
+    // Keeps numeric variables of loops unboxed through `unboxer`. Returns an
+    // expression to replace this one with, or `nullptr` if this one should be
+    // kept.
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer) = 0;
+    // Returns a version of the expression that computes a value of `kind`
+    // without boxing it, or `nullptr` if there is none.
+    virtual std::unique_ptr<Native>
+    unboxed(Unboxer& unboxer, ast::ElementKind kind) const;
+
+    // Reports the variables the expression reads, assigns and defines to
+    // `converter`, which decides what closures need from their scopes.
+    virtual void convert_closures(ClosureConverter& converter) = 0;
+
+    // Replaces calls to small user-defined functions with copies of their
+    // bodies through `inliner`. Returns an expression to replace this one
+    // with, or `nullptr` if this one should be kept.
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner) = 0;
+    // Returns a copy of the expression to inline into a call site, with
+    // parameters of the function being inlined read from the call, or
+    // `nullptr` if the expression can't be inlined.
+    virtual std::unique_ptr<Expression> inline_copy(Inliner& inliner) const;
+    // Returns a copy of the expression as parsed for `evaluator`, with the
+    // parameters it knows the values of replaced by them, or `nullptr` if the
+    // expression can't be copied.
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+
+    // Reports the variables the expression reads and assigns to `eliminator`,
+    // which shares the values of repeated pure subexpressions. Returns a key
+    // that equal values of pure expressions over unchanged variables share, or
+    // nothing if the expression isn't one.
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator
+    ) = 0;
+
+  private:
+    // What the analyses above found. Enclosing expressions ask for them again
+    // while they are parsed, so they are computed once per expression,
+    // bottom-up, when first asked for.
+    struct Analysis {
+        bool returns;
+        bool breaks;
+        ast::Kinds values;
+        ast::Kinds break_values;
+    };
+
+    mutable std::optional<Analysis> analysis;
+    mutable bool no_free_break = false;
+    mutable bool no_break_with_value = false;
+
+    Analysis const& analyze() const;
+
+    virtual bool _returns() const = 0;
+    virtual bool _breaks() const = 0;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const = 0;
+    virtual bool _can_break_with(ast::ElementKind kind) const = 0;
+    virtual void _validate_no_free_break() const = 0;
+    virtual void _validate_no_break_with_value() const = 0;
 };
 
 class Parameters {
@@ -56,20 +182,67 @@ class Parameters {
     void display(std::ostream& stream, size_t depth) const;
 };
 
+// The value of a subexpression repeated in a body, computed by the first
+// occurrence evaluated and reused by the others.
+struct CommonValue {
+    std::shared_ptr<ast::Element> element;
+    uint64_t version = 0;
+};
+
 class Body {
+    mutable Closure compiled;
+    // Computed when the body is built and again once closures in it are
+    // converted, as optimizations never introduce closures. Nested bodies
+    // would otherwise be scanned again for every enclosing one.
+    bool captures_scope;
+    // Set for bodies of programs translated by `CppEmitter`, which have no
+    // expressions and are always evaluated through `compiled`
+    bool ahead_of_time = false;
+
   public:
     std::vector<std::unique_ptr<Expression>> body;
+    // Values of common subexpressions of the body, forgotten each time it is
+    // evaluated
+    std::vector<std::shared_ptr<CommonValue>> common;
 
     Body(std::vector<std::unique_ptr<Expression>> body);
+    // A body translated ahead of time into `compiled`.
+    Body(Closure compiled, bool captures_scope);
 
     static Body parse(std::shared_ptr<ast::List> unparsed);
 
+    Body clone() const;
+
     ElementGuard evaluate(EvaluationContext context) const;
+    // Creates the scope to evaluate the body in, bypassing the garbage
+    // collector when no closure can capture it.
+    ScopeGuard
+    create_scope(GarbageCollector* garbage_collector, std::shared_ptr<Scope> parent)
+        const;
 
     void display(std::ostream& stream, size_t depth) const;
 
     void validate_no_free_break() const;
     void validate_no_break_with_value() const;
+
+    bool may_capture_scope() const;
+    void update_captures_scope();
+    bool is_pure(PurityAnalysis& analysis) const;
+    // Returns a copy of the body for `evaluator`, or nothing if it can't be
+    // copied.
+    std::optional<Body> partial_copy(PartialEvaluator& evaluator) const;
+};
+
+// Forgets the values of common subexpressions of a body while it is
+// evaluated, and restores them afterwards in case the body was entered again
+// by a recursive call.
+class CommonFrame {
+    std::vector<std::shared_ptr<CommonValue>> const& values;
+    std::vector<CommonValue> saved;
+
+  public:
+    CommonFrame(std::vector<std::shared_ptr<CommonValue>> const& values);
+    ~CommonFrame();
 };
 
 class Program {
@@ -82,6 +255,17 @@ class Program {
 
     ElementGuard evaluate(EvaluationContext context) const;
 
+    void eliminate_dead_code(DeadCodeEliminator& eliminator);
+    void fold_constants(Optimizer& optimizer);
+    void infer_types(TypeInference& inference);
+    void hoist_invariants(LoopOptimizer& optimizer);
+    void unbox(Unboxer& unboxer);
+    void convert_closures(ClosureConverter& converter);
+    void inline_calls(Inliner& inliner);
+    void eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator
+    );
+    void emit_cpp(CppEmitter& emitter) const;
+
     void display(std::ostream& stream, size_t depth) const;
     friend std::ostream& operator<<(std::ostream& stream, Program const& self);
 };
@@ -92,15 +276,39 @@ class Symbol : public Expression {
   public:
     Symbol(std::shared_ptr<ast::Symbol> symbol);
 
+    std::shared_ptr<ast::Symbol> const& variable() const;
+
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression> inline_copy(Inliner& inliner) const;
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+    virtual std::unique_ptr<Native>
+    unboxed(Unboxer& unboxer, ast::ElementKind kind) const;
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
 class Quote : public Expression {
@@ -115,12 +323,35 @@ class Quote : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression> inline_copy(Inliner& inliner) const;
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+    virtual std::unique_ptr<Native>
+    unboxed(Unboxer& unboxer, ast::ElementKind kind) const;
+    virtual std::shared_ptr<ast::Element> constant(BuiltInGuard& guard) const;
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
 class Setq : public Expression {
@@ -140,12 +371,31 @@ class Setq : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
 class Cond : public Expression {
@@ -167,12 +417,106 @@ class Cond : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression> inline_copy(Inliner& inliner) const;
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// Finds the branch of a `switch` for a value in constant time: from an array
+// indexed by the value if the values of the cases are close together, and
+// from a hash map otherwise.
+class JumpTable {
+    int64_t lowest = 0;
+    std::vector<size_t> dense;
+    std::unordered_map<int64_t, size_t> sparse;
+    size_t missing;
+
+  public:
+    // Array slots allowed per case before a hash map is used instead
+    static constexpr size_t DENSITY = 4;
+
+    JumpTable(std::vector<int64_t> const& values);
+
+    // Returns the index of `value` in the values, or their number if it isn't
+    // one of them.
+    size_t find(int64_t value) const;
+};
+
+class Switch : public Expression {
+    std::unique_ptr<Expression> value;
+    // Integers or booleans, all of the same kind
+    std::vector<std::shared_ptr<ast::Element>> cases;
+    // The branch of each case, followed by the one taken if no case matches
+    std::vector<std::unique_ptr<Expression>> branches;
+    ast::ElementKind kind;
+    JumpTable table;
+
+    // Returns the branch taken for `value`, or `nullptr` if it has the wrong
+    // kind.
+    Expression const* select(ast::Element const& value) const;
+
+  public:
+    Switch(
+        ast::Span span,
+        std::unique_ptr<Expression> value,
+        std::vector<std::shared_ptr<ast::Element>> cases,
+        std::vector<std::unique_ptr<Expression>> branches
+    );
+
+    static std::unique_ptr<Switch>
+    parse(ast::Span span, std::shared_ptr<ast::List> arguments);
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression> inline_copy(Inliner& inliner) const;
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
 class Return : public Expression {
@@ -187,12 +531,31 @@ class Return : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
 class Break : public Expression {
@@ -207,18 +570,56 @@ class Break : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
 class Call : public Expression {
     std::unique_ptr<Expression> function;
     std::vector<std::unique_ptr<Expression>> arguments;
 
+    // Set if the callee is a plain variable, whose lookup can then be cached.
+    std::shared_ptr<ast::Symbol> callee;
+    mutable InlineCache cache;
+    // Set if profiles of calls are dumped
+    std::shared_ptr<TypeProfile> profile;
+
+    std::shared_ptr<Function> resolve_callee(
+        EvaluationContext context, std::optional<ElementGuard>& function_guard
+    ) const;
+    // Returns a version of the call specialized for the kinds of arguments.
+    std::unique_ptr<Expression> specialize(
+        std::shared_ptr<Function> const& function,
+        std::vector<ast::Kinds> const& argument_kinds
+    );
+    // Returns a `BuiltInCall` of `function` for the kinds of arguments that
+    // aren't worth specializing for.
+    std::unique_ptr<Expression>
+    fuse(BuiltInGuard guard, std::shared_ptr<Function> const& function);
+
   public:
     Call(
         ast::Span span,
@@ -231,18 +632,54 @@ class Call : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression> inline_copy(Inliner& inliner) const;
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// Variables a closure copies from the scope it's created in, when it needs
+// nothing else from that scope. Decided by `ClosureConverter`.
+struct Captures {
+    bool converted = false;
+    std::vector<std::shared_ptr<ast::Symbol>> variables;
+
+    void display(std::ostream& stream) const;
+    // Creates the scope a converted closure keeps, or returns `nullptr` if the
+    // closure keeps `scope` itself.
+    std::shared_ptr<Scope> copy(Scope& scope) const;
 };
 
 class Func : public Expression {
     std::shared_ptr<ast::Symbol> name;
     Parameters parameters;
     std::shared_ptr<Body> body;
+    Captures captures;
+    // The definition as parsed, kept for `BackgroundOptimizer` and `Jit` if
+    // either is enabled
+    std::shared_ptr<Func const> source;
 
   public:
     Func(
@@ -258,17 +695,41 @@ class Func : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+    friend class BackgroundOptimizer;
+    friend class Inliner;
+    friend class Jit;
+    friend class OptimizationJob;
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
 class Lambda : public Expression {
     Parameters parameters;
     std::shared_ptr<Body> body;
+    Captures captures;
 
   public:
     Lambda(ast::Span span, Parameters parameters, std::shared_ptr<Body> body);
@@ -279,12 +740,30 @@ class Lambda : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
 class Prog : public Expression {
@@ -300,17 +779,42 @@ class Prog : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
+class Invariant;
+
 class While : public Expression {
     std::unique_ptr<Expression> condition;
     Body body;
+    std::shared_ptr<ast::Null> result;
+
+    // Hoisted from the condition and the body, and forgotten on each entry
+    std::vector<Invariant*> invariants;
 
   public:
     While(ast::Span span, std::unique_ptr<Expression> condition, Body body);
@@ -321,12 +825,774 @@ class While : public Expression {
     virtual ElementGuard evaluate(EvaluationContext context) const;
     virtual void display(std::ostream& stream, size_t depth) const;
 
-    virtual bool returns() const;
-    virtual bool breaks() const;
-    virtual bool can_evaluate_to(ast::ElementKind kind) const;
-    virtual bool can_break_with(ast::ElementKind kind) const;
-    virtual void validate_no_free_break() const;
-    virtual void validate_no_break_with_value() const;
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual ast::ElementKind jit(JitCompiler& compiler) const;
+    virtual std::string emit_cpp(CppEmitter& emitter) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// A call to a built-in function with one or two arguments, which the callee
+// variable was found to hold during optimization. The callee isn't looked up,
+// and arguments are passed from a local array instead of the argument stack.
+class BuiltInCall : public Expression {
+    std::shared_ptr<Function> function;
+    std::vector<std::unique_ptr<Expression>> arguments;
+    // Set if profiles of calls are dumped
+    std::shared_ptr<TypeProfile> profile;
+
+  public:
+    static constexpr size_t MAX_ARGUMENTS = 2;
+
+    BuiltInCall(
+        ast::Span span,
+        std::shared_ptr<Function> function,
+        std::vector<std::unique_ptr<Expression>> arguments
+    );
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// A loop-invariant expression hoisted by `LoopOptimizer`. It is evaluated on
+// first use after entering the loop, and its value is reused until the loop
+// exits or `Scope::version` changes. Evaluation stays lazy, so an expression
+// that would fail or is in a branch never taken isn't evaluated early.
+class Invariant : public Expression {
+  public:
+    struct Value {
+        std::shared_ptr<ast::Element> element;
+        uint64_t version = 0;
+    };
+
+  private:
+    std::unique_ptr<Expression> expression;
+    mutable Value value;
+
+  public:
+    Invariant(std::unique_ptr<Expression> expression);
+
+    // Forgets the value, returning it so that a recursive entry into the same
+    // loop can restore the outer entry's value when it exits.
+    Value reset() const;
+    void restore(Value value) const;
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// An occurrence of a subexpression that `CommonSubexpressionEliminator` found
+// repeated in a body. The first occurrence evaluated in an evaluation of the
+// body computes the value, and the others reuse it as long as `Scope::version`
+// stays the same.
+class Common : public Expression {
+    std::shared_ptr<CommonValue> value;
+    std::unique_ptr<Expression> expression;
+
+  public:
+    Common(
+        std::shared_ptr<CommonValue> value, std::unique_ptr<Expression> expression
+    );
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// Evaluates an optimized version of an expression as long as the assumptions it
+// was optimized under hold, and the original expression otherwise.
+class Guarded : public Expression {
+    mutable BuiltInGuard guard;
+    std::unique_ptr<Expression> optimized;
+    std::unique_ptr<Expression> fallback;
+
+  public:
+    Guarded(
+        BuiltInGuard guard,
+        std::unique_ptr<Expression> optimized,
+        std::unique_ptr<Expression> fallback
+    );
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+    virtual std::unique_ptr<Native>
+    unboxed(Unboxer& unboxer, ast::ElementKind kind) const;
+    virtual std::shared_ptr<ast::Element> constant(BuiltInGuard& guard) const;
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// What remains of a built-in call like `(times x 1)` after simplification:
+// evaluates the operand and checks that the built-in would have accepted it.
+class Identity : public Expression {
+    std::unique_ptr<Expression> operand;
+    std::vector<ast::ElementKind> accepted_kinds;
+    std::string error;
+
+  public:
+    Identity(
+        ast::Span span,
+        std::unique_ptr<Expression> operand,
+        std::vector<ast::ElementKind> accepted_kinds,
+        std::string error
+    );
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// Boxes numbers, reusing elements once nothing else refers to them, so a loop
+// that keeps updating a number in a variable doesn't allocate.
+class NumberBoxes {
+    std::shared_ptr<ast::Integer> integers[2];
+    std::shared_ptr<ast::Real> reals[2];
+
+  public:
+    std::shared_ptr<ast::Element> integer(int64_t value, ast::Span span);
+    std::shared_ptr<ast::Element> real(double value, ast::Span span);
+};
+
+// A call to an arithmetic built-in specialized for the kinds of arguments
+// type inference predicted, or that `TypeFeedback` found it to be called with.
+// Other arguments are passed to the built-in itself.
+class Arithmetic : public Expression {
+  public:
+    enum class Operation { PLUS, MINUS, TIMES, DIVIDE };
+
+  private:
+    Operation operation;
+    std::shared_ptr<Function> function;
+    mutable ast::ElementKind left_kind;
+    mutable ast::ElementKind right_kind;
+    std::unique_ptr<Expression> left;
+    std::unique_ptr<Expression> right;
+    // Set while the kinds of arguments are profiled, or dumped
+    mutable std::shared_ptr<TypeProfile> profile;
+    // Whether the kinds above are known yet
+    mutable bool specialized;
+
+    mutable NumberBoxes boxes;
+
+    ElementGuard apply(
+        EvaluationContext context, ElementGuard& left, ElementGuard& right
+    ) const;
+    void observe(ast::ElementKind left, ast::ElementKind right) const;
+
+  public:
+    Arithmetic(
+        ast::Span span,
+        Operation operation,
+        std::shared_ptr<Function> function,
+        ast::ElementKind left_kind,
+        ast::ElementKind right_kind,
+        std::unique_ptr<Expression> left,
+        std::unique_ptr<Expression> right
+    );
+    // Profiles the kinds of arguments instead, until the call is hot.
+    Arithmetic(
+        ast::Span span,
+        Operation operation,
+        std::shared_ptr<Function> function,
+        std::shared_ptr<TypeProfile> profile,
+        std::unique_ptr<Expression> left,
+        std::unique_ptr<Expression> right
+    );
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+    virtual std::unique_ptr<Native>
+    unboxed(Unboxer& unboxer, ast::ElementKind kind) const;
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// A call to a comparison built-in specialized for arguments of the same kind,
+// predicted by type inference or found by `TypeFeedback`.
+class Comparison : public Expression {
+  public:
+    enum class Operation { EQUAL, NONEQUAL, LESS, LESSEQ, GREATER, GREATEREQ };
+
+  private:
+    Operation operation;
+    std::shared_ptr<Function> function;
+    mutable ast::ElementKind kind;
+    std::unique_ptr<Expression> left;
+    std::unique_ptr<Expression> right;
+    std::shared_ptr<ast::Boolean> true_value;
+    std::shared_ptr<ast::Boolean> false_value;
+    // Set while the kinds of arguments are profiled, or dumped
+    mutable std::shared_ptr<TypeProfile> profile;
+    // Whether the kind above is known yet
+    mutable bool specialized;
+
+    ElementGuard apply(
+        EvaluationContext context, ElementGuard& left, ElementGuard& right
+    ) const;
+    void observe(ast::ElementKind left, ast::ElementKind right) const;
+
+  public:
+    Comparison(
+        ast::Span span,
+        Operation operation,
+        std::shared_ptr<Function> function,
+        ast::ElementKind kind,
+        std::unique_ptr<Expression> left,
+        std::unique_ptr<Expression> right
+    );
+    // Profiles the kinds of arguments instead, until the call is hot.
+    Comparison(
+        ast::Span span,
+        Operation operation,
+        std::shared_ptr<Function> function,
+        std::shared_ptr<TypeProfile> profile,
+        std::unique_ptr<Expression> left,
+        std::unique_ptr<Expression> right
+    );
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+    virtual std::unique_ptr<Native>
+    unboxed(Unboxer& unboxer, ast::ElementKind kind) const;
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+char const* operation_name(Arithmetic::Operation operation);
+char const* operation_name(Comparison::Operation operation);
+
+// Returns the operation a built-in function performs, if it's one that calls
+// are specialized for.
+std::optional<Arithmetic::Operation> arithmetic_operation(Function const& function
+);
+std::optional<Comparison::Operation> comparison_operation(Function const& function
+);
+
+// The value of a variable `Unboxer` keeps unboxed while a loop runs.
+struct Slot {
+    std::shared_ptr<ast::Symbol> variable;
+    // `NULL_` until the kind of the variable is known
+    ast::ElementKind kind = ast::ElementKind::NULL_;
+    // Whether the loop may read the variable before assigning it, in which
+    // case it must hold a value of `kind` on entry
+    bool read_before_assigned = false;
+
+    int64_t integer = 0;
+    double real = 0;
+    // Whether the slot holds the value of the variable, and should be stored
+    // back on exit
+    bool initialized = false;
+
+    Slot(std::shared_ptr<ast::Symbol> variable);
+};
+
+// An integer, real or boolean expression evaluated without boxing values.
+// Only the accessor for `kind` may be called, except that integers may also
+// be read as reals.
+class Native {
+  public:
+    ast::Span span;
+    ast::ElementKind kind;
+
+    Native(ast::Span span, ast::ElementKind kind);
+    virtual ~Native() = default;
+
+    virtual int64_t integer() const;
+    virtual double real() const;
+    virtual bool boolean() const;
+
+    virtual void display(std::ostream& stream, size_t depth) const = 0;
+    virtual std::unique_ptr<Native> clone() const = 0;
+};
+
+class NativeSlot : public Native {
+    Slot* slot;
+
+  public:
+    NativeSlot(ast::Span span, Slot* slot);
+
+    virtual int64_t integer() const;
+    virtual double real() const;
+
+    virtual void display(std::ostream& stream, size_t depth) const;
+    virtual std::unique_ptr<Native> clone() const;
+};
+
+class NativeConstant : public Native {
+    int64_t integer_value;
+    double real_value;
+
+  public:
+    NativeConstant(ast::Span span, int64_t value);
+    NativeConstant(ast::Span span, double value);
+
+    virtual int64_t integer() const;
+    virtual double real() const;
+
+    virtual void display(std::ostream& stream, size_t depth) const;
+    virtual std::unique_ptr<Native> clone() const;
+};
+
+class NativeArithmetic : public Native {
+    Arithmetic::Operation operation;
+    std::unique_ptr<Native> left;
+    std::unique_ptr<Native> right;
+
+  public:
+    NativeArithmetic(
+        ast::Span span,
+        Arithmetic::Operation operation,
+        std::unique_ptr<Native> left,
+        std::unique_ptr<Native> right
+    );
+
+    virtual int64_t integer() const;
+    virtual double real() const;
+
+    virtual void display(std::ostream& stream, size_t depth) const;
+    virtual std::unique_ptr<Native> clone() const;
+};
+
+class NativeComparison : public Native {
+    Comparison::Operation operation;
+    std::unique_ptr<Native> left;
+    std::unique_ptr<Native> right;
+
+  public:
+    NativeComparison(
+        ast::Span span,
+        Comparison::Operation operation,
+        std::unique_ptr<Native> left,
+        std::unique_ptr<Native> right
+    );
+
+    virtual bool boolean() const;
+
+    virtual void display(std::ostream& stream, size_t depth) const;
+    virtual std::unique_ptr<Native> clone() const;
+};
+
+// A native expression whose value is needed boxed, like a variable kept
+// unboxed that is passed to a function or returned.
+class Unboxed : public Expression {
+    std::unique_ptr<Native> native;
+    mutable NumberBoxes boxes;
+    std::shared_ptr<ast::Boolean> true_value;
+    std::shared_ptr<ast::Boolean> false_value;
+
+  public:
+    Unboxed(std::unique_ptr<Native> native);
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+    virtual std::unique_ptr<Native>
+    unboxed(Unboxer& unboxer, ast::ElementKind kind) const;
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// Assigns a variable kept unboxed.
+class UnboxedSetq : public Expression {
+    Slot* slot;
+    std::unique_ptr<Native> initializer;
+    mutable NumberBoxes boxes;
+
+  public:
+    UnboxedSetq(ast::Span span, Slot* slot, std::unique_ptr<Native> initializer);
+
+    // Assigns the variable without boxing the value, for when it's unused.
+    void assign() const;
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// A `while` loop that keeps some variables in slots instead of the scope.
+// The outermost one loads them on entry and stores them back on exit, while
+// loops nested in it share its slots.
+//
+// Entering the loop checks the assumptions about built-ins its specialized
+// calls were made under, and that the variables hold values of the expected
+// kinds. Nothing in the loop can invalidate either, so the rest of the loop
+// runs without checks. If they don't hold, the original loop runs instead.
+class UnboxedWhile : public Expression {
+    std::vector<std::unique_ptr<Slot>> slots;
+    mutable BuiltInGuard guard;
+    // Either the native or the boxed condition is set
+    std::unique_ptr<Native> native_condition;
+    std::unique_ptr<Expression> condition;
+    Body body;
+    // The statements of `body` that only assign an unboxed variable
+    std::vector<UnboxedSetq const*> assignments;
+    // Unset for nested loops
+    std::unique_ptr<Expression> fallback;
+    std::shared_ptr<ast::Null> result;
+
+    // Runs the loop once the slots are loaded.
+    void run(EvaluationContext context) const;
+
+  public:
+    UnboxedWhile(
+        ast::Span span,
+        std::vector<std::unique_ptr<Slot>> slots,
+        BuiltInGuard guard,
+        std::unique_ptr<Native> native_condition,
+        std::unique_ptr<Expression> condition,
+        Body body,
+        std::unique_ptr<Expression> fallback
+    );
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// The arguments of an inlined call, which its copy of the function body reads
+// instead of the parameters of the function.
+struct InlinedFrame {
+    std::vector<std::shared_ptr<ast::Symbol>> parameters;
+    // Kinds of values type inference expects the arguments to have
+    std::vector<ast::Kinds> kinds;
+    // Set while the body of the call is evaluated
+    std::shared_ptr<ast::Element> const* arguments = nullptr;
+};
+
+// A call to a user-defined function replaced by `Inliner` with a copy of the
+// function body. Evaluates the arguments, then the copy, without creating a
+// scope.
+//
+// Only runs the copy if the variable still holds a function with the same
+// body and the built-ins the copy calls weren't rebound. Otherwise, it makes
+// the original call instead.
+class Inlined : public Expression {
+    std::shared_ptr<ast::Symbol> callee;
+    // The body of the function, which identifies functions created from the
+    // same definition
+    std::shared_ptr<Body> definition;
+    mutable BuiltInGuard guard;
+    mutable uint64_t version = 0;
+    mutable bool holds = false;
+    std::vector<std::unique_ptr<Expression>> arguments;
+    std::unique_ptr<InlinedFrame> frame;
+    std::unique_ptr<Expression> body;
+    std::unique_ptr<Expression> fallback;
+
+    // Whether the copy of the body may be evaluated instead of the call.
+    bool check(Scope& scope) const;
+
+  public:
+    Inlined(
+        ast::Span span,
+        std::shared_ptr<ast::Symbol> callee,
+        std::shared_ptr<Body> definition,
+        BuiltInGuard guard,
+        std::vector<std::unique_ptr<Expression>> arguments,
+        std::unique_ptr<InlinedFrame> frame,
+        std::unique_ptr<Expression> body,
+        std::unique_ptr<Expression> fallback
+    );
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::unique_ptr<Expression> inline_copy(Inliner& inliner) const;
+    virtual std::unique_ptr<Expression>
+    partial_copy(PartialEvaluator& evaluator) const;
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
+};
+
+// Reads an argument of the inlined call whose copy of the body contains it.
+class InlinedParameter : public Expression {
+    std::shared_ptr<ast::Symbol> parameter;
+    InlinedFrame* frame;
+    size_t index;
+
+  public:
+    InlinedParameter(
+        std::shared_ptr<ast::Symbol> parameter, InlinedFrame* frame, size_t index
+    );
+
+    virtual ElementGuard evaluate(EvaluationContext context) const;
+    virtual void display(std::ostream& stream, size_t depth) const;
+
+    virtual std::unique_ptr<Expression> clone() const;
+    virtual std::unique_ptr<Expression>
+    eliminate_dead_code(DeadCodeEliminator& eliminator);
+    virtual std::unique_ptr<Expression> fold_constants(Optimizer& optimizer);
+    virtual ast::Kinds infer_types(TypeInference& inference);
+    virtual bool may_capture_scope() const;
+    virtual bool is_pure(PurityAnalysis& analysis) const;
+    virtual bool hoist_invariants(LoopOptimizer& optimizer);
+    virtual std::unique_ptr<Expression> unbox(Unboxer& unboxer);
+    virtual void convert_closures(ClosureConverter& converter);
+    virtual std::unique_ptr<Expression> inline_calls(Inliner& inliner);
+    virtual std::optional<std::string>
+    eliminate_common_subexpressions(CommonSubexpressionEliminator& eliminator);
+
+  private:
+    virtual bool _returns() const;
+    virtual bool _breaks() const;
+    virtual bool _can_evaluate_to(ast::ElementKind kind) const;
+    virtual bool _can_break_with(ast::ElementKind kind) const;
+    virtual void _validate_no_free_break() const;
+    virtual void _validate_no_break_with_value() const;
 };
 
 } // namespace evaluator
@@ -0,0 +1,345 @@
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../dead_code.h"
+#include "../error.h"
+#include "../expression.h"
+#include "../function.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../purity.h"
+#include "../type_feedback.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+using ast::Span;
+using utils::Depth;
+
+Arithmetic::Arithmetic(
+    Span span,
+    Operation operation,
+    std::shared_ptr<Function> function,
+    ElementKind left_kind,
+    ElementKind right_kind,
+    std::unique_ptr<Expression> left,
+    std::unique_ptr<Expression> right
+)
+    : Expression(span), operation(operation), function(std::move(function)),
+      left_kind(left_kind), right_kind(right_kind), left(std::move(left)),
+      right(std::move(right)), specialized(true) {}
+
+Arithmetic::Arithmetic(
+    Span span,
+    Operation operation,
+    std::shared_ptr<Function> function,
+    std::shared_ptr<TypeProfile> profile,
+    std::unique_ptr<Expression> left,
+    std::unique_ptr<Expression> right
+)
+    : Expression(span), operation(operation), function(std::move(function)),
+      left_kind(ElementKind::INTEGER), right_kind(ElementKind::INTEGER),
+      left(std::move(left)), right(std::move(right)),
+      profile(std::move(profile)), specialized(false) {}
+
+double to_double(ast::Element const* element, ElementKind kind) {
+    if (kind == ElementKind::INTEGER) {
+        return static_cast<ast::Integer const*>(element)->value;
+    }
+    return static_cast<ast::Real const*>(element)->value;
+}
+
+ElementGuard Arithmetic::evaluate(EvaluationContext context) const {
+    auto left = this->left->evaluate(context);
+    left.deactivate();
+    auto right = this->right->evaluate(context);
+    right.deactivate();
+    return this->apply(context, left, right);
+}
+
+ElementGuard Arithmetic::apply(
+    EvaluationContext context, ElementGuard& left, ElementGuard& right
+) const {
+    if (this->profile) {
+        this->observe(left.get()->kind, right.get()->kind);
+    }
+    if (!this->specialized || left.get()->kind != this->left_kind ||
+        right.get()->kind != this->right_kind) {
+        std::shared_ptr<ast::Element> arguments[] = {*left, *right};
+        CallFrame frame(arguments, this->span, context);
+        return this->function->call(std::move(frame));
+    }
+
+    if (this->left_kind == ElementKind::INTEGER &&
+        this->right_kind == ElementKind::INTEGER) {
+        auto a = static_cast<ast::Integer const*>(left.get())->value;
+        auto b = static_cast<ast::Integer const*>(right.get())->value;
+
+        int64_t result = 0;
+        switch (this->operation) {
+        case Operation::PLUS:
+            result = a + b;
+            break;
+        case Operation::MINUS:
+            result = a - b;
+            break;
+        case Operation::TIMES:
+            result = a * b;
+            break;
+        case Operation::DIVIDE:
+            if (b == 0) {
+                throw EvaluationError("division by zero", this->span);
+            }
+            result = a / b;
+            break;
+        }
+
+        return context.garbage_collector->temporary(this->boxes.integer(result, this->span));
+    }
+
+    auto a = to_double(left.get(), this->left_kind);
+    auto b = to_double(right.get(), this->right_kind);
+
+    double result = 0;
+    switch (this->operation) {
+    case Operation::PLUS:
+        result = a + b;
+        break;
+    case Operation::MINUS:
+        result = a - b;
+        break;
+    case Operation::TIMES:
+        result = a * b;
+        break;
+    case Operation::DIVIDE:
+        result = a / b;
+        break;
+    }
+
+    return context.garbage_collector->temporary(this->boxes.real(result, this->span));
+}
+
+void Arithmetic::observe(ElementKind left, ElementKind right) const {
+    this->profile->record(0, left);
+    this->profile->record(1, right);
+    if (!this->profile->evaluated()) {
+        return;
+    }
+
+    static constexpr ElementKind NUMBERS[] = {
+        ElementKind::INTEGER, ElementKind::REAL
+    };
+    auto left_kind = this->profile->single_kind(0, NUMBERS);
+    auto right_kind = this->profile->single_kind(1, NUMBERS);
+    if (left_kind && right_kind) {
+        this->left_kind = *left_kind;
+        this->right_kind = *right_kind;
+        this->specialized = true;
+        this->profile->specialize({*left_kind, *right_kind});
+    }
+
+    // A call that saw mixed kinds keeps calling the built-in
+    if (!TypeFeedback::dumping) {
+        this->profile = nullptr;
+    }
+}
+
+char const* operation_name(Arithmetic::Operation operation) {
+    switch (operation) {
+    case Arithmetic::Operation::PLUS:
+        return "plus";
+    case Arithmetic::Operation::MINUS:
+        return "minus";
+    case Arithmetic::Operation::TIMES:
+        return "times";
+    case Arithmetic::Operation::DIVIDE:
+        return "divide";
+    }
+    return "";
+}
+
+void Arithmetic::display(std::ostream& stream, size_t depth) const {
+    stream << "Arithmetic {\n";
+
+    stream << Depth(depth + 1)
+           << "operation = " << operation_name(this->operation) << '\n';
+
+    stream << Depth(depth + 1) << "left = ";
+    if (this->specialized) {
+        stream << this->left_kind << ' ';
+    }
+    this->left->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "right = ";
+    if (this->specialized) {
+        stream << this->right_kind << ' ';
+    }
+    this->right->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool Arithmetic::_returns() const {
+    return this->left->returns() || this->right->returns();
+}
+
+bool Arithmetic::_breaks() const {
+    return this->left->breaks() || this->right->breaks();
+}
+
+bool Arithmetic::_can_evaluate_to(ElementKind kind) const {
+    return kind == ElementKind::INTEGER || kind == ElementKind::REAL;
+}
+
+bool Arithmetic::_can_break_with(ElementKind kind) const {
+    if (this->left->can_break_with(kind)) {
+        return true;
+    }
+    if (this->left->diverges()) {
+        return false;
+    }
+    return this->right->can_break_with(kind);
+}
+
+void Arithmetic::_validate_no_free_break() const {
+    this->left->validate_no_free_break();
+    this->right->validate_no_free_break();
+}
+
+void Arithmetic::_validate_no_break_with_value() const {
+    this->left->validate_no_break_with_value();
+    this->right->validate_no_break_with_value();
+}
+
+std::unique_ptr<Expression> Arithmetic::clone() const {
+    if (!this->specialized) {
+        return std::make_unique<Arithmetic>(
+            this->span,
+            this->operation,
+            this->function,
+            TypeFeedback::profile(
+                this->span, operation_name(this->operation), 2
+            ),
+            this->left->clone(),
+            this->right->clone()
+        );
+    }
+
+    return std::make_unique<Arithmetic>(
+        this->span,
+        this->operation,
+        this->function,
+        this->left_kind,
+        this->right_kind,
+        this->left->clone(),
+        this->right->clone()
+    );
+}
+
+std::unique_ptr<Expression>
+Arithmetic::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->left);
+    eliminator.eliminate(this->right);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Arithmetic::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->left);
+    optimizer.fold_constants(this->right);
+    return nullptr;
+}
+
+ast::Kinds Arithmetic::infer_types(TypeInference& inference) {
+    auto left = inference.infer(this->left);
+    auto right = inference.infer(this->right);
+    return this->function->result_kinds({left, right});
+}
+
+bool Arithmetic::may_capture_scope() const {
+    return this->left->may_capture_scope() || this->right->may_capture_scope();
+}
+
+bool Arithmetic::is_pure(PurityAnalysis& analysis) const {
+    return this->left->is_pure(analysis) && this->right->is_pure(analysis);
+}
+
+bool Arithmetic::hoist_invariants(LoopOptimizer& optimizer) {
+    bool left = optimizer.hoist(this->left);
+    bool right = optimizer.hoist(this->right);
+    return left && right;
+}
+
+std::unique_ptr<Expression> Arithmetic::unbox(Unboxer& unboxer) {
+    if (!this->specialized) {
+        unboxer.unbox(this->left);
+        unboxer.unbox(this->right);
+        return nullptr;
+    }
+
+    unboxer.use(*this->left, this->left_kind);
+    unboxer.use(*this->right, this->right_kind);
+
+    if (unboxer.get_mode() == Unboxer::Mode::REWRITING) {
+        auto kind = this->left_kind == ElementKind::INTEGER &&
+                            this->right_kind == ElementKind::INTEGER
+                        ? ElementKind::INTEGER
+                        : ElementKind::REAL;
+        if (auto native = this->unboxed(unboxer, kind)) {
+            return std::make_unique<Unboxed>(std::move(native));
+        }
+    }
+
+    unboxer.unbox(this->left);
+    unboxer.unbox(this->right);
+    return nullptr;
+}
+
+std::unique_ptr<Native>
+Arithmetic::unboxed(Unboxer& unboxer, ElementKind kind) const {
+    if (!this->specialized) {
+        return nullptr;
+    }
+
+    bool integers = this->left_kind == ElementKind::INTEGER &&
+                    this->right_kind == ElementKind::INTEGER;
+    if (kind != (integers ? ElementKind::INTEGER : ElementKind::REAL)) {
+        return nullptr;
+    }
+
+    auto left = this->left->unboxed(unboxer, this->left_kind);
+    auto right = this->right->unboxed(unboxer, this->right_kind);
+    if (!left || !right) {
+        return nullptr;
+    }
+    return std::make_unique<NativeArithmetic>(
+        this->span, this->operation, std::move(left), std::move(right)
+    );
+}
+
+void Arithmetic::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->left);
+    converter.convert(this->right);
+}
+
+std::unique_ptr<Expression> Arithmetic::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->left);
+    inliner.inline_calls(this->right);
+    return nullptr;
+}
+
+std::optional<std::string> Arithmetic::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->left);
+    eliminator.eliminate(this->right);
+    return std::nullopt;
+}
+
+} // namespace evaluator
@@ -1,6 +1,8 @@
 #include "../../utils.h"
 #include "../error.h"
 #include "../expression.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
 
 namespace evaluator {
 
@@ -12,7 +14,13 @@ using utils::Depth;
 using utils::to_cons;
 
 Body::Body(std::vector<std::unique_ptr<Expression>> body)
-    : body(std::move(body)) {}
+    : body(std::move(body)) {
+    this->update_captures_scope();
+}
+
+Body::Body(Closure compiled, bool captures_scope)
+    : compiled(std::move(compiled)), captures_scope(captures_scope),
+      ahead_of_time(true) {}
 
 Body Body::parse(std::shared_ptr<List> unparsed) {
     std::vector<std::unique_ptr<Expression>> body;
@@ -25,13 +33,32 @@ Body Body::parse(std::shared_ptr<List> unparsed) {
     return Body(std::move(body));
 }
 
+CommonFrame::CommonFrame(std::vector<std::shared_ptr<CommonValue>> const& values)
+    : values(values) {
+    this->saved.reserve(values.size());
+    for (auto const& value : values) {
+        this->saved.push_back(std::exchange(*value, CommonValue()));
+    }
+}
+
+CommonFrame::~CommonFrame() {
+    for (size_t index = 0; index < this->values.size(); ++index) {
+        *this->values[index] = std::move(this->saved[index]);
+    }
+}
+
 ElementGuard Body::evaluate(EvaluationContext context) const {
+    if (this->ahead_of_time) {
+        return this->compiled(context);
+    }
+
     if (this->body.empty()) {
         return context.garbage_collector->temporary(
             std::make_shared<Null>(Span(Position(0, 0), Position(0, 0)))
         );
     }
 
+    CommonFrame common(this->common);
     for (size_t i = 0; i < this->body.size() - 1; ++i) {
         this->body[i]->evaluate(context);
     }
@@ -39,6 +66,37 @@ ElementGuard Body::evaluate(EvaluationContext context) const {
     return this->body.back()->evaluate(context);
 }
 
+void Body::update_captures_scope() {
+    this->captures_scope = false;
+    for (auto const& expression : this->body) {
+        if (expression->may_capture_scope()) {
+            this->captures_scope = true;
+            return;
+        }
+    }
+}
+
+ScopeGuard Body::create_scope(
+    GarbageCollector* garbage_collector, std::shared_ptr<Scope> parent
+) const {
+    if (this->captures_scope) {
+        return garbage_collector->create_scope(std::move(parent));
+    }
+    return garbage_collector->create_local_scope(std::move(parent));
+}
+
+Body Body::clone() const {
+    if (this->ahead_of_time) {
+        return Body(this->compiled, this->captures_scope);
+    }
+
+    std::vector<std::unique_ptr<Expression>> body;
+    for (auto const& expression : this->body) {
+        body.push_back(expression->clone());
+    }
+    return Body(std::move(body));
+}
+
 void Body::display(std::ostream& stream, size_t depth) const {
     stream << "Body [\n";
 
@@ -63,4 +121,37 @@ void Body::validate_no_break_with_value() const {
     }
 }
 
+bool Body::may_capture_scope() const { return this->captures_scope; }
+
+bool Body::is_pure(PurityAnalysis& analysis) const {
+    // Compiled code can't be analyzed
+    if (this->ahead_of_time) {
+        return false;
+    }
+
+    for (auto const& expression : this->body) {
+        if (!expression->is_pure(analysis)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<Body> Body::partial_copy(PartialEvaluator& evaluator) const {
+    // Compiled code can't be copied
+    if (this->ahead_of_time) {
+        return std::nullopt;
+    }
+
+    std::vector<std::unique_ptr<Expression>> body;
+    for (auto const& expression : this->body) {
+        auto copy = evaluator.copy(*expression);
+        if (!copy) {
+            return std::nullopt;
+        }
+        body.push_back(std::move(copy));
+    }
+    return Body(std::move(body));
+}
+
 } // namespace evaluator
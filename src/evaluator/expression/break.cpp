@@ -1,7 +1,19 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
 #include "../control_flow.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
@@ -53,20 +65,22 @@ void Break::display(std::ostream& stream, size_t depth) const {
     stream << Depth(depth) << '}';
 }
 
-bool Break::returns() const { return this->expression->returns(); }
-bool Break::breaks() const { return !this->returns(); }
-bool Break::can_evaluate_to(ast::ElementKind) const { return false; }
+bool Break::_returns() const { return this->expression->returns(); }
+// Asks the argument, since the analysis of this expression is what is being
+// computed
+bool Break::_breaks() const { return !this->expression->returns(); }
+bool Break::_can_evaluate_to(ast::ElementKind) const { return false; }
 
-bool Break::can_break_with(ast::ElementKind kind) const {
+bool Break::_can_break_with(ast::ElementKind kind) const {
     return this->expression->can_break_with(kind) ||
            this->expression->can_evaluate_to(kind);
 }
 
-void Break::validate_no_free_break() const {
+void Break::_validate_no_free_break() const {
     throw EvaluationError("`break` outside `while` or `prog`", this->span);
 }
 
-void Break::validate_no_break_with_value() const {
+void Break::_validate_no_break_with_value() const {
     // Detect if the value was explicitly specified
     if (this->expression->span.end != this->span.end) {
         throw EvaluationError(
@@ -75,4 +89,75 @@ void Break::validate_no_break_with_value() const {
     }
 }
 
+std::unique_ptr<Expression> Break::clone() const {
+    return std::make_unique<Break>(this->span, this->expression->clone());
+}
+
+std::unique_ptr<Expression>
+Break::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->expression);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Break::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->expression);
+    return nullptr;
+}
+
+ast::Kinds Break::infer_types(TypeInference& inference) {
+    inference.diverge_with_break(inference.infer(this->expression));
+    return ast::Kinds();
+}
+
+bool Break::may_capture_scope() const {
+    return this->expression->may_capture_scope();
+}
+
+bool Break::is_pure(PurityAnalysis& analysis) const {
+    return this->expression->is_pure(analysis);
+}
+
+ast::ElementKind Break::jit(JitCompiler& compiler) const {
+    return compiler.emit_break(*this->expression);
+}
+
+std::string Break::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_break(*this->expression);
+}
+
+bool Break::hoist_invariants(LoopOptimizer& optimizer) {
+    optimizer.hoist(this->expression);
+    return false;
+}
+
+std::unique_ptr<Expression> Break::unbox(Unboxer& unboxer) {
+    unboxer.unbox(this->expression);
+    return nullptr;
+}
+
+void Break::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->expression);
+}
+
+std::unique_ptr<Expression> Break::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->expression);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Break::partial_copy(PartialEvaluator& evaluator) const {
+    auto expression = evaluator.copy(*this->expression);
+    if (!expression) {
+        return nullptr;
+    }
+    return std::make_unique<Break>(this->span, std::move(expression));
+}
+
+std::optional<std::string> Break::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->expression);
+    return std::nullopt;
+}
+
 } // namespace evaluator
@@ -0,0 +1,218 @@
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../dead_code.h"
+#include "../expression.h"
+#include "../function.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../purity.h"
+#include "../type_feedback.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::Element;
+using ast::ElementKind;
+using ast::Span;
+using utils::Depth;
+
+BuiltInCall::BuiltInCall(
+    Span span,
+    std::shared_ptr<Function> function,
+    std::vector<std::unique_ptr<Expression>> arguments
+)
+    : Expression(span), function(std::move(function)),
+      arguments(std::move(arguments)) {
+    if (TypeFeedback::dumping) {
+        this->profile = TypeFeedback::profile(
+            span, "built-in", this->arguments.size()
+        );
+        this->profile->record_callee(*this->function);
+    }
+}
+
+ElementGuard BuiltInCall::evaluate(EvaluationContext context) const {
+    // Guards keep the arguments alive until the call returns
+    auto first = this->arguments[0]->evaluate(context);
+    first.deactivate();
+    if (this->arguments.size() == 1) {
+        std::shared_ptr<Element> arguments[] = {*first};
+        if (this->profile) {
+            this->profile->record(arguments);
+        }
+        CallFrame frame(arguments, this->span, context);
+        return this->function->call(std::move(frame));
+    }
+
+    auto second = this->arguments[1]->evaluate(context);
+    second.deactivate();
+    std::shared_ptr<Element> arguments[] = {*first, *second};
+    if (this->profile) {
+        this->profile->record(arguments);
+    }
+    CallFrame frame(arguments, this->span, context);
+    return this->function->call(std::move(frame));
+}
+
+void BuiltInCall::display(std::ostream& stream, size_t depth) const {
+    stream << "BuiltInCall {\n";
+
+    stream << Depth(depth + 1)
+           << "function = " << this->function->display_pretty() << '\n';
+
+    stream << Depth(depth + 1) << "arguments = [\n";
+    for (auto const& argument : this->arguments) {
+        stream << Depth(depth + 2);
+        argument->display(stream, depth + 2);
+        stream << ",\n";
+    }
+    stream << Depth(depth + 1) << "]\n";
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool BuiltInCall::_returns() const {
+    for (auto const& argument : this->arguments) {
+        if (argument->returns()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BuiltInCall::_breaks() const {
+    for (auto const& argument : this->arguments) {
+        if (argument->breaks()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BuiltInCall::_can_evaluate_to(ElementKind) const { return true; }
+
+bool BuiltInCall::_can_break_with(ElementKind kind) const {
+    for (auto const& argument : this->arguments) {
+        if (argument->can_break_with(kind)) {
+            return true;
+        }
+        if (argument->diverges()) {
+            return false;
+        }
+    }
+    return false;
+}
+
+void BuiltInCall::_validate_no_free_break() const {
+    for (auto const& argument : this->arguments) {
+        argument->validate_no_free_break();
+    }
+}
+
+void BuiltInCall::_validate_no_break_with_value() const {
+    for (auto const& argument : this->arguments) {
+        argument->validate_no_break_with_value();
+    }
+}
+
+std::unique_ptr<Expression> BuiltInCall::clone() const {
+    std::vector<std::unique_ptr<Expression>> arguments;
+    for (auto const& argument : this->arguments) {
+        arguments.push_back(argument->clone());
+    }
+
+    return std::make_unique<BuiltInCall>(
+        this->span, this->function, std::move(arguments)
+    );
+}
+
+std::unique_ptr<Expression>
+BuiltInCall::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    for (auto& argument : this->arguments) {
+        eliminator.eliminate(argument);
+    }
+    return nullptr;
+}
+
+std::unique_ptr<Expression> BuiltInCall::fold_constants(Optimizer& optimizer) {
+    for (auto& argument : this->arguments) {
+        optimizer.fold_constants(argument);
+    }
+    return nullptr;
+}
+
+ast::Kinds BuiltInCall::infer_types(TypeInference& inference) {
+    std::vector<ast::Kinds> argument_kinds;
+    for (auto& argument : this->arguments) {
+        argument_kinds.push_back(inference.infer(argument));
+    }
+    return this->function->result_kinds(argument_kinds);
+}
+
+bool BuiltInCall::may_capture_scope() const {
+    for (auto const& argument : this->arguments) {
+        if (argument->may_capture_scope()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BuiltInCall::is_pure(PurityAnalysis& analysis) const {
+    if (!this->function->is_pure()) {
+        return false;
+    }
+    for (auto const& argument : this->arguments) {
+        if (!argument->is_pure(analysis)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BuiltInCall::hoist_invariants(LoopOptimizer& optimizer) {
+    bool invariant = this->function->is_pure();
+    for (auto& argument : this->arguments) {
+        invariant = optimizer.hoist(argument) && invariant;
+    }
+    return invariant;
+}
+
+std::unique_ptr<Expression> BuiltInCall::unbox(Unboxer& unboxer) {
+    if (!this->function->is_pure()) {
+        unboxer.reject();
+    }
+    for (auto& argument : this->arguments) {
+        unboxer.unbox(argument);
+    }
+    return nullptr;
+}
+
+void BuiltInCall::convert_closures(ClosureConverter& converter) {
+    for (auto& argument : this->arguments) {
+        converter.convert(argument);
+    }
+}
+
+std::unique_ptr<Expression> BuiltInCall::inline_calls(Inliner& inliner) {
+    for (auto& argument : this->arguments) {
+        inliner.inline_calls(argument);
+    }
+    return nullptr;
+}
+
+std::optional<std::string> BuiltInCall::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    for (auto& argument : this->arguments) {
+        eliminator.eliminate(argument);
+    }
+    return std::nullopt;
+}
+
+} // namespace evaluator
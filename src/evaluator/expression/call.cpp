@@ -1,12 +1,26 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
 #include "../function.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_feedback.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
 using ast::Cons;
 using ast::Element;
+using ast::ElementKind;
 using ast::Span;
 using utils::Depth;
 using utils::to_cons;
@@ -17,7 +31,18 @@ Call::Call(
     std::vector<std::unique_ptr<Expression>> arguments
 )
     : Expression(span), function(std::move(function)),
-      arguments(std::move(arguments)) {}
+      arguments(std::move(arguments)) {
+    if (auto symbol = dynamic_cast<Symbol*>(this->function.get())) {
+        this->callee = symbol->variable();
+    }
+    if (TypeFeedback::dumping) {
+        this->profile = TypeFeedback::profile(
+            span,
+            this->callee ? this->callee->value : "call",
+            this->arguments.size()
+        );
+    }
+}
 
 std::unique_ptr<Call> Call::parse(std::shared_ptr<Cons> form) {
     auto function = Expression::parse(form->left);
@@ -41,23 +66,37 @@ std::unique_ptr<Call> Call::parse(std::shared_ptr<Cons> form) {
     );
 }
 
+std::shared_ptr<Function> Call::resolve_callee(
+    EvaluationContext context, std::optional<ElementGuard>& function_guard
+) const {
+    if (this->callee) {
+        return this->cache.lookup(*this->callee, *context.scope);
+    }
+
+    function_guard.emplace(this->function->evaluate(context));
+    return std::dynamic_pointer_cast<Function>(**function_guard);
+}
+
 ElementGuard Call::evaluate(EvaluationContext context) const {
-    auto function_guard = this->function->evaluate(context);
-    auto function = std::dynamic_pointer_cast<Function>(*function_guard);
+    std::optional<ElementGuard> function_guard;
+    auto function = this->resolve_callee(context, function_guard);
     if (!function) {
         throw EvaluationError("Cannot call a non-function", this->span);
     }
 
-    std::vector<ElementGuard> argument_guards;
-    std::vector<std::shared_ptr<Element>> arguments;
-    for (auto& argument : this->arguments) {
-        auto guard = argument->evaluate(context);
+    auto window =
+        context.garbage_collector->allocate_arguments(this->arguments.size());
+    for (size_t index = 0; index < this->arguments.size(); ++index) {
+        auto guard = this->arguments[index]->evaluate(context);
         guard.deactivate();
-        arguments.push_back(*guard);
-        argument_guards.push_back(std::move(guard));
+        window[index] = *guard;
     }
 
-    CallFrame frame(std::move(arguments), this->span, context);
+    if (this->profile) {
+        this->profile->record_callee(*function);
+        this->profile->record(window.arguments());
+    }
+    CallFrame frame(window.arguments(), this->span, context);
     return function->call(std::move(frame));
 }
 
@@ -81,7 +120,7 @@ void Call::display(std::ostream& stream, size_t depth) const {
     stream << Depth(depth) << '}';
 }
 
-bool Call::returns() const {
+bool Call::_returns() const {
     if (this->function->returns()) {
         return true;
     }
@@ -95,7 +134,7 @@ bool Call::returns() const {
     return false;
 }
 
-bool Call::breaks() const {
+bool Call::_breaks() const {
     if (this->function->breaks()) {
         return true;
     }
@@ -109,9 +148,9 @@ bool Call::breaks() const {
     return false;
 }
 
-bool Call::can_evaluate_to(ast::ElementKind) const { return true; }
+bool Call::_can_evaluate_to(ast::ElementKind) const { return true; }
 
-bool Call::can_break_with(ast::ElementKind kind) const {
+bool Call::_can_break_with(ast::ElementKind kind) const {
     if (this->function->can_break_with(kind)) {
         return true;
     }
@@ -131,7 +170,7 @@ bool Call::can_break_with(ast::ElementKind kind) const {
     return false;
 }
 
-void Call::validate_no_free_break() const {
+void Call::_validate_no_free_break() const {
     this->function->validate_no_free_break();
 
     for (auto const& argument : this->arguments) {
@@ -139,7 +178,7 @@ void Call::validate_no_free_break() const {
     }
 }
 
-void Call::validate_no_break_with_value() const {
+void Call::_validate_no_break_with_value() const {
     this->function->validate_no_break_with_value();
 
     for (auto const& argument : this->arguments) {
@@ -147,4 +186,512 @@ void Call::validate_no_break_with_value() const {
     }
 }
 
+std::unique_ptr<Expression> Call::clone() const {
+    std::vector<std::unique_ptr<Expression>> arguments;
+    for (auto const& argument : this->arguments) {
+        arguments.push_back(argument->clone());
+    }
+
+    return std::make_unique<Call>(
+        this->span, this->function->clone(), std::move(arguments)
+    );
+}
+
+bool is_integer(std::shared_ptr<Element> const& element, int64_t value) {
+    auto integer = std::dynamic_pointer_cast<ast::Integer>(element);
+    return integer && integer->value == value;
+}
+
+bool is_boolean(std::shared_ptr<Element> const& element, bool value) {
+    auto boolean = std::dynamic_pointer_cast<ast::Boolean>(element);
+    return boolean && boolean->value == value;
+}
+
+// Simplifies calls like `(times x 1)`, where one argument is a constant that
+// makes the result equal to the other argument. Note that `(plus x 0)` is not
+// an identity for reals, since `(plus -0.0 0)` is `0.0`.
+std::unique_ptr<Expression> simplify_identity(
+    Span span,
+    Function const& function,
+    std::vector<std::unique_ptr<Expression>>& arguments,
+    BuiltInGuard& guard
+) {
+    if (arguments.size() != 2) {
+        return nullptr;
+    }
+
+    for (size_t constant_index = 0; constant_index < 2; ++constant_index) {
+        auto& operand = arguments[1 - constant_index];
+        auto constant = arguments[constant_index]->constant(guard);
+        if (!constant) {
+            continue;
+        }
+
+        bool is_right = constant_index == 1;
+        std::vector<ElementKind> numbers{ElementKind::INTEGER, ElementKind::REAL};
+        std::vector<ElementKind> booleans{ElementKind::BOOLEAN};
+
+        if (dynamic_cast<TimesFunction const*>(&function) &&
+            is_integer(constant, 1)) {
+            return std::make_unique<Identity>(
+                span,
+                std::move(operand),
+                numbers,
+                "`times` expects arguments to be either integers or reals"
+            );
+        }
+        if (dynamic_cast<DivideFunction const*>(&function) && is_right &&
+            is_integer(constant, 1)) {
+            return std::make_unique<Identity>(
+                span,
+                std::move(operand),
+                numbers,
+                "`divide` expects arguments to be either integers or reals"
+            );
+        }
+        if (dynamic_cast<MinusFunction const*>(&function) && is_right &&
+            is_integer(constant, 0)) {
+            return std::make_unique<Identity>(
+                span,
+                std::move(operand),
+                numbers,
+                "`minus` expects arguments to be either integers or reals"
+            );
+        }
+        if (dynamic_cast<AndFunction const*>(&function) &&
+            is_boolean(constant, true)) {
+            return std::make_unique<Identity>(
+                span,
+                std::move(operand),
+                booleans,
+                "`and` expects arguments to be booleans"
+            );
+        }
+        if (dynamic_cast<OrFunction const*>(&function) &&
+            is_boolean(constant, false)) {
+            return std::make_unique<Identity>(
+                span,
+                std::move(operand),
+                booleans,
+                "`or` expects arguments to be booleans"
+            );
+        }
+    }
+
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Call::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->function);
+    for (auto& argument : this->arguments) {
+        eliminator.eliminate(argument);
+    }
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Call::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->function);
+    for (auto& argument : this->arguments) {
+        optimizer.fold_constants(argument);
+    }
+
+    if (!this->callee) {
+        return nullptr;
+    }
+    auto function = optimizer.pure_built_in(*this->callee);
+    if (!function) {
+        return nullptr;
+    }
+
+    BuiltInGuard guard;
+    guard.assume(this->callee, function);
+
+    std::vector<std::shared_ptr<Element>> constants;
+    for (auto const& argument : this->arguments) {
+        if (auto constant = argument->constant(guard)) {
+            constants.push_back(constant);
+        } else {
+            break;
+        }
+    }
+
+    if (constants.size() == this->arguments.size()) {
+        std::shared_ptr<Element> result;
+        try {
+            CallFrame frame(constants, this->span, optimizer.context());
+            result = *function->call(std::move(frame));
+        } catch (EvaluationError const&) {
+            // Let the error happen at runtime, if this code is ever reached
+            return nullptr;
+        }
+
+        return std::make_unique<Guarded>(
+            std::move(guard),
+            std::make_unique<Quote>(this->span, result),
+            this->clone()
+        );
+    }
+
+    auto fallback = this->clone();
+    if (auto simplified =
+            simplify_identity(this->span, *function, this->arguments, guard)) {
+        return std::make_unique<Guarded>(
+            std::move(guard), std::move(simplified), std::move(fallback)
+        );
+    }
+
+    return nullptr;
+}
+
+std::optional<Arithmetic::Operation> arithmetic_operation(Function const& function
+) {
+    if (dynamic_cast<PlusFunction const*>(&function)) {
+        return Arithmetic::Operation::PLUS;
+    }
+    if (dynamic_cast<MinusFunction const*>(&function)) {
+        return Arithmetic::Operation::MINUS;
+    }
+    if (dynamic_cast<TimesFunction const*>(&function)) {
+        return Arithmetic::Operation::TIMES;
+    }
+    if (dynamic_cast<DivideFunction const*>(&function)) {
+        return Arithmetic::Operation::DIVIDE;
+    }
+    return std::nullopt;
+}
+
+std::optional<Comparison::Operation> comparison_operation(Function const& function
+) {
+    if (dynamic_cast<EqualFunction const*>(&function)) {
+        return Comparison::Operation::EQUAL;
+    }
+    if (dynamic_cast<NonequalFunction const*>(&function)) {
+        return Comparison::Operation::NONEQUAL;
+    }
+    if (dynamic_cast<LessFunction const*>(&function)) {
+        return Comparison::Operation::LESS;
+    }
+    if (dynamic_cast<LesseqFunction const*>(&function)) {
+        return Comparison::Operation::LESSEQ;
+    }
+    if (dynamic_cast<GreaterFunction const*>(&function)) {
+        return Comparison::Operation::GREATER;
+    }
+    if (dynamic_cast<GreatereqFunction const*>(&function)) {
+        return Comparison::Operation::GREATEREQ;
+    }
+    return std::nullopt;
+}
+
+// Returns the single kind of values in `kinds` if it is one of `allowed`.
+std::optional<ElementKind>
+single_kind(ast::Kinds kinds, std::vector<ElementKind> const& allowed) {
+    for (auto kind : allowed) {
+        if (kinds.is(kind)) {
+            return kind;
+        }
+    }
+    return std::nullopt;
+}
+
+// Returns whether values of `kinds` may be numbers.
+bool may_be_number(ast::Kinds kinds) {
+    return kinds.contains(ElementKind::INTEGER) ||
+           kinds.contains(ElementKind::REAL);
+}
+
+std::unique_ptr<Expression> Call::specialize(
+    std::shared_ptr<Function> const& function,
+    std::vector<ast::Kinds> const& argument_kinds
+) {
+    if (this->arguments.empty() ||
+        this->arguments.size() > BuiltInCall::MAX_ARGUMENTS) {
+        return nullptr;
+    }
+
+    BuiltInGuard guard;
+    guard.assume(this->callee, function);
+
+    auto operation = arithmetic_operation(*function);
+    if (operation && this->arguments.size() == 2) {
+        std::vector<ElementKind> numbers{ElementKind::INTEGER, ElementKind::REAL};
+        auto left_kind = single_kind(argument_kinds[0], numbers);
+        auto right_kind = single_kind(argument_kinds[1], numbers);
+        if (!left_kind || !right_kind) {
+            if (!TypeFeedback::enabled || !may_be_number(argument_kinds[0]) ||
+                !may_be_number(argument_kinds[1])) {
+                return this->fuse(std::move(guard), function);
+            }
+
+            auto fallback = this->clone();
+            return std::make_unique<Guarded>(
+                std::move(guard),
+                std::make_unique<Arithmetic>(
+                    this->span,
+                    *operation,
+                    function,
+                    TypeFeedback::profile(
+                        this->span, operation_name(*operation), 2
+                    ),
+                    std::move(this->arguments[0]),
+                    std::move(this->arguments[1])
+                ),
+                std::move(fallback)
+            );
+        }
+
+        auto fallback = this->clone();
+        return std::make_unique<Guarded>(
+            std::move(guard),
+            std::make_unique<Arithmetic>(
+                this->span,
+                *operation,
+                function,
+                *left_kind,
+                *right_kind,
+                std::move(this->arguments[0]),
+                std::move(this->arguments[1])
+            ),
+            std::move(fallback)
+        );
+    }
+
+    auto comparison = comparison_operation(*function);
+    if (comparison && this->arguments.size() == 2) {
+        auto kind = single_kind(
+            argument_kinds[0],
+            {ElementKind::INTEGER, ElementKind::REAL, ElementKind::BOOLEAN}
+        );
+        if (!kind || !argument_kinds[1].is(*kind)) {
+            auto common = argument_kinds[0] & argument_kinds[1] &
+                          (ast::Kinds(ElementKind::INTEGER) |
+                           ElementKind::REAL | ElementKind::BOOLEAN);
+            if (!TypeFeedback::enabled || common.empty()) {
+                return this->fuse(std::move(guard), function);
+            }
+
+            auto fallback = this->clone();
+            return std::make_unique<Guarded>(
+                std::move(guard),
+                std::make_unique<Comparison>(
+                    this->span,
+                    *comparison,
+                    function,
+                    TypeFeedback::profile(
+                        this->span, operation_name(*comparison), 2
+                    ),
+                    std::move(this->arguments[0]),
+                    std::move(this->arguments[1])
+                ),
+                std::move(fallback)
+            );
+        }
+
+        auto fallback = this->clone();
+        return std::make_unique<Guarded>(
+            std::move(guard),
+            std::make_unique<Comparison>(
+                this->span,
+                *comparison,
+                function,
+                *kind,
+                std::move(this->arguments[0]),
+                std::move(this->arguments[1])
+            ),
+            std::move(fallback)
+        );
+    }
+
+    return this->fuse(std::move(guard), function);
+}
+
+std::unique_ptr<Expression>
+Call::fuse(BuiltInGuard guard, std::shared_ptr<Function> const& function) {
+    auto fallback = this->clone();
+    return std::make_unique<Guarded>(
+        std::move(guard),
+        std::make_unique<BuiltInCall>(
+            this->span, function, std::move(this->arguments)
+        ),
+        std::move(fallback)
+    );
+}
+
+ast::Kinds Call::infer_types(TypeInference& inference) {
+    if (!this->callee) {
+        inference.infer(this->function);
+    }
+
+    std::vector<ast::Kinds> argument_kinds;
+    for (auto& argument : this->arguments) {
+        argument_kinds.push_back(inference.infer(argument));
+    }
+
+    if (!this->callee) {
+        return ast::Kinds::all();
+    }
+    auto function = inference.get_optimizer().pure_built_in(*this->callee);
+    if (!function) {
+        return ast::Kinds::all();
+    }
+
+    auto kinds = function->result_kinds(argument_kinds);
+    if (!inference.is_rewriting()) {
+        return kinds;
+    }
+
+    if (auto specialized = this->specialize(function, argument_kinds)) {
+        inference.replace_with(std::move(specialized));
+    }
+    return kinds;
+}
+
+bool Call::may_capture_scope() const {
+    // `eval` evaluates code in the scope of its caller. It can still be called
+    // through another variable, but then the inferred kinds are merely wrong
+    // predictions, as specialized expressions check them at runtime.
+    if (this->callee && this->callee->value == "eval") {
+        return true;
+    }
+
+    if (this->function->may_capture_scope()) {
+        return true;
+    }
+    for (auto const& argument : this->arguments) {
+        if (argument->may_capture_scope()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Call::is_pure(PurityAnalysis& analysis) const {
+    // Calling a function from a local variable may call anything
+    if (!this->callee || analysis.is_local(*this->callee) ||
+        !analysis.is_pure_function(*this->callee)) {
+        return false;
+    }
+
+    for (auto const& argument : this->arguments) {
+        if (!argument->is_pure(analysis)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ast::ElementKind Call::jit(JitCompiler& compiler) const {
+    return compiler.emit_call(this->callee, this->arguments);
+}
+
+std::string Call::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_call(
+        this->span, *this->function, this->callee, this->arguments
+    );
+}
+
+bool Call::hoist_invariants(LoopOptimizer& optimizer) {
+    bool invariant = false;
+    if (this->callee) {
+        invariant = optimizer.get_optimizer().pure_built_in(*this->callee) !=
+                    nullptr;
+    } else {
+        optimizer.hoist(this->function);
+    }
+
+    for (auto& argument : this->arguments) {
+        invariant = optimizer.hoist(argument) && invariant;
+    }
+    return invariant;
+}
+
+std::unique_ptr<Expression> Call::unbox(Unboxer& unboxer) {
+    unboxer.reject();
+    if (!this->callee) {
+        unboxer.unbox(this->function);
+    }
+    for (auto& argument : this->arguments) {
+        unboxer.unbox(argument);
+    }
+    return nullptr;
+}
+
+void Call::convert_closures(ClosureConverter& converter) {
+    converter.call(this->callee.get());
+    converter.convert(this->function);
+    for (auto& argument : this->arguments) {
+        converter.convert(argument);
+    }
+}
+
+std::unique_ptr<Expression> Call::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->function);
+    for (auto& argument : this->arguments) {
+        inliner.inline_calls(argument);
+    }
+
+    if (!this->callee) {
+        return nullptr;
+    }
+    return inliner.inline_call(this->span, this->callee, this->arguments);
+}
+
+std::unique_ptr<Expression> Call::inline_copy(Inliner& inliner) const {
+    // Functions computed by expressions may be anything
+    if (!this->callee) {
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<Expression>> arguments;
+    for (auto const& argument : this->arguments) {
+        auto copy = inliner.copy(*argument);
+        if (!copy) {
+            return nullptr;
+        }
+        arguments.push_back(std::move(copy));
+    }
+    return inliner.copy_call(this->span, this->callee, arguments);
+}
+
+std::unique_ptr<Expression>
+Call::partial_copy(PartialEvaluator& evaluator) const {
+    // Code evaluated by `eval` may assign any variable of its caller
+    if (!evaluator.call(this->callee.get())) {
+        return nullptr;
+    }
+
+    auto function = evaluator.copy(*this->function);
+    if (!function) {
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<Expression>> arguments;
+    for (auto const& argument : this->arguments) {
+        auto copy = evaluator.copy(*argument);
+        if (!copy) {
+            return nullptr;
+        }
+        arguments.push_back(std::move(copy));
+    }
+    return std::make_unique<Call>(
+        this->span, std::move(function), std::move(arguments)
+    );
+}
+
+std::optional<std::string> Call::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->function);
+    std::vector<std::optional<std::string>> arguments;
+    for (auto& argument : this->arguments) {
+        arguments.push_back(eliminator.eliminate(argument));
+    }
+
+    if (!this->callee) {
+        return std::nullopt;
+    }
+    return eliminator.call(*this->callee, arguments);
+}
+
 } // namespace evaluator
@@ -0,0 +1,131 @@
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../dead_code.h"
+#include "../expression.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+using utils::Depth;
+
+Common::Common(
+    std::shared_ptr<CommonValue> value, std::unique_ptr<Expression> expression
+)
+    : Expression(expression->span), value(std::move(value)),
+      expression(std::move(expression)) {}
+
+ElementGuard Common::evaluate(EvaluationContext context) const {
+    if (this->value->element && this->value->version == Scope::version) {
+        return context.garbage_collector->temporary(this->value->element);
+    }
+
+    auto element = this->expression->evaluate(context);
+    *this->value = CommonValue{*element, Scope::version};
+    return element;
+}
+
+void Common::display(std::ostream& stream, size_t depth) const {
+    stream << "Common {\n";
+
+    stream << Depth(depth + 1) << "value = " << this->value.get() << '\n';
+
+    stream << Depth(depth + 1) << "expression = ";
+    this->expression->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool Common::_returns() const { return this->expression->returns(); }
+
+bool Common::_breaks() const { return this->expression->breaks(); }
+
+bool Common::_can_evaluate_to(ElementKind kind) const {
+    return this->expression->can_evaluate_to(kind);
+}
+
+bool Common::_can_break_with(ElementKind kind) const {
+    return this->expression->can_break_with(kind);
+}
+
+void Common::_validate_no_free_break() const {
+    this->expression->validate_no_free_break();
+}
+
+void Common::_validate_no_break_with_value() const {
+    this->expression->validate_no_break_with_value();
+}
+
+std::unique_ptr<Expression> Common::clone() const {
+    // The copy doesn't belong to the body that forgets this value
+    return this->expression->clone();
+}
+
+std::unique_ptr<Expression>
+Common::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->expression);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Common::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->expression);
+    return nullptr;
+}
+
+ast::Kinds Common::infer_types(TypeInference& inference) {
+    return inference.infer(this->expression);
+}
+
+bool Common::may_capture_scope() const {
+    return this->expression->may_capture_scope();
+}
+
+bool Common::is_pure(PurityAnalysis& analysis) const {
+    return this->expression->is_pure(analysis);
+}
+
+bool Common::hoist_invariants(LoopOptimizer& optimizer) {
+    return optimizer.hoist(this->expression);
+}
+
+std::unique_ptr<Expression> Common::unbox(Unboxer& unboxer) {
+    // Unboxed loops evaluate their bodies statement by statement, so nothing
+    // would forget the value between iterations
+    unboxer.reject();
+    unboxer.unbox(this->expression);
+    return nullptr;
+}
+
+void Common::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->expression);
+}
+
+std::unique_ptr<Expression> Common::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->expression);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Common::partial_copy(PartialEvaluator& evaluator) const {
+    return evaluator.copy(*this->expression);
+}
+
+std::optional<std::string> Common::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    // Already shared
+    eliminator.eliminate(this->expression);
+    return std::nullopt;
+}
+
+} // namespace evaluator
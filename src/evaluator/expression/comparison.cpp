@@ -0,0 +1,333 @@
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../dead_code.h"
+#include "../expression.h"
+#include "../function.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../purity.h"
+#include "../type_feedback.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+using ast::Span;
+using utils::Depth;
+
+Comparison::Comparison(
+    Span span,
+    Operation operation,
+    std::shared_ptr<Function> function,
+    ElementKind kind,
+    std::unique_ptr<Expression> left,
+    std::unique_ptr<Expression> right
+)
+    : Expression(span), operation(operation), function(std::move(function)),
+      kind(kind), left(std::move(left)), right(std::move(right)),
+      true_value(std::make_shared<ast::Boolean>(true, this->function->span)),
+      false_value(std::make_shared<ast::Boolean>(false, this->function->span)
+      ),
+      specialized(true) {}
+
+Comparison::Comparison(
+    Span span,
+    Operation operation,
+    std::shared_ptr<Function> function,
+    std::shared_ptr<TypeProfile> profile,
+    std::unique_ptr<Expression> left,
+    std::unique_ptr<Expression> right
+)
+    : Comparison(
+          span,
+          operation,
+          std::move(function),
+          ElementKind::BOOLEAN,
+          std::move(left),
+          std::move(right)
+      ) {
+    this->profile = std::move(profile);
+    this->specialized = false;
+}
+
+template <typename T>
+bool compare(Comparison::Operation operation, T a, T b) {
+    switch (operation) {
+    case Comparison::Operation::EQUAL:
+        return a == b;
+    case Comparison::Operation::NONEQUAL:
+        return a != b;
+    case Comparison::Operation::LESS:
+        return a < b;
+    case Comparison::Operation::LESSEQ:
+        return a <= b;
+    case Comparison::Operation::GREATER:
+        return a > b;
+    case Comparison::Operation::GREATEREQ:
+        return a >= b;
+    }
+    return false;
+}
+
+ElementGuard Comparison::evaluate(EvaluationContext context) const {
+    auto left = this->left->evaluate(context);
+    left.deactivate();
+    auto right = this->right->evaluate(context);
+    right.deactivate();
+    return this->apply(context, left, right);
+}
+
+ElementGuard Comparison::apply(
+    EvaluationContext context, ElementGuard& left, ElementGuard& right
+) const {
+    if (this->profile) {
+        this->observe(left.get()->kind, right.get()->kind);
+    }
+    if (!this->specialized || left.get()->kind != this->kind ||
+        right.get()->kind != this->kind) {
+        std::shared_ptr<ast::Element> arguments[] = {*left, *right};
+        CallFrame frame(arguments, this->span, context);
+        return this->function->call(std::move(frame));
+    }
+
+    bool result;
+    switch (this->kind) {
+    case ElementKind::INTEGER:
+        result = compare(
+            this->operation,
+            static_cast<ast::Integer const*>(left.get())->value,
+            static_cast<ast::Integer const*>(right.get())->value
+        );
+        break;
+    case ElementKind::REAL:
+        result = compare(
+            this->operation,
+            static_cast<ast::Real const*>(left.get())->value,
+            static_cast<ast::Real const*>(right.get())->value
+        );
+        break;
+    default:
+        result = compare(
+            this->operation,
+            static_cast<ast::Boolean const*>(left.get())->value,
+            static_cast<ast::Boolean const*>(right.get())->value
+        );
+        break;
+    }
+
+    // Built-in comparisons return booleans spanning their definition
+    return context.garbage_collector->temporary(
+        result ? this->true_value : this->false_value
+    );
+}
+
+void Comparison::observe(ElementKind left, ElementKind right) const {
+    this->profile->record(0, left);
+    this->profile->record(1, right);
+    if (!this->profile->evaluated()) {
+        return;
+    }
+
+    static constexpr ElementKind KINDS[] = {
+        ElementKind::INTEGER, ElementKind::REAL, ElementKind::BOOLEAN
+    };
+    auto kind = this->profile->single_kind(0, KINDS);
+    if (kind && kind == this->profile->single_kind(1, KINDS)) {
+        this->kind = *kind;
+        this->specialized = true;
+        this->profile->specialize({*kind, *kind});
+    }
+
+    // A call that saw mixed kinds keeps calling the built-in
+    if (!TypeFeedback::dumping) {
+        this->profile = nullptr;
+    }
+}
+
+char const* operation_name(Comparison::Operation operation) {
+    switch (operation) {
+    case Comparison::Operation::EQUAL:
+        return "equal";
+    case Comparison::Operation::NONEQUAL:
+        return "nonequal";
+    case Comparison::Operation::LESS:
+        return "less";
+    case Comparison::Operation::LESSEQ:
+        return "lesseq";
+    case Comparison::Operation::GREATER:
+        return "greater";
+    case Comparison::Operation::GREATEREQ:
+        return "greatereq";
+    }
+    return "";
+}
+
+void Comparison::display(std::ostream& stream, size_t depth) const {
+    stream << "Comparison {\n";
+
+    stream << Depth(depth + 1)
+           << "operation = " << operation_name(this->operation) << '\n';
+
+    if (this->specialized) {
+        stream << Depth(depth + 1) << "kind = " << this->kind << '\n';
+    }
+
+    stream << Depth(depth + 1) << "left = ";
+    this->left->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "right = ";
+    this->right->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool Comparison::_returns() const {
+    return this->left->returns() || this->right->returns();
+}
+
+bool Comparison::_breaks() const {
+    return this->left->breaks() || this->right->breaks();
+}
+
+bool Comparison::_can_evaluate_to(ElementKind kind) const {
+    return kind == ElementKind::BOOLEAN;
+}
+
+bool Comparison::_can_break_with(ElementKind kind) const {
+    if (this->left->can_break_with(kind)) {
+        return true;
+    }
+    if (this->left->diverges()) {
+        return false;
+    }
+    return this->right->can_break_with(kind);
+}
+
+void Comparison::_validate_no_free_break() const {
+    this->left->validate_no_free_break();
+    this->right->validate_no_free_break();
+}
+
+void Comparison::_validate_no_break_with_value() const {
+    this->left->validate_no_break_with_value();
+    this->right->validate_no_break_with_value();
+}
+
+std::unique_ptr<Expression> Comparison::clone() const {
+    if (!this->specialized) {
+        return std::make_unique<Comparison>(
+            this->span,
+            this->operation,
+            this->function,
+            TypeFeedback::profile(
+                this->span, operation_name(this->operation), 2
+            ),
+            this->left->clone(),
+            this->right->clone()
+        );
+    }
+
+    return std::make_unique<Comparison>(
+        this->span,
+        this->operation,
+        this->function,
+        this->kind,
+        this->left->clone(),
+        this->right->clone()
+    );
+}
+
+std::unique_ptr<Expression>
+Comparison::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->left);
+    eliminator.eliminate(this->right);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Comparison::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->left);
+    optimizer.fold_constants(this->right);
+    return nullptr;
+}
+
+ast::Kinds Comparison::infer_types(TypeInference& inference) {
+    auto left = inference.infer(this->left);
+    auto right = inference.infer(this->right);
+    return this->function->result_kinds({left, right});
+}
+
+bool Comparison::may_capture_scope() const {
+    return this->left->may_capture_scope() || this->right->may_capture_scope();
+}
+
+bool Comparison::is_pure(PurityAnalysis& analysis) const {
+    return this->left->is_pure(analysis) && this->right->is_pure(analysis);
+}
+
+bool Comparison::hoist_invariants(LoopOptimizer& optimizer) {
+    bool left = optimizer.hoist(this->left);
+    bool right = optimizer.hoist(this->right);
+    return left && right;
+}
+
+std::unique_ptr<Expression> Comparison::unbox(Unboxer& unboxer) {
+    if (this->specialized && this->kind != ElementKind::BOOLEAN) {
+        unboxer.use(*this->left, this->kind);
+        unboxer.use(*this->right, this->kind);
+
+        if (unboxer.get_mode() == Unboxer::Mode::REWRITING) {
+            if (auto native = this->unboxed(unboxer, ElementKind::BOOLEAN)) {
+                return std::make_unique<Unboxed>(std::move(native));
+            }
+        }
+    }
+
+    unboxer.unbox(this->left);
+    unboxer.unbox(this->right);
+    return nullptr;
+}
+
+std::unique_ptr<Native>
+Comparison::unboxed(Unboxer& unboxer, ElementKind kind) const {
+    if (kind != ElementKind::BOOLEAN || !this->specialized ||
+        this->kind == ElementKind::BOOLEAN) {
+        return nullptr;
+    }
+
+    auto left = this->left->unboxed(unboxer, this->kind);
+    auto right = this->right->unboxed(unboxer, this->kind);
+    if (!left || !right) {
+        return nullptr;
+    }
+    return std::make_unique<NativeComparison>(
+        this->span, this->operation, std::move(left), std::move(right)
+    );
+}
+
+void Comparison::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->left);
+    converter.convert(this->right);
+}
+
+std::unique_ptr<Expression> Comparison::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->left);
+    inliner.inline_calls(this->right);
+    return nullptr;
+}
+
+std::optional<std::string> Comparison::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->left);
+    eliminator.eliminate(this->right);
+    return std::nullopt;
+}
+
+} // namespace evaluator
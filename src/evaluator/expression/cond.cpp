@@ -1,6 +1,18 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
@@ -101,17 +113,17 @@ void Cond::display(std::ostream& stream, size_t depth) const {
     stream << Depth(depth) << '}';
 }
 
-bool Cond::returns() const {
+bool Cond::_returns() const {
     return this->condition->returns() ||
            (this->then->returns() && this->otherwise->returns());
 }
 
-bool Cond::breaks() const {
+bool Cond::_breaks() const {
     return this->condition->breaks() ||
            (this->then->breaks() && this->otherwise->breaks());
 }
 
-bool Cond::can_evaluate_to(ast::ElementKind kind) const {
+bool Cond::_can_evaluate_to(ast::ElementKind kind) const {
     if (this->condition->diverges()) {
         return false;
     }
@@ -120,7 +132,7 @@ bool Cond::can_evaluate_to(ast::ElementKind kind) const {
            this->otherwise->can_evaluate_to(kind);
 }
 
-bool Cond::can_break_with(ast::ElementKind kind) const {
+bool Cond::_can_break_with(ast::ElementKind kind) const {
     if (this->condition->can_break_with(kind)) {
         return true;
     }
@@ -132,16 +144,167 @@ bool Cond::can_break_with(ast::ElementKind kind) const {
            this->otherwise->can_break_with(kind);
 }
 
-void Cond::validate_no_free_break() const {
+void Cond::_validate_no_free_break() const {
     this->condition->validate_no_free_break();
     this->then->validate_no_free_break();
     this->otherwise->validate_no_free_break();
 }
 
-void Cond::validate_no_break_with_value() const {
+void Cond::_validate_no_break_with_value() const {
     this->condition->validate_no_break_with_value();
     this->then->validate_no_break_with_value();
     this->otherwise->validate_no_break_with_value();
 }
 
+std::unique_ptr<Expression> Cond::clone() const {
+    return std::make_unique<Cond>(
+        this->span,
+        this->condition->clone(),
+        this->then->clone(),
+        this->otherwise->clone()
+    );
+}
+
+std::unique_ptr<Expression>
+Cond::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->condition);
+    eliminator.eliminate(this->then);
+    eliminator.eliminate(this->otherwise);
+
+    // Conditions relying on built-ins are left for constant folding to guard
+    BuiltInGuard guard;
+    auto condition =
+        std::dynamic_pointer_cast<ast::Boolean>(this->condition->constant(guard));
+    if (!condition || !guard.empty()) {
+        return nullptr;
+    }
+
+    // The condition and the branch it never picks
+    eliminator.remove(2);
+    return std::move(condition->value ? this->then : this->otherwise);
+}
+
+std::unique_ptr<Expression> Cond::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->condition);
+    optimizer.fold_constants(this->then);
+    optimizer.fold_constants(this->otherwise);
+
+    BuiltInGuard guard;
+    auto condition =
+        std::dynamic_pointer_cast<ast::Boolean>(this->condition->constant(guard));
+    if (!condition) {
+        return nullptr;
+    }
+
+    std::unique_ptr<Expression> fallback;
+    if (!guard.empty()) {
+        fallback = this->clone();
+    }
+
+    auto branch =
+        std::move(condition->value ? this->then : this->otherwise);
+    if (!fallback) {
+        return branch;
+    }
+    return std::make_unique<Guarded>(
+        std::move(guard), std::move(branch), std::move(fallback)
+    );
+}
+
+ast::Kinds Cond::infer_types(TypeInference& inference) {
+    inference.infer(this->condition);
+
+    auto before = inference.save();
+    auto then = inference.infer(this->then);
+    auto after_then = inference.save();
+
+    inference.restore(std::move(before));
+    auto otherwise = inference.infer(this->otherwise);
+    inference.join(after_then);
+
+    return then | otherwise;
+}
+
+bool Cond::may_capture_scope() const {
+    return this->condition->may_capture_scope() ||
+           this->then->may_capture_scope() ||
+           this->otherwise->may_capture_scope();
+}
+
+bool Cond::is_pure(PurityAnalysis& analysis) const {
+    return this->condition->is_pure(analysis) &&
+           this->then->is_pure(analysis) && this->otherwise->is_pure(analysis);
+}
+
+ast::ElementKind Cond::jit(JitCompiler& compiler) const {
+    return compiler.emit_cond(*this->condition, *this->then, *this->otherwise);
+}
+
+std::string Cond::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_cond(*this->condition, *this->then, *this->otherwise);
+}
+
+bool Cond::hoist_invariants(LoopOptimizer& optimizer) {
+    bool condition = optimizer.hoist(this->condition);
+    bool then = optimizer.hoist(this->then);
+    bool otherwise = optimizer.hoist(this->otherwise);
+    return condition && then && otherwise;
+}
+
+std::unique_ptr<Expression> Cond::unbox(Unboxer& unboxer) {
+    unboxer.unbox(this->condition);
+    unboxer.unbox(this->then);
+    unboxer.unbox(this->otherwise);
+    return nullptr;
+}
+
+void Cond::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->condition);
+    converter.convert(this->then);
+    converter.convert(this->otherwise);
+}
+
+std::unique_ptr<Expression> Cond::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->condition);
+    inliner.inline_calls(this->then);
+    inliner.inline_calls(this->otherwise);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Cond::inline_copy(Inliner& inliner) const {
+    auto condition = inliner.copy(*this->condition);
+    auto then = condition ? inliner.copy(*this->then) : nullptr;
+    auto otherwise = then ? inliner.copy(*this->otherwise) : nullptr;
+    if (!otherwise) {
+        return nullptr;
+    }
+
+    return std::make_unique<Cond>(
+        this->span, std::move(condition), std::move(then), std::move(otherwise)
+    );
+}
+
+std::unique_ptr<Expression>
+Cond::partial_copy(PartialEvaluator& evaluator) const {
+    auto condition = evaluator.copy(*this->condition);
+    auto then = condition ? evaluator.copy(*this->then) : nullptr;
+    auto otherwise = then ? evaluator.copy(*this->otherwise) : nullptr;
+    if (!otherwise) {
+        return nullptr;
+    }
+
+    return std::make_unique<Cond>(
+        this->span, std::move(condition), std::move(then), std::move(otherwise)
+    );
+}
+
+std::optional<std::string> Cond::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->condition);
+    eliminator.eliminate(this->then);
+    eliminator.eliminate(this->otherwise);
+    return std::nullopt;
+}
+
 } // namespace evaluator
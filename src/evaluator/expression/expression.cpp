@@ -1,14 +1,18 @@
 #include "../expression.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../macros.h"
+#include "../partial_evaluation.h"
+#include <stdexcept>
 
 namespace evaluator {
 
 using ast::Cons;
 using ast::Element;
+using ast::ElementKind;
 using ast::Span;
 
-EvaluationContext::EvaluationContext(
-    GarbageCollector* gc, std::shared_ptr<Scope> scope
-)
+EvaluationContext::EvaluationContext(GarbageCollector* gc, Scope* scope)
     : garbage_collector(gc), scope(scope) {}
 
 Expression::Expression(Span span) : span(span) {}
@@ -56,6 +60,21 @@ std::unique_ptr<Expression> Expression::parse(std::shared_ptr<Element> element
             if (name == "cond") {
                 return Cond::parse(cons->span, arguments);
             }
+
+            if (name == "switch") {
+                return Switch::parse(cons->span, arguments);
+            }
+
+            if (name == "macro") {
+                Macros::define(cons->span, arguments);
+                return std::make_unique<Quote>(
+                    cons->span, std::make_shared<ast::Null>(cons->span)
+                );
+            }
+
+            if (Macros::is_defined(symbol->value)) {
+                return Macros::expand(cons);
+            }
         }
 
         return Call::parse(cons);
@@ -68,6 +87,135 @@ std::unique_ptr<Expression> Expression::parse(std::shared_ptr<Element> element
     return std::make_unique<Quote>(element->span, element);
 }
 
-bool Expression::diverges() const { return this->returns() || this->breaks(); }
+Expression::Analysis const& Expression::analyze() const {
+    if (!this->analysis) {
+        Analysis analysis{this->_returns(), this->_breaks(), {}, {}};
+        for (auto kind :
+             {ElementKind::INTEGER,
+              ElementKind::REAL,
+              ElementKind::BOOLEAN,
+              ElementKind::SYMBOL,
+              ElementKind::NULL_,
+              ElementKind::CONS,
+              ElementKind::FUNCTION}) {
+            if (this->_can_evaluate_to(kind)) {
+                analysis.values = analysis.values | kind;
+            }
+            if (this->_can_break_with(kind)) {
+                analysis.break_values = analysis.break_values | kind;
+            }
+        }
+        this->analysis = analysis;
+    }
+    return *this->analysis;
+}
+
+bool Expression::returns() const { return this->analyze().returns; }
+bool Expression::breaks() const { return this->analyze().breaks; }
+
+bool Expression::diverges() const {
+    auto const& analysis = this->analyze();
+    return analysis.returns || analysis.breaks;
+}
+
+bool Expression::can_evaluate_to(ElementKind kind) const {
+    return this->analyze().values.contains(kind);
+}
+
+bool Expression::can_break_with(ElementKind kind) const {
+    return this->analyze().break_values.contains(kind);
+}
+
+// Validation throws on failure, so only success is remembered
+void Expression::validate_no_free_break() const {
+    if (!this->no_free_break) {
+        this->_validate_no_free_break();
+        this->no_free_break = true;
+    }
+}
+
+void Expression::validate_no_break_with_value() const {
+    if (!this->no_break_with_value) {
+        this->_validate_no_break_with_value();
+        this->no_break_with_value = true;
+    }
+}
+
+std::shared_ptr<Element> Expression::constant(BuiltInGuard&) const {
+    return nullptr;
+}
+
+ast::ElementKind Expression::jit(JitCompiler& compiler) const {
+    compiler.reject();
+}
+
+std::string Expression::emit_cpp(CppEmitter&) const {
+    throw std::logic_error(
+        "Only expressions of parsed programs can be emitted as C++. This is a "
+        "bug."
+    );
+}
+
+std::unique_ptr<Native> Expression::unboxed(Unboxer&, ast::ElementKind) const {
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Expression::inline_copy(Inliner&) const {
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Expression::partial_copy(PartialEvaluator&) const {
+    return nullptr;
+}
+
+// Returns an element of `pool` nothing else refers to, set to `value`.
+template <typename Number, size_t size>
+std::shared_ptr<ast::Element> recycle(
+    std::shared_ptr<Number> (&pool)[size],
+    decltype(Number::value) value,
+    Span span
+) {
+    std::shared_ptr<Number>* empty = nullptr;
+    for (auto& element : pool) {
+        if (!element) {
+            empty = &element;
+        } else if (element.use_count() == 1) {
+            element->value = value;
+            return element;
+        }
+    }
+
+    auto element = std::make_shared<Number>(value, span);
+    if (empty) {
+        *empty = element;
+    }
+    return element;
+}
+
+std::shared_ptr<Element> NumberBoxes::integer(int64_t value, Span span) {
+    return recycle(this->integers, value, span);
+}
+
+std::shared_ptr<Element> NumberBoxes::real(double value, Span span) {
+    return recycle(this->reals, value, span);
+}
+
+void Captures::display(std::ostream& stream) const {
+    stream << '[';
+    for (size_t index = 0; index < this->variables.size(); ++index) {
+        if (index > 0) {
+            stream << ", ";
+        }
+        stream << this->variables[index]->value;
+    }
+    stream << ']';
+}
+
+std::shared_ptr<Scope> Captures::copy(Scope& scope) const {
+    if (!this->converted) {
+        return nullptr;
+    }
+    return scope.copy(this->variables);
+}
 
 } // namespace evaluator
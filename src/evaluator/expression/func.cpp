@@ -1,7 +1,21 @@
 #include "../../utils.h"
+#include "../background_optimizer.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
 #include "../function.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../macros.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
@@ -51,27 +65,43 @@ std::unique_ptr<Func> Func::parse(Span span, std::shared_ptr<List> arguments) {
         );
     }
     auto parameters = Parameters::parse(parameter_list);
+    Macros::Shadow shadow(parameters);
 
     auto body = Body::parse(cons->right);
     body.validate_no_free_break();
 
-    return std::make_unique<Func>(
+    auto func = std::make_unique<Func>(
         span,
         name,
         std::move(parameters),
         std::make_shared<Body>(std::move(body))
     );
+    if (BackgroundOptimizer::enabled || Jit::enabled) {
+        func->source = std::make_shared<Func>(
+            span,
+            name,
+            func->parameters,
+            std::make_shared<Body>(func->body->clone())
+        );
+    }
+    return func;
 }
 
 ElementGuard Func::evaluate(EvaluationContext context) const {
+    auto captured = this->captures.copy(*context.scope);
     auto function = std::make_shared<FuncFunction>(
         this->span,
         this->name->value,
         this->parameters,
         this->body,
-        context.scope
+        captured ? captured : context.scope->capture(),
+        captured
     );
 
+    if (this->source && !captured && context.scope->is_global()) {
+        function->optimize_when_hot(this->source);
+    }
+
     context.scope->define(*this->name, function);
 
     return context.garbage_collector->temporary(function);
@@ -91,18 +121,119 @@ void Func::display(std::ostream& stream, size_t depth) const {
     this->body->display(stream, depth + 1);
     stream << '\n';
 
+    if (this->captures.converted) {
+        stream << Depth(depth + 1) << "captures = ";
+        this->captures.display(stream);
+        stream << '\n';
+    }
+
     stream << Depth(depth + 1) << "span = " << this->span << '\n';
 
     stream << Depth(depth) << '}';
 }
 
-bool Func::returns() const { return false; }
-bool Func::breaks() const { return false; }
-bool Func::can_evaluate_to(ast::ElementKind kind) const {
+bool Func::_returns() const { return false; }
+bool Func::_breaks() const { return false; }
+bool Func::_can_evaluate_to(ast::ElementKind kind) const {
     return kind == ast::ElementKind::FUNCTION;
 }
-bool Func::can_break_with(ast::ElementKind) const { return false; }
-void Func::validate_no_free_break() const {}
-void Func::validate_no_break_with_value() const {}
+bool Func::_can_break_with(ast::ElementKind) const { return false; }
+void Func::_validate_no_free_break() const {}
+void Func::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> Func::clone() const {
+    auto clone = std::make_unique<Func>(
+        this->span,
+        this->name,
+        this->parameters,
+        std::make_shared<Body>(this->body->clone())
+    );
+    clone->captures = this->captures;
+    clone->source = this->source;
+    return clone;
+}
+
+std::unique_ptr<Expression>
+Func::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(*this->body);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Func::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(*this->body);
+    return nullptr;
+}
+
+ast::Kinds Func::infer_types(TypeInference& inference) {
+    inference.infer_function(this->parameters, *this->body);
+    return ast::ElementKind::FUNCTION;
+}
+
+bool Func::may_capture_scope() const {
+    // Even a converted closure defines a variable in the scope, which other
+    // passes don't track
+    return true;
+}
+
+// Defines a variable and creates a closure
+bool Func::is_pure(PurityAnalysis&) const { return false; }
+
+std::string Func::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_func(
+        this->span, *this->name, this->parameters, *this->body
+    );
+}
+
+bool Func::hoist_invariants(LoopOptimizer& optimizer) {
+    // The body is analyzed once, when the loops around the function are
+    // rewritten
+    if (optimizer.is_rewriting()) {
+        optimizer.hoist_function(this->parameters, *this->body);
+    }
+    return false;
+}
+
+std::unique_ptr<Expression> Func::unbox(Unboxer& unboxer) {
+    unboxer.reject();
+    if (unboxer.get_mode() == Unboxer::Mode::SEARCHING) {
+        unboxer.unbox_function(this->parameters, *this->body);
+    }
+    return nullptr;
+}
+
+void Func::convert_closures(ClosureConverter& converter) {
+    converter.define(this->name);
+    converter.convert_closure(this->captures, this->parameters, *this->body);
+}
+
+std::unique_ptr<Expression> Func::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(*this->body);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Func::partial_copy(PartialEvaluator& evaluator) const {
+    if (!evaluator.assign(*this->name)) {
+        return nullptr;
+    }
+
+    auto body = evaluator.copy_scope(this->parameters, *this->body);
+    if (!body) {
+        return nullptr;
+    }
+    return std::make_unique<Func>(
+        this->span,
+        this->name,
+        this->parameters,
+        std::make_shared<Body>(std::move(*body))
+    );
+}
+
+std::optional<std::string> Func::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate_function(this->parameters, *this->body);
+    return std::nullopt;
+}
 
 } // namespace evaluator
@@ -0,0 +1,184 @@
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../dead_code.h"
+#include "../expression.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::Element;
+using utils::Depth;
+
+Guarded::Guarded(
+    BuiltInGuard guard,
+    std::unique_ptr<Expression> optimized,
+    std::unique_ptr<Expression> fallback
+)
+    : Expression(fallback->span), guard(std::move(guard)),
+      optimized(std::move(optimized)), fallback(std::move(fallback)) {}
+
+ElementGuard Guarded::evaluate(EvaluationContext context) const {
+    if (this->guard.check(*context.scope)) {
+        return this->optimized->evaluate(context);
+    }
+    return this->fallback->evaluate(context);
+}
+
+void Guarded::display(std::ostream& stream, size_t depth) const {
+    stream << "Guarded {\n";
+
+    stream << Depth(depth + 1) << "assumes = ";
+    this->guard.display(stream);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "optimized = ";
+    this->optimized->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "fallback = ";
+    this->fallback->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool Guarded::_returns() const {
+    return this->optimized->returns() && this->fallback->returns();
+}
+
+bool Guarded::_breaks() const {
+    return this->optimized->breaks() && this->fallback->breaks();
+}
+
+bool Guarded::_can_evaluate_to(ast::ElementKind kind) const {
+    return this->optimized->can_evaluate_to(kind) ||
+           this->fallback->can_evaluate_to(kind);
+}
+
+bool Guarded::_can_break_with(ast::ElementKind kind) const {
+    return this->optimized->can_break_with(kind) ||
+           this->fallback->can_break_with(kind);
+}
+
+void Guarded::_validate_no_free_break() const {
+    this->optimized->validate_no_free_break();
+    this->fallback->validate_no_free_break();
+}
+
+void Guarded::_validate_no_break_with_value() const {
+    this->optimized->validate_no_break_with_value();
+    this->fallback->validate_no_break_with_value();
+}
+
+std::unique_ptr<Expression> Guarded::clone() const {
+    return std::make_unique<Guarded>(
+        this->guard, this->optimized->clone(), this->fallback->clone()
+    );
+}
+
+std::unique_ptr<Expression>
+Guarded::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->optimized);
+    eliminator.eliminate(this->fallback);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Guarded::fold_constants(Optimizer&) {
+    // Both versions were folded before the guard was created
+    return nullptr;
+}
+
+std::shared_ptr<Element> Guarded::constant(BuiltInGuard& guard) const {
+    auto constant = this->optimized->constant(guard);
+    if (constant) {
+        guard.merge(this->guard);
+    }
+    return constant;
+}
+
+ast::Kinds Guarded::infer_types(TypeInference& inference) {
+    auto before = inference.save();
+    auto optimized = inference.infer(this->optimized);
+    auto after_optimized = inference.save();
+
+    inference.restore(std::move(before));
+    auto fallback = inference.infer(this->fallback);
+    inference.join(after_optimized);
+
+    return optimized | fallback;
+}
+
+bool Guarded::may_capture_scope() const {
+    return this->optimized->may_capture_scope() ||
+           this->fallback->may_capture_scope();
+}
+
+bool Guarded::is_pure(PurityAnalysis& analysis) const {
+    return this->optimized->is_pure(analysis) &&
+           this->fallback->is_pure(analysis);
+}
+
+bool Guarded::hoist_invariants(LoopOptimizer& optimizer) {
+    bool optimized = optimizer.hoist(this->optimized);
+    bool fallback = optimizer.hoist(this->fallback);
+    return optimized && fallback;
+}
+
+std::unique_ptr<Expression> Guarded::unbox(Unboxer& unboxer) {
+    switch (unboxer.get_mode()) {
+    case Unboxer::Mode::SEARCHING:
+        unboxer.unbox(this->optimized);
+        unboxer.unbox(this->fallback);
+        return nullptr;
+    case Unboxer::Mode::ANALYZING:
+        // The loop checks the guard on entry, and nothing in it can rebind
+        // built-ins, so the fallback is never evaluated
+        unboxer.assume(this->guard);
+        unboxer.unbox(this->optimized);
+        return nullptr;
+    case Unboxer::Mode::REWRITING:
+        unboxer.unbox(this->optimized);
+        return std::move(this->optimized);
+    }
+    return nullptr;
+}
+
+std::unique_ptr<Native>
+Guarded::unboxed(Unboxer& unboxer, ast::ElementKind kind) const {
+    return this->optimized->unboxed(unboxer, kind);
+}
+
+void Guarded::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->optimized);
+    converter.convert(this->fallback);
+}
+
+std::unique_ptr<Expression> Guarded::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->optimized);
+    inliner.inline_calls(this->fallback);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Guarded::partial_copy(PartialEvaluator& evaluator) const {
+    return evaluator.copy(*this->fallback);
+}
+
+std::optional<std::string> Guarded::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->optimized);
+    eliminator.eliminate(this->fallback);
+    return std::nullopt;
+}
+
+} // namespace evaluator
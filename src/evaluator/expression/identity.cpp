@@ -0,0 +1,138 @@
+#include <algorithm>
+
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../dead_code.h"
+#include "../error.h"
+#include "../expression.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+using ast::Span;
+using utils::Depth;
+
+Identity::Identity(
+    Span span,
+    std::unique_ptr<Expression> operand,
+    std::vector<ElementKind> accepted_kinds,
+    std::string error
+)
+    : Expression(span), operand(std::move(operand)),
+      accepted_kinds(std::move(accepted_kinds)), error(std::move(error)) {}
+
+ElementGuard Identity::evaluate(EvaluationContext context) const {
+    auto element = this->operand->evaluate(context);
+
+    auto kind = element->kind;
+    if (std::find(
+            this->accepted_kinds.begin(), this->accepted_kinds.end(), kind
+        ) == this->accepted_kinds.end()) {
+        throw EvaluationError(this->error, this->span);
+    }
+
+    return element;
+}
+
+void Identity::display(std::ostream& stream, size_t depth) const {
+    stream << "Identity {\n";
+
+    stream << Depth(depth + 1) << "operand = ";
+    this->operand->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool Identity::_returns() const { return this->operand->returns(); }
+bool Identity::_breaks() const { return this->operand->breaks(); }
+
+bool Identity::_can_evaluate_to(ElementKind kind) const {
+    return std::find(
+               this->accepted_kinds.begin(), this->accepted_kinds.end(), kind
+           ) != this->accepted_kinds.end() &&
+           this->operand->can_evaluate_to(kind);
+}
+
+bool Identity::_can_break_with(ElementKind kind) const {
+    return this->operand->can_break_with(kind);
+}
+
+void Identity::_validate_no_free_break() const {
+    this->operand->validate_no_free_break();
+}
+
+void Identity::_validate_no_break_with_value() const {
+    this->operand->validate_no_break_with_value();
+}
+
+std::unique_ptr<Expression> Identity::clone() const {
+    return std::make_unique<Identity>(
+        this->span, this->operand->clone(), this->accepted_kinds, this->error
+    );
+}
+
+std::unique_ptr<Expression>
+Identity::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->operand);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Identity::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->operand);
+    return nullptr;
+}
+
+ast::Kinds Identity::infer_types(TypeInference& inference) {
+    auto kinds = inference.infer(this->operand);
+
+    ast::Kinds accepted;
+    for (auto kind : this->accepted_kinds) {
+        accepted = accepted | kind;
+    }
+    return kinds & accepted;
+}
+
+bool Identity::may_capture_scope() const {
+    return this->operand->may_capture_scope();
+}
+
+bool Identity::is_pure(PurityAnalysis& analysis) const {
+    return this->operand->is_pure(analysis);
+}
+
+bool Identity::hoist_invariants(LoopOptimizer& optimizer) {
+    return optimizer.hoist(this->operand);
+}
+
+std::unique_ptr<Expression> Identity::unbox(Unboxer& unboxer) {
+    unboxer.unbox(this->operand);
+    return nullptr;
+}
+
+void Identity::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->operand);
+}
+
+std::unique_ptr<Expression> Identity::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->operand);
+    return nullptr;
+}
+
+std::optional<std::string> Identity::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->operand);
+    return std::nullopt;
+}
+
+} // namespace evaluator
@@ -0,0 +1,302 @@
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../dead_code.h"
+#include "../expression.h"
+#include "../function.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+using ast::Span;
+using utils::Depth;
+
+Inlined::Inlined(
+    Span span,
+    std::shared_ptr<ast::Symbol> callee,
+    std::shared_ptr<Body> definition,
+    BuiltInGuard guard,
+    std::vector<std::unique_ptr<Expression>> arguments,
+    std::unique_ptr<InlinedFrame> frame,
+    std::unique_ptr<Expression> body,
+    std::unique_ptr<Expression> fallback
+)
+    : Expression(span), callee(std::move(callee)),
+      definition(std::move(definition)), guard(std::move(guard)),
+      arguments(std::move(arguments)), frame(std::move(frame)),
+      body(std::move(body)), fallback(std::move(fallback)) {}
+
+bool Inlined::check(Scope& scope) const {
+    if (this->version != Scope::version) {
+        this->holds = false;
+        if (!Scope::is_declared_local(this->callee->value)) {
+            auto function = std::dynamic_pointer_cast<UserDefinedFunction>(
+                scope.lookup(*this->callee)
+            );
+            this->holds = function && function->has_body(*this->definition);
+        }
+        this->version = Scope::version;
+    }
+    return this->holds && this->guard.check(scope);
+}
+
+// Points the frame of an inlined call at its arguments while its body is
+// evaluated. A call the arguments themselves make may evaluate the same body,
+// so the arguments it pointed at before are restored afterwards.
+class FrameArguments {
+    InlinedFrame& frame;
+    std::shared_ptr<ast::Element> const* previous;
+
+  public:
+    FrameArguments(
+        InlinedFrame& frame,
+        std::span<std::shared_ptr<ast::Element> const> arguments
+    )
+        : frame(frame), previous(frame.arguments) {
+        frame.arguments = arguments.data();
+    }
+
+    ~FrameArguments() { this->frame.arguments = this->previous; }
+};
+
+ElementGuard Inlined::evaluate(EvaluationContext context) const {
+    if (!this->check(*context.scope)) {
+        return this->fallback->evaluate(context);
+    }
+
+    auto window =
+        context.garbage_collector->allocate_arguments(this->arguments.size());
+    for (size_t index = 0; index < this->arguments.size(); ++index) {
+        auto guard = this->arguments[index]->evaluate(context);
+        guard.deactivate();
+        window[index] = *guard;
+    }
+
+    FrameArguments frame(*this->frame, window.arguments());
+    return this->body->evaluate(context);
+}
+
+void Inlined::display(std::ostream& stream, size_t depth) const {
+    stream << "Inlined {\n";
+
+    stream << Depth(depth + 1)
+           << "function = " << this->callee->display_verbose(depth + 1)
+           << '\n';
+
+    stream << Depth(depth + 1) << "assumes = ";
+    this->guard.display(stream);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "arguments = [\n";
+    for (size_t index = 0; index < this->arguments.size(); ++index) {
+        stream << Depth(depth + 2) << this->frame->parameters[index]->value
+               << " = ";
+        this->arguments[index]->display(stream, depth + 2);
+        stream << ",\n";
+    }
+    stream << Depth(depth + 1) << "]\n";
+
+    stream << Depth(depth + 1) << "body = ";
+    this->body->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "fallback = ";
+    this->fallback->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+// The inlined body neither returns nor breaks, so the call decides
+bool Inlined::_returns() const { return this->fallback->returns(); }
+bool Inlined::_breaks() const { return this->fallback->breaks(); }
+
+bool Inlined::_can_evaluate_to(ElementKind kind) const {
+    return this->fallback->can_evaluate_to(kind);
+}
+
+bool Inlined::_can_break_with(ElementKind kind) const {
+    return this->fallback->can_break_with(kind);
+}
+
+void Inlined::_validate_no_free_break() const {
+    this->fallback->validate_no_free_break();
+}
+
+void Inlined::_validate_no_break_with_value() const {
+    this->fallback->validate_no_break_with_value();
+}
+
+std::unique_ptr<Expression> Inlined::clone() const {
+    // The copy of the body reads the frame of this call, so copies start from
+    // the original call
+    return this->fallback->clone();
+}
+
+std::unique_ptr<Expression>
+Inlined::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    for (auto& argument : this->arguments) {
+        eliminator.eliminate(argument);
+    }
+    eliminator.eliminate(this->body);
+    eliminator.eliminate(this->fallback);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Inlined::fold_constants(Optimizer& optimizer) {
+    for (auto& argument : this->arguments) {
+        optimizer.fold_constants(argument);
+    }
+    optimizer.fold_constants(this->body);
+    optimizer.fold_constants(this->fallback);
+    return nullptr;
+}
+
+ast::Kinds Inlined::infer_types(TypeInference& inference) {
+    auto before = inference.save();
+    for (size_t index = 0; index < this->arguments.size(); ++index) {
+        this->frame->kinds[index] = inference.infer(this->arguments[index]);
+    }
+    auto inlined = inference.infer(this->body);
+    auto after_inlined = inference.save();
+
+    inference.restore(std::move(before));
+    auto fallback = inference.infer(this->fallback);
+    inference.join(after_inlined);
+
+    return inlined | fallback;
+}
+
+bool Inlined::may_capture_scope() const {
+    return this->fallback->may_capture_scope();
+}
+
+bool Inlined::is_pure(PurityAnalysis& analysis) const {
+    return this->fallback->is_pure(analysis);
+}
+
+bool Inlined::hoist_invariants(LoopOptimizer& optimizer) {
+    for (auto& argument : this->arguments) {
+        optimizer.hoist(argument);
+    }
+    optimizer.hoist(this->body);
+    optimizer.hoist(this->fallback);
+    return false;
+}
+
+std::unique_ptr<Expression> Inlined::unbox(Unboxer& unboxer) {
+    // Arguments aren't kept in variables the unboxer knows of
+    unboxer.reject();
+    for (auto& argument : this->arguments) {
+        unboxer.unbox(argument);
+    }
+    return nullptr;
+}
+
+void Inlined::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->fallback);
+}
+
+std::unique_ptr<Expression> Inlined::inline_calls(Inliner&) { return nullptr; }
+
+std::unique_ptr<Expression> Inlined::inline_copy(Inliner& inliner) const {
+    return this->fallback->inline_copy(inliner);
+}
+
+std::unique_ptr<Expression>
+Inlined::partial_copy(PartialEvaluator& evaluator) const {
+    return evaluator.copy(*this->fallback);
+}
+
+InlinedParameter::InlinedParameter(
+    std::shared_ptr<ast::Symbol> parameter, InlinedFrame* frame, size_t index
+)
+    : Expression(parameter->span), parameter(std::move(parameter)),
+      frame(frame), index(index) {}
+
+ElementGuard InlinedParameter::evaluate(EvaluationContext context) const {
+    return context.garbage_collector->temporary(
+        this->frame->arguments[this->index]
+    );
+}
+
+void InlinedParameter::display(std::ostream& stream, size_t) const {
+    stream << "InlinedParameter(" << this->parameter->value << ", " << this->span
+           << ')';
+}
+
+bool InlinedParameter::_returns() const { return false; }
+bool InlinedParameter::_breaks() const { return false; }
+
+bool InlinedParameter::_can_evaluate_to(ElementKind) const { return true; }
+bool InlinedParameter::_can_break_with(ElementKind) const { return false; }
+void InlinedParameter::_validate_no_free_break() const {}
+void InlinedParameter::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> InlinedParameter::clone() const {
+    return std::make_unique<InlinedParameter>(
+        this->parameter, this->frame, this->index
+    );
+}
+
+std::unique_ptr<Expression>
+InlinedParameter::eliminate_dead_code(DeadCodeEliminator&) {
+    return nullptr;
+}
+
+std::unique_ptr<Expression> InlinedParameter::fold_constants(Optimizer&) {
+    return nullptr;
+}
+
+ast::Kinds InlinedParameter::infer_types(TypeInference&) {
+    return this->frame->kinds[this->index];
+}
+
+bool InlinedParameter::may_capture_scope() const { return false; }
+
+bool InlinedParameter::is_pure(PurityAnalysis&) const {
+    // Only reads an argument of the call
+    return true;
+}
+
+bool InlinedParameter::hoist_invariants(LoopOptimizer&) {
+    // Arguments are evaluated on every call
+    return false;
+}
+
+std::unique_ptr<Expression> InlinedParameter::unbox(Unboxer&) {
+    return nullptr;
+}
+
+void InlinedParameter::convert_closures(ClosureConverter&) {}
+
+std::unique_ptr<Expression> InlinedParameter::inline_calls(Inliner&) {
+    return nullptr;
+}
+
+std::optional<std::string> Inlined::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    // The copy of the body only reads the arguments, and the fallback
+    // evaluates copies of them instead
+    for (auto& argument : this->arguments) {
+        eliminator.eliminate(argument);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> InlinedParameter::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator&
+) {
+    return std::nullopt;
+}
+
+} // namespace evaluator
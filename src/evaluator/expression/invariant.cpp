@@ -0,0 +1,129 @@
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../dead_code.h"
+#include "../expression.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+using utils::Depth;
+
+Invariant::Invariant(std::unique_ptr<Expression> expression)
+    : Expression(expression->span), expression(std::move(expression)) {}
+
+Invariant::Value Invariant::reset() const {
+    return std::exchange(this->value, Value());
+}
+
+void Invariant::restore(Value value) const { this->value = std::move(value); }
+
+ElementGuard Invariant::evaluate(EvaluationContext context) const {
+    if (this->value.element && this->value.version == Scope::version) {
+        return context.garbage_collector->temporary(this->value.element);
+    }
+
+    auto element = this->expression->evaluate(context);
+    this->value = Value{*element, Scope::version};
+    return element;
+}
+
+void Invariant::display(std::ostream& stream, size_t depth) const {
+    stream << "Invariant {\n";
+
+    stream << Depth(depth + 1) << "expression = ";
+    this->expression->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool Invariant::_returns() const { return this->expression->returns(); }
+
+bool Invariant::_breaks() const { return this->expression->breaks(); }
+
+bool Invariant::_can_evaluate_to(ElementKind kind) const {
+    return this->expression->can_evaluate_to(kind);
+}
+
+bool Invariant::_can_break_with(ElementKind kind) const {
+    return this->expression->can_break_with(kind);
+}
+
+void Invariant::_validate_no_free_break() const {
+    this->expression->validate_no_free_break();
+}
+
+void Invariant::_validate_no_break_with_value() const {
+    this->expression->validate_no_break_with_value();
+}
+
+std::unique_ptr<Expression> Invariant::clone() const {
+    // The copy doesn't belong to the loop that resets this one
+    return this->expression->clone();
+}
+
+std::unique_ptr<Expression>
+Invariant::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->expression);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Invariant::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->expression);
+    return nullptr;
+}
+
+ast::Kinds Invariant::infer_types(TypeInference& inference) {
+    return inference.infer(this->expression);
+}
+
+bool Invariant::may_capture_scope() const {
+    return this->expression->may_capture_scope();
+}
+
+bool Invariant::is_pure(PurityAnalysis& analysis) const {
+    return this->expression->is_pure(analysis);
+}
+
+bool Invariant::hoist_invariants(LoopOptimizer&) {
+    // Already hoisted
+    return false;
+}
+
+std::unique_ptr<Expression> Invariant::unbox(Unboxer& unboxer) {
+    unboxer.unbox(this->expression);
+    return nullptr;
+}
+
+void Invariant::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->expression);
+}
+
+std::unique_ptr<Expression> Invariant::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->expression);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Invariant::partial_copy(PartialEvaluator& evaluator) const {
+    return evaluator.copy(*this->expression);
+}
+
+std::optional<std::string> Invariant::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->expression);
+    return std::nullopt;
+}
+
+} // namespace evaluator
@@ -1,7 +1,19 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
 #include "../function.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../macros.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
@@ -32,6 +44,7 @@ Lambda::parse(Span span, std::shared_ptr<ast::List> arguments) {
         );
     }
     auto parameters = Parameters::parse(parameter_list);
+    Macros::Shadow shadow(parameters);
 
     auto body = Body::parse(cons->right);
     body.validate_no_free_break();
@@ -42,9 +55,14 @@ Lambda::parse(Span span, std::shared_ptr<ast::List> arguments) {
 }
 
 ElementGuard Lambda::evaluate(EvaluationContext context) const {
+    auto captured = this->captures.copy(*context.scope);
     return context.garbage_collector->temporary(
         std::make_shared<LambdaFunction>(
-            this->span, this->parameters, this->body, context.scope
+            this->span,
+            this->parameters,
+            this->body,
+            captured ? captured : context.scope->capture(),
+            captured
         )
     );
 }
@@ -60,18 +78,99 @@ void Lambda::display(std::ostream& stream, size_t depth) const {
     this->body->display(stream, depth + 1);
     stream << '\n';
 
+    if (this->captures.converted) {
+        stream << Depth(depth + 1) << "captures = ";
+        this->captures.display(stream);
+        stream << '\n';
+    }
+
     stream << Depth(depth + 1) << "span = " << this->span << '\n';
 
     stream << Depth(depth) << '}';
 }
 
-bool Lambda::returns() const { return false; }
-bool Lambda::breaks() const { return false; }
-bool Lambda::can_evaluate_to(ast::ElementKind kind) const {
+bool Lambda::_returns() const { return false; }
+bool Lambda::_breaks() const { return false; }
+bool Lambda::_can_evaluate_to(ast::ElementKind kind) const {
     return kind == ast::ElementKind::FUNCTION;
 }
-bool Lambda::can_break_with(ast::ElementKind) const { return false; }
-void Lambda::validate_no_free_break() const {}
-void Lambda::validate_no_break_with_value() const {}
+bool Lambda::_can_break_with(ast::ElementKind) const { return false; }
+void Lambda::_validate_no_free_break() const {}
+void Lambda::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> Lambda::clone() const {
+    auto clone = std::make_unique<Lambda>(
+        this->span, this->parameters, std::make_shared<Body>(this->body->clone())
+    );
+    clone->captures = this->captures;
+    return clone;
+}
+
+std::unique_ptr<Expression>
+Lambda::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(*this->body);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Lambda::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(*this->body);
+    return nullptr;
+}
+
+ast::Kinds Lambda::infer_types(TypeInference& inference) {
+    inference.infer_function(this->parameters, *this->body);
+    return ast::ElementKind::FUNCTION;
+}
+
+bool Lambda::may_capture_scope() const { return !this->captures.converted; }
+
+// Creates a closure, which is different on every evaluation
+bool Lambda::is_pure(PurityAnalysis&) const { return false; }
+
+std::string Lambda::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_lambda(this->span, this->parameters, *this->body);
+}
+
+bool Lambda::hoist_invariants(LoopOptimizer& optimizer) {
+    if (optimizer.is_rewriting()) {
+        optimizer.hoist_function(this->parameters, *this->body);
+    }
+    return false;
+}
+
+std::unique_ptr<Expression> Lambda::unbox(Unboxer& unboxer) {
+    unboxer.reject();
+    if (unboxer.get_mode() == Unboxer::Mode::SEARCHING) {
+        unboxer.unbox_function(this->parameters, *this->body);
+    }
+    return nullptr;
+}
+
+void Lambda::convert_closures(ClosureConverter& converter) {
+    converter.convert_closure(this->captures, this->parameters, *this->body);
+}
+
+std::unique_ptr<Expression> Lambda::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(*this->body);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Lambda::partial_copy(PartialEvaluator& evaluator) const {
+    auto body = evaluator.copy_scope(this->parameters, *this->body);
+    if (!body) {
+        return nullptr;
+    }
+    return std::make_unique<Lambda>(
+        this->span, this->parameters, std::make_shared<Body>(std::move(*body))
+    );
+}
+
+std::optional<std::string> Lambda::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate_function(this->parameters, *this->body);
+    return std::nullopt;
+}
 
 } // namespace evaluator
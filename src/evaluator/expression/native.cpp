@@ -0,0 +1,216 @@
+#include "../../utils.h"
+#include "../error.h"
+#include "../expression.h"
+#include <stdexcept>
+
+namespace evaluator {
+
+using ast::ElementKind;
+using ast::Span;
+using utils::Depth;
+
+Slot::Slot(std::shared_ptr<ast::Symbol> variable)
+    : variable(std::move(variable)) {}
+
+Native::Native(Span span, ElementKind kind) : span(span), kind(kind) {}
+
+int64_t Native::integer() const {
+    throw std::logic_error("Read a native value of the wrong kind. This is a bug."
+    );
+}
+
+double Native::real() const { return static_cast<double>(this->integer()); }
+
+bool Native::boolean() const {
+    throw std::logic_error("Read a native value of the wrong kind. This is a bug."
+    );
+}
+
+NativeSlot::NativeSlot(Span span, Slot* slot)
+    : Native(span, slot->kind), slot(slot) {}
+
+int64_t NativeSlot::integer() const { return this->slot->integer; }
+
+double NativeSlot::real() const {
+    if (this->kind == ElementKind::INTEGER) {
+        return static_cast<double>(this->slot->integer);
+    }
+    return this->slot->real;
+}
+
+void NativeSlot::display(std::ostream& stream, size_t) const {
+    stream << "NativeSlot(" << this->slot->variable->value << ' ' << this->kind
+           << ')';
+}
+
+std::unique_ptr<Native> NativeSlot::clone() const {
+    return std::make_unique<NativeSlot>(this->span, this->slot);
+}
+
+NativeConstant::NativeConstant(Span span, int64_t value)
+    : Native(span, ElementKind::INTEGER), integer_value(value),
+      real_value(static_cast<double>(value)) {}
+
+NativeConstant::NativeConstant(Span span, double value)
+    : Native(span, ElementKind::REAL), integer_value(0), real_value(value) {}
+
+int64_t NativeConstant::integer() const { return this->integer_value; }
+double NativeConstant::real() const { return this->real_value; }
+
+void NativeConstant::display(std::ostream& stream, size_t) const {
+    stream << "NativeConstant(";
+    if (this->kind == ElementKind::INTEGER) {
+        stream << this->integer_value;
+    } else {
+        stream << this->real_value;
+    }
+    stream << ')';
+}
+
+std::unique_ptr<Native> NativeConstant::clone() const {
+    if (this->kind == ElementKind::INTEGER) {
+        return std::make_unique<NativeConstant>(this->span, this->integer_value);
+    }
+    return std::make_unique<NativeConstant>(this->span, this->real_value);
+}
+
+NativeArithmetic::NativeArithmetic(
+    Span span,
+    Arithmetic::Operation operation,
+    std::unique_ptr<Native> left,
+    std::unique_ptr<Native> right
+)
+    : Native(
+          span,
+          left->kind == ElementKind::INTEGER &&
+                  right->kind == ElementKind::INTEGER
+              ? ElementKind::INTEGER
+              : ElementKind::REAL
+      ),
+      operation(operation), left(std::move(left)), right(std::move(right)) {}
+
+int64_t NativeArithmetic::integer() const {
+    auto a = this->left->integer();
+    auto b = this->right->integer();
+
+    switch (this->operation) {
+    case Arithmetic::Operation::PLUS:
+        return a + b;
+    case Arithmetic::Operation::MINUS:
+        return a - b;
+    case Arithmetic::Operation::TIMES:
+        return a * b;
+    case Arithmetic::Operation::DIVIDE:
+        if (b == 0) {
+            throw EvaluationError("division by zero", this->span);
+        }
+        return a / b;
+    }
+    return 0;
+}
+
+double NativeArithmetic::real() const {
+    if (this->kind == ElementKind::INTEGER) {
+        return static_cast<double>(this->integer());
+    }
+
+    auto a = this->left->real();
+    auto b = this->right->real();
+
+    switch (this->operation) {
+    case Arithmetic::Operation::PLUS:
+        return a + b;
+    case Arithmetic::Operation::MINUS:
+        return a - b;
+    case Arithmetic::Operation::TIMES:
+        return a * b;
+    case Arithmetic::Operation::DIVIDE:
+        return a / b;
+    }
+    return 0;
+}
+
+void NativeArithmetic::display(std::ostream& stream, size_t depth) const {
+    stream << "NativeArithmetic {\n";
+
+    stream << Depth(depth + 1)
+           << "operation = " << operation_name(this->operation) << '\n';
+
+    stream << Depth(depth + 1) << "left = ";
+    this->left->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "right = ";
+    this->right->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+std::unique_ptr<Native> NativeArithmetic::clone() const {
+    return std::make_unique<NativeArithmetic>(
+        this->span, this->operation, this->left->clone(), this->right->clone()
+    );
+}
+
+NativeComparison::NativeComparison(
+    Span span,
+    Comparison::Operation operation,
+    std::unique_ptr<Native> left,
+    std::unique_ptr<Native> right
+)
+    : Native(span, ElementKind::BOOLEAN), operation(operation),
+      left(std::move(left)), right(std::move(right)) {}
+
+template <typename T>
+bool compare_natively(Comparison::Operation operation, T a, T b) {
+    switch (operation) {
+    case Comparison::Operation::EQUAL:
+        return a == b;
+    case Comparison::Operation::NONEQUAL:
+        return a != b;
+    case Comparison::Operation::LESS:
+        return a < b;
+    case Comparison::Operation::LESSEQ:
+        return a <= b;
+    case Comparison::Operation::GREATER:
+        return a > b;
+    case Comparison::Operation::GREATEREQ:
+        return a >= b;
+    }
+    return false;
+}
+
+bool NativeComparison::boolean() const {
+    if (this->left->kind == ElementKind::INTEGER) {
+        return compare_natively(
+            this->operation, this->left->integer(), this->right->integer()
+        );
+    }
+    return compare_natively(this->operation, this->left->real(), this->right->real());
+}
+
+void NativeComparison::display(std::ostream& stream, size_t depth) const {
+    stream << "NativeComparison {\n";
+
+    stream << Depth(depth + 1)
+           << "operation = " << operation_name(this->operation) << '\n';
+
+    stream << Depth(depth + 1) << "left = ";
+    this->left->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "right = ";
+    this->right->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+std::unique_ptr<Native> NativeComparison::clone() const {
+    return std::make_unique<NativeComparison>(
+        this->span, this->operation, this->left->clone(), this->right->clone()
+    );
+}
+
+} // namespace evaluator
@@ -41,6 +41,8 @@ Parameters Parameters::parse(std::shared_ptr<List> parameter_list) {
             throw EvaluationError(message, cons->left->span);
         }
 
+        // Declare the name early so optimizations know it may be shadowed
+        Scope::declare_local(parameter->value);
         parameters.push_back(parameter);
         cons = to_cons(cons->right);
     }
@@ -1,7 +1,20 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
 #include "../control_flow.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../macros.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
@@ -30,6 +43,7 @@ std::unique_ptr<Prog> Prog::parse(Span span, std::shared_ptr<List> arguments) {
         );
     }
     auto variables = Parameters::parse(variable_list);
+    Macros::Shadow shadow(variables);
 
     auto body = Body::parse(cons->right);
 
@@ -37,7 +51,9 @@ std::unique_ptr<Prog> Prog::parse(Span span, std::shared_ptr<List> arguments) {
 }
 
 ElementGuard Prog::evaluate(EvaluationContext context) const {
-    auto local_scope = context.garbage_collector->create_scope(context.scope);
+    auto local_scope = this->body.create_scope(
+        context.garbage_collector, context.scope->shared_from_this()
+    );
 
     for (auto parameter : this->variables.parameters) {
         local_scope->define(
@@ -47,7 +63,7 @@ ElementGuard Prog::evaluate(EvaluationContext context) const {
 
     try {
         return this->body.evaluate(
-            EvaluationContext(context.garbage_collector, *local_scope)
+            EvaluationContext(context.garbage_collector, local_scope.get())
         );
     } catch (BreakControlFlow& e) {
         return std::move(e.element);
@@ -70,7 +86,7 @@ void Prog::display(std::ostream& stream, size_t depth) const {
     stream << Depth(depth) << '}';
 }
 
-bool Prog::returns() const {
+bool Prog::_returns() const {
     for (auto const& expression : this->body.body) {
         if (expression->returns()) {
             return true;
@@ -80,9 +96,9 @@ bool Prog::returns() const {
     return false;
 }
 
-bool Prog::breaks() const { return false; }
+bool Prog::_breaks() const { return false; }
 
-bool Prog::can_evaluate_to(ast::ElementKind kind) const {
+bool Prog::_can_evaluate_to(ast::ElementKind kind) const {
     for (auto const& expression : this->body.body) {
         if (expression->can_break_with(kind)) {
             return true;
@@ -96,8 +112,99 @@ bool Prog::can_evaluate_to(ast::ElementKind kind) const {
            this->body.body.back()->can_evaluate_to(kind);
 }
 
-bool Prog::can_break_with(ast::ElementKind) const { return false; }
-void Prog::validate_no_free_break() const {}
-void Prog::validate_no_break_with_value() const {}
+bool Prog::_can_break_with(ast::ElementKind) const { return false; }
+void Prog::_validate_no_free_break() const {}
+void Prog::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> Prog::clone() const {
+    return std::make_unique<Prog>(
+        this->span, this->variables, this->body.clone()
+    );
+}
+
+std::unique_ptr<Expression>
+Prog::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->body);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Prog::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->body);
+    return nullptr;
+}
+
+ast::Kinds Prog::infer_types(TypeInference& inference) {
+    // Variables start as `null`
+    inference.enter_scope(
+        this->variables, ast::ElementKind::NULL_, !this->body.may_capture_scope()
+    );
+    inference.enter_break_target();
+
+    auto kinds = inference.infer(this->body);
+    kinds = kinds | inference.exit_break_target();
+
+    inference.exit_scope();
+    return kinds;
+}
+
+bool Prog::may_capture_scope() const { return this->body.may_capture_scope(); }
+
+bool Prog::is_pure(PurityAnalysis& analysis) const {
+    analysis.enter_scope(this->variables);
+    bool pure = this->body.is_pure(analysis);
+    analysis.exit_scope();
+    return pure;
+}
+
+ast::ElementKind Prog::jit(JitCompiler& compiler) const {
+    return compiler.emit_prog(this->variables, this->body);
+}
+
+std::string Prog::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_prog(this->variables, this->body);
+}
+
+bool Prog::hoist_invariants(LoopOptimizer& optimizer) {
+    optimizer.enter_scope(this->variables, !this->body.may_capture_scope());
+    optimizer.hoist(this->body);
+    optimizer.exit_scope();
+    return false;
+}
+
+std::unique_ptr<Expression> Prog::unbox(Unboxer& unboxer) {
+    // Declaring a variable may shadow a built-in the loop relies on
+    unboxer.reject();
+    unboxer.enter_scope(this->variables, !this->body.may_capture_scope());
+    unboxer.unbox(this->body);
+    unboxer.exit_scope();
+    return nullptr;
+}
+
+void Prog::convert_closures(ClosureConverter& converter) {
+    converter.convert_scope(this->variables, this->body);
+}
+
+std::unique_ptr<Expression> Prog::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->body);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Prog::partial_copy(PartialEvaluator& evaluator) const {
+    auto body = evaluator.copy_scope(this->variables, this->body);
+    if (!body) {
+        return nullptr;
+    }
+    return std::make_unique<Prog>(
+        this->span, this->variables, std::move(*body)
+    );
+}
+
+std::optional<std::string> Prog::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate_scope(this->variables, this->body);
+    return std::nullopt;
+}
 
 } // namespace evaluator
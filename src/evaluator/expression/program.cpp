@@ -1,6 +1,15 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
 #include "../control_flow.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../expression.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 #include <memory>
 
 namespace evaluator {
@@ -29,6 +38,18 @@ ElementGuard Program::evaluate(EvaluationContext context) const {
     }
 }
 
+void Program::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->program);
+}
+
+void Program::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->program);
+}
+
+void Program::infer_types(TypeInference& inference) {
+    inference.infer(this->program);
+}
+
 std::ostream& operator<<(std::ostream& stream, Program const& self) {
     stream << "Program [\n";
 
@@ -43,4 +64,28 @@ std::ostream& operator<<(std::ostream& stream, Program const& self) {
     return stream;
 }
 
+void Program::hoist_invariants(LoopOptimizer& optimizer) {
+    optimizer.hoist(this->program);
+}
+
+void Program::unbox(Unboxer& unboxer) { unboxer.unbox(this->program); }
+
+void Program::convert_closures(ClosureConverter& converter) {
+    converter.convert_program(this->program);
+}
+
+void Program::inline_calls(Inliner& inliner) {
+    inliner.inline_program(this->program);
+}
+
+void Program::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate_program(this->program);
+}
+
+void Program::emit_cpp(CppEmitter& emitter) const {
+    emitter.emit_program(this->program);
+}
+
 } // namespace evaluator
@@ -1,6 +1,16 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
@@ -46,13 +56,84 @@ void Quote::display(std::ostream& stream, size_t depth) const {
     stream << Depth(depth) << '}';
 }
 
-bool Quote::returns() const { return false; }
-bool Quote::breaks() const { return false; }
-bool Quote::can_evaluate_to(ast::ElementKind kind) const {
+bool Quote::_returns() const { return false; }
+bool Quote::_breaks() const { return false; }
+bool Quote::_can_evaluate_to(ast::ElementKind kind) const {
     return this->element->kind == kind;
 }
-bool Quote::can_break_with(ast::ElementKind) const { return false; }
-void Quote::validate_no_free_break() const {}
-void Quote::validate_no_break_with_value() const {}
+bool Quote::_can_break_with(ast::ElementKind) const { return false; }
+void Quote::_validate_no_free_break() const {}
+void Quote::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> Quote::clone() const {
+    return std::make_unique<Quote>(this->span, this->element);
+}
+
+std::unique_ptr<Expression>
+Quote::eliminate_dead_code(DeadCodeEliminator&) {
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Quote::fold_constants(Optimizer&) {
+    return nullptr;
+}
+
+std::shared_ptr<Element> Quote::constant(BuiltInGuard&) const {
+    return this->element;
+}
+
+ast::Kinds Quote::infer_types(TypeInference&) { return this->element->kind; }
+
+bool Quote::may_capture_scope() const { return false; }
+
+bool Quote::is_pure(PurityAnalysis&) const { return true; }
+
+ast::ElementKind Quote::jit(JitCompiler& compiler) const {
+    return compiler.emit_constant(*this->element);
+}
+
+std::string Quote::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_constant(*this->element);
+}
+
+bool Quote::hoist_invariants(LoopOptimizer&) { return true; }
+
+std::unique_ptr<Expression> Quote::unbox(Unboxer&) { return nullptr; }
+
+std::unique_ptr<Native>
+Quote::unboxed(Unboxer&, ast::ElementKind kind) const {
+    if (this->element->kind != kind) {
+        return nullptr;
+    }
+    if (kind == ast::ElementKind::INTEGER) {
+        return std::make_unique<NativeConstant>(
+            this->span, static_cast<ast::Integer const&>(*this->element).value
+        );
+    }
+    if (kind == ast::ElementKind::REAL) {
+        return std::make_unique<NativeConstant>(
+            this->span, static_cast<ast::Real const&>(*this->element).value
+        );
+    }
+    return nullptr;
+}
+
+void Quote::convert_closures(ClosureConverter&) {}
+
+std::unique_ptr<Expression> Quote::inline_calls(Inliner&) { return nullptr; }
+
+std::unique_ptr<Expression> Quote::inline_copy(Inliner&) const {
+    return this->clone();
+}
+
+std::unique_ptr<Expression> Quote::partial_copy(PartialEvaluator&) const {
+    return this->clone();
+}
+
+std::optional<std::string> Quote::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    return eliminator.constant(*this->element);
+}
 
 } // namespace evaluator
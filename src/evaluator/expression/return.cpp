@@ -1,7 +1,19 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
 #include "../control_flow.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
@@ -53,20 +65,94 @@ void Return::display(std::ostream& stream, size_t depth) const {
     stream << Depth(depth) << '}';
 }
 
-bool Return::returns() const { return !this->breaks(); }
-bool Return::breaks() const { return this->expression->breaks(); }
-bool Return::can_evaluate_to(ast::ElementKind) const { return false; }
+// Asks the argument, since the analysis of this expression is what is being
+// computed
+bool Return::_returns() const { return !this->expression->breaks(); }
+bool Return::_breaks() const { return this->expression->breaks(); }
+bool Return::_can_evaluate_to(ast::ElementKind) const { return false; }
 
-bool Return::can_break_with(ast::ElementKind kind) const {
+bool Return::_can_break_with(ast::ElementKind kind) const {
     return this->expression->can_break_with(kind);
 }
 
-void Return::validate_no_free_break() const {
+void Return::_validate_no_free_break() const {
     this->expression->validate_no_free_break();
 }
 
-void Return::validate_no_break_with_value() const {
+void Return::_validate_no_break_with_value() const {
     this->expression->validate_no_break_with_value();
 }
 
+std::unique_ptr<Expression> Return::clone() const {
+    return std::make_unique<Return>(this->span, this->expression->clone());
+}
+
+std::unique_ptr<Expression>
+Return::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->expression);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Return::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->expression);
+    return nullptr;
+}
+
+ast::Kinds Return::infer_types(TypeInference& inference) {
+    inference.infer(this->expression);
+    inference.diverge_with_return();
+    return ast::Kinds();
+}
+
+bool Return::may_capture_scope() const {
+    return this->expression->may_capture_scope();
+}
+
+bool Return::is_pure(PurityAnalysis& analysis) const {
+    return this->expression->is_pure(analysis);
+}
+
+ast::ElementKind Return::jit(JitCompiler& compiler) const {
+    return compiler.emit_return(*this->expression);
+}
+
+std::string Return::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_return(*this->expression);
+}
+
+bool Return::hoist_invariants(LoopOptimizer& optimizer) {
+    optimizer.hoist(this->expression);
+    return false;
+}
+
+std::unique_ptr<Expression> Return::unbox(Unboxer& unboxer) {
+    unboxer.unbox(this->expression);
+    return nullptr;
+}
+
+void Return::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->expression);
+}
+
+std::unique_ptr<Expression> Return::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->expression);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Return::partial_copy(PartialEvaluator& evaluator) const {
+    auto expression = evaluator.copy(*this->expression);
+    if (!expression) {
+        return nullptr;
+    }
+    return std::make_unique<Return>(this->span, std::move(expression));
+}
+
+std::optional<std::string> Return::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->expression);
+    return std::nullopt;
+}
+
 } // namespace evaluator
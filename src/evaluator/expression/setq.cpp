@@ -1,6 +1,18 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
@@ -70,23 +82,114 @@ void Setq::display(std::ostream& stream, size_t depth) const {
     stream << Depth(depth) << '}';
 }
 
-bool Setq::returns() const { return this->initializer->returns(); }
-bool Setq::breaks() const { return this->initializer->breaks(); }
+bool Setq::_returns() const { return this->initializer->returns(); }
+bool Setq::_breaks() const { return this->initializer->breaks(); }
 
-bool Setq::can_evaluate_to(ast::ElementKind kind) const {
+bool Setq::_can_evaluate_to(ast::ElementKind kind) const {
     return this->initializer->can_evaluate_to(kind);
 }
 
-bool Setq::can_break_with(ast::ElementKind kind) const {
+bool Setq::_can_break_with(ast::ElementKind kind) const {
     return this->initializer->can_break_with(kind);
 }
 
-void Setq::validate_no_free_break() const {
+void Setq::_validate_no_free_break() const {
     this->initializer->validate_no_free_break();
 }
 
-void Setq::validate_no_break_with_value() const {
+void Setq::_validate_no_break_with_value() const {
     this->initializer->validate_no_break_with_value();
 }
 
+std::unique_ptr<Expression> Setq::clone() const {
+    return std::make_unique<Setq>(
+        this->span, this->variable, this->initializer->clone()
+    );
+}
+
+std::unique_ptr<Expression>
+Setq::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->initializer);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Setq::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->initializer);
+    return nullptr;
+}
+
+ast::Kinds Setq::infer_types(TypeInference& inference) {
+    auto kinds = inference.infer(this->initializer);
+    inference.assign(*this->variable, kinds);
+    return kinds;
+}
+
+bool Setq::may_capture_scope() const {
+    return this->initializer->may_capture_scope();
+}
+
+bool Setq::is_pure(PurityAnalysis& analysis) const {
+    return analysis.is_local(*this->variable) &&
+           this->initializer->is_pure(analysis);
+}
+
+ast::ElementKind Setq::jit(JitCompiler& compiler) const {
+    return compiler.emit_assignment(*this->variable, *this->initializer);
+}
+
+std::string Setq::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_assignment(*this->variable, *this->initializer);
+}
+
+bool Setq::hoist_invariants(LoopOptimizer& optimizer) {
+    optimizer.hoist(this->initializer);
+    optimizer.assign(*this->variable);
+    return false;
+}
+
+std::unique_ptr<Expression> Setq::unbox(Unboxer& unboxer) {
+    if (auto slot = unboxer.slot(*this->variable)) {
+        return std::make_unique<UnboxedSetq>(
+            this->span, slot, this->initializer->unboxed(unboxer, slot->kind)
+        );
+    }
+
+    unboxer.unbox(this->initializer);
+    unboxer.assign(this->variable, *this->initializer);
+    return nullptr;
+}
+
+void Setq::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->initializer);
+    converter.assign(this->variable);
+}
+
+std::unique_ptr<Expression> Setq::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->initializer);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+Setq::partial_copy(PartialEvaluator& evaluator) const {
+    if (!evaluator.assign(*this->variable)) {
+        return nullptr;
+    }
+
+    auto initializer = evaluator.copy(*this->initializer);
+    if (!initializer) {
+        return nullptr;
+    }
+    return std::make_unique<Setq>(
+        this->span, this->variable, std::move(initializer)
+    );
+}
+
+std::optional<std::string> Setq::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->initializer);
+    eliminator.assign(*this->variable);
+    return std::nullopt;
+}
+
 } // namespace evaluator
@@ -0,0 +1,487 @@
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
+
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
+#include "../error.h"
+#include "../expression.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::Element;
+using ast::ElementKind;
+using ast::List;
+using ast::Null;
+using ast::Span;
+using utils::Depth;
+using utils::to_cons;
+
+// Returns the value of an integer or a boolean as the jump table sees it.
+static int64_t case_value(Element const& element) {
+    if (element.kind == ElementKind::BOOLEAN) {
+        return static_cast<ast::Boolean const&>(element).value;
+    }
+    return static_cast<ast::Integer const&>(element).value;
+}
+
+static std::string kind_name(ElementKind kind) {
+    return kind == ElementKind::BOOLEAN ? "a boolean" : "an integer";
+}
+
+JumpTable::JumpTable(std::vector<int64_t> const& values)
+    : missing(values.size()) {
+    if (values.empty()) {
+        return;
+    }
+
+    auto [lowest, highest] = std::minmax_element(values.begin(), values.end());
+    // Computed unsigned, so that the widest ranges don't overflow
+    auto range = static_cast<uint64_t>(*highest) -
+                 static_cast<uint64_t>(*lowest);
+    if (range < JumpTable::DENSITY * values.size()) {
+        this->lowest = *lowest;
+        this->dense.assign(range + 1, this->missing);
+        for (size_t index = 0; index < values.size(); ++index) {
+            auto offset = static_cast<uint64_t>(values[index]) -
+                          static_cast<uint64_t>(this->lowest);
+            this->dense[offset] = index;
+        }
+        return;
+    }
+
+    for (size_t index = 0; index < values.size(); ++index) {
+        this->sparse.emplace(values[index], index);
+    }
+}
+
+size_t JumpTable::find(int64_t value) const {
+    if (!this->dense.empty()) {
+        auto offset =
+            static_cast<uint64_t>(value) - static_cast<uint64_t>(this->lowest);
+        return offset < this->dense.size() ? this->dense[offset]
+                                           : this->missing;
+    }
+
+    auto found = this->sparse.find(value);
+    return found != this->sparse.end() ? found->second : this->missing;
+}
+
+static std::vector<int64_t>
+case_values(std::vector<std::shared_ptr<Element>> const& cases) {
+    std::vector<int64_t> values;
+    for (auto const& element : cases) {
+        values.push_back(case_value(*element));
+    }
+    return values;
+}
+
+Switch::Switch(
+    Span span,
+    std::unique_ptr<Expression> value,
+    std::vector<std::shared_ptr<Element>> cases,
+    std::vector<std::unique_ptr<Expression>> branches
+)
+    : Expression(span), value(std::move(value)), cases(std::move(cases)),
+      branches(std::move(branches)),
+      kind(this->cases.empty() ? ElementKind::INTEGER : this->cases[0]->kind),
+      table(case_values(this->cases)) {}
+
+std::unique_ptr<Switch>
+Switch::parse(Span span, std::shared_ptr<List> arguments) {
+    auto cons = to_cons(arguments);
+    if (!cons) {
+        throw EvaluationError(
+            "`switch` misses a value, cases, and maybe a default branch", span
+        );
+    }
+    auto value = Expression::parse(cons->left);
+
+    std::vector<std::shared_ptr<Element>> cases;
+    std::vector<std::unique_ptr<Expression>> branches;
+    std::unordered_set<int64_t> values;
+    cons = to_cons(cons->right);
+    for (; cons; cons = to_cons(cons->right)) {
+        auto form = std::dynamic_pointer_cast<ast::Cons>(cons->left);
+        auto head =
+            form ? std::dynamic_pointer_cast<ast::Symbol>(form->left) : nullptr;
+        if (!head || head->value != "case") {
+            break;
+        }
+
+        auto rest = to_cons(form->right);
+        auto branch = rest ? to_cons(rest->right) : nullptr;
+        if (!branch || to_cons(branch->right)) {
+            throw EvaluationError(
+                "`case` expects a value and a branch", form->span
+            );
+        }
+
+        auto element = rest->left;
+        if (element->kind != ElementKind::INTEGER &&
+            element->kind != ElementKind::BOOLEAN) {
+            throw EvaluationError(
+                "a case must be an integer or a boolean", element->span
+            );
+        }
+        if (!cases.empty() && element->kind != cases[0]->kind) {
+            throw EvaluationError(
+                "cases of a `switch` must all be integers or all booleans",
+                element->span
+            );
+        }
+        if (!values.insert(case_value(*element)).second) {
+            std::ostringstream message;
+            message << "case `" << element->display_pretty()
+                    << "` is duplicated";
+            throw EvaluationError(message.str(), element->span);
+        }
+
+        cases.push_back(element);
+        branches.push_back(Expression::parse(branch->left));
+    }
+
+    if (cases.empty()) {
+        throw EvaluationError("`switch` misses cases", span);
+    }
+    if (!value->can_evaluate_to(cases[0]->kind)) {
+        auto kind = kind_name(cases[0]->kind);
+        throw EvaluationError(
+            kind + " is expected, but this expression will never evaluate to " +
+                kind,
+            value->span
+        );
+    }
+
+    if (cons) {
+        branches.push_back(Expression::parse(cons->left));
+
+        if (to_cons(cons->right)) {
+            throw EvaluationError("`switch` has extra arguments", cons->span);
+        }
+    } else {
+        branches.push_back(
+            Expression::parse(std::make_shared<Null>(arguments->span))
+        );
+    }
+
+    return std::make_unique<Switch>(
+        span, std::move(value), std::move(cases), std::move(branches)
+    );
+}
+
+Expression const* Switch::select(Element const& value) const {
+    if (value.kind != this->kind) {
+        return nullptr;
+    }
+    return this->branches[this->table.find(case_value(value))].get();
+}
+
+ElementGuard Switch::evaluate(EvaluationContext context) const {
+    auto evaluated_value = this->value->evaluate(context);
+    auto branch = this->select(*evaluated_value.get());
+    if (!branch) {
+        throw EvaluationError(
+            "switch value did not evaluate to " + kind_name(this->kind),
+            evaluated_value->span
+        );
+    }
+    return branch->evaluate(context);
+}
+
+void Switch::display(std::ostream& stream, size_t depth) const {
+    stream << "Switch {\n";
+
+    stream << Depth(depth + 1) << "value = ";
+    this->value->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "cases = [\n";
+    for (size_t index = 0; index < this->cases.size(); ++index) {
+        stream << Depth(depth + 2)
+               << this->cases[index]->display_verbose(depth + 2) << " => ";
+        this->branches[index]->display(stream, depth + 2);
+        stream << ",\n";
+    }
+    stream << Depth(depth + 1) << "]\n";
+
+    stream << Depth(depth + 1) << "otherwise = ";
+    this->branches.back()->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool Switch::_returns() const {
+    if (this->value->returns()) {
+        return true;
+    }
+    return std::all_of(
+        this->branches.begin(),
+        this->branches.end(),
+        [](auto const& branch) { return branch->returns(); }
+    );
+}
+
+bool Switch::_breaks() const {
+    if (this->value->breaks()) {
+        return true;
+    }
+    return std::all_of(
+        this->branches.begin(),
+        this->branches.end(),
+        [](auto const& branch) { return branch->breaks(); }
+    );
+}
+
+bool Switch::_can_evaluate_to(ElementKind kind) const {
+    if (this->value->diverges()) {
+        return false;
+    }
+    return std::any_of(
+        this->branches.begin(),
+        this->branches.end(),
+        [kind](auto const& branch) { return branch->can_evaluate_to(kind); }
+    );
+}
+
+bool Switch::_can_break_with(ElementKind kind) const {
+    if (this->value->can_break_with(kind)) {
+        return true;
+    }
+    if (this->value->diverges()) {
+        return false;
+    }
+    return std::any_of(
+        this->branches.begin(),
+        this->branches.end(),
+        [kind](auto const& branch) { return branch->can_break_with(kind); }
+    );
+}
+
+void Switch::_validate_no_free_break() const {
+    this->value->validate_no_free_break();
+    for (auto const& branch : this->branches) {
+        branch->validate_no_free_break();
+    }
+}
+
+void Switch::_validate_no_break_with_value() const {
+    this->value->validate_no_break_with_value();
+    for (auto const& branch : this->branches) {
+        branch->validate_no_break_with_value();
+    }
+}
+
+std::unique_ptr<Expression> Switch::clone() const {
+    std::vector<std::unique_ptr<Expression>> branches;
+    for (auto const& branch : this->branches) {
+        branches.push_back(branch->clone());
+    }
+    return std::make_unique<Switch>(
+        this->span, this->value->clone(), this->cases, std::move(branches)
+    );
+}
+
+std::unique_ptr<Expression>
+Switch::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->value);
+    for (auto& branch : this->branches) {
+        eliminator.eliminate(branch);
+    }
+
+    // Values relying on built-ins are left for constant folding to guard
+    BuiltInGuard guard;
+    auto value = this->value->constant(guard);
+    if (!value || !guard.empty()) {
+        return nullptr;
+    }
+    auto branch = this->select(*value);
+    if (!branch) {
+        return nullptr;
+    }
+
+    // The value and the branches it never picks
+    eliminator.remove(this->branches.size());
+    for (auto& taken : this->branches) {
+        if (taken.get() == branch) {
+            return std::move(taken);
+        }
+    }
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Switch::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->value);
+    for (auto& branch : this->branches) {
+        optimizer.fold_constants(branch);
+    }
+
+    BuiltInGuard guard;
+    auto value = this->value->constant(guard);
+    if (!value) {
+        return nullptr;
+    }
+    auto selected = this->select(*value);
+    if (!selected) {
+        return nullptr;
+    }
+
+    std::unique_ptr<Expression> fallback;
+    if (!guard.empty()) {
+        fallback = this->clone();
+    }
+
+    std::unique_ptr<Expression> branch;
+    for (auto& taken : this->branches) {
+        if (taken.get() == selected) {
+            branch = std::move(taken);
+        }
+    }
+    if (!fallback) {
+        return branch;
+    }
+    return std::make_unique<Guarded>(
+        std::move(guard), std::move(branch), std::move(fallback)
+    );
+}
+
+ast::Kinds Switch::infer_types(TypeInference& inference) {
+    inference.infer(this->value);
+
+    auto before = inference.save();
+    ast::Kinds kinds;
+    std::optional<decltype(before)> after;
+    for (auto& branch : this->branches) {
+        inference.restore(before);
+        kinds = kinds | inference.infer(branch);
+        if (after) {
+            inference.join(*after);
+        }
+        after = inference.save();
+    }
+
+    return kinds;
+}
+
+bool Switch::may_capture_scope() const {
+    if (this->value->may_capture_scope()) {
+        return true;
+    }
+    return std::any_of(
+        this->branches.begin(),
+        this->branches.end(),
+        [](auto const& branch) { return branch->may_capture_scope(); }
+    );
+}
+
+bool Switch::is_pure(PurityAnalysis& analysis) const {
+    if (!this->value->is_pure(analysis)) {
+        return false;
+    }
+    return std::all_of(
+        this->branches.begin(),
+        this->branches.end(),
+        [&analysis](auto const& branch) { return branch->is_pure(analysis); }
+    );
+}
+
+std::string Switch::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_switch(
+        *this->value, this->kind, this->cases, this->branches
+    );
+}
+
+bool Switch::hoist_invariants(LoopOptimizer& optimizer) {
+    bool invariant = optimizer.hoist(this->value);
+    for (auto& branch : this->branches) {
+        invariant = optimizer.hoist(branch) && invariant;
+    }
+    return invariant;
+}
+
+std::unique_ptr<Expression> Switch::unbox(Unboxer& unboxer) {
+    unboxer.unbox(this->value);
+    for (auto& branch : this->branches) {
+        unboxer.unbox(branch);
+    }
+    return nullptr;
+}
+
+void Switch::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->value);
+    for (auto& branch : this->branches) {
+        converter.convert(branch);
+    }
+}
+
+std::unique_ptr<Expression> Switch::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->value);
+    for (auto& branch : this->branches) {
+        inliner.inline_calls(branch);
+    }
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Switch::inline_copy(Inliner& inliner) const {
+    auto value = inliner.copy(*this->value);
+    if (!value) {
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<Expression>> branches;
+    for (auto const& branch : this->branches) {
+        auto copy = inliner.copy(*branch);
+        if (!copy) {
+            return nullptr;
+        }
+        branches.push_back(std::move(copy));
+    }
+    return std::make_unique<Switch>(
+        this->span, std::move(value), this->cases, std::move(branches)
+    );
+}
+
+std::unique_ptr<Expression>
+Switch::partial_copy(PartialEvaluator& evaluator) const {
+    auto value = evaluator.copy(*this->value);
+    if (!value) {
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<Expression>> branches;
+    for (auto const& branch : this->branches) {
+        auto copy = evaluator.copy(*branch);
+        if (!copy) {
+            return nullptr;
+        }
+        branches.push_back(std::move(copy));
+    }
+    return std::make_unique<Switch>(
+        this->span, std::move(value), this->cases, std::move(branches)
+    );
+}
+
+std::optional<std::string> Switch::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate(this->value);
+    for (auto& branch : this->branches) {
+        eliminator.eliminate(branch);
+    }
+    return std::nullopt;
+}
+
+} // namespace evaluator
@@ -1,10 +1,25 @@
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../expression.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
 Symbol::Symbol(std::shared_ptr<ast::Symbol> symbol)
     : Expression(symbol->span), symbol(symbol) {}
 
+std::shared_ptr<ast::Symbol> const& Symbol::variable() const {
+    return this->symbol;
+}
+
 ElementGuard Symbol::evaluate(EvaluationContext context) const {
     return context.garbage_collector->temporary(
         context.scope->lookup(*this->symbol)
@@ -15,11 +30,78 @@ void Symbol::display(std::ostream& stream, size_t depth) const {
     stream << this->symbol->display_verbose(depth);
 }
 
-bool Symbol::returns() const { return false; }
-bool Symbol::breaks() const { return false; }
-bool Symbol::can_evaluate_to(ast::ElementKind) const { return true; }
-bool Symbol::can_break_with(ast::ElementKind) const { return false; }
-void Symbol::validate_no_free_break() const {}
-void Symbol::validate_no_break_with_value() const {}
+bool Symbol::_returns() const { return false; }
+bool Symbol::_breaks() const { return false; }
+bool Symbol::_can_evaluate_to(ast::ElementKind) const { return true; }
+bool Symbol::_can_break_with(ast::ElementKind) const { return false; }
+void Symbol::_validate_no_free_break() const {}
+void Symbol::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> Symbol::clone() const {
+    return std::make_unique<Symbol>(this->symbol);
+}
+
+std::unique_ptr<Expression>
+Symbol::eliminate_dead_code(DeadCodeEliminator&) {
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Symbol::fold_constants(Optimizer&) {
+    return nullptr;
+}
+
+ast::Kinds Symbol::infer_types(TypeInference& inference) {
+    return inference.lookup(*this->symbol);
+}
+
+bool Symbol::may_capture_scope() const { return false; }
+
+bool Symbol::is_pure(PurityAnalysis& analysis) const {
+    return analysis.is_local(*this->symbol) ||
+           analysis.is_pure_function(*this->symbol);
+}
+
+ast::ElementKind Symbol::jit(JitCompiler& compiler) const {
+    return compiler.emit_read(*this->symbol);
+}
+
+std::string Symbol::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_read(*this->symbol);
+}
+
+bool Symbol::hoist_invariants(LoopOptimizer& optimizer) {
+    return optimizer.is_invariant(*this->symbol);
+}
+
+std::unique_ptr<Expression> Symbol::unbox(Unboxer& unboxer) {
+    return unboxer.read(this->symbol);
+}
+
+std::unique_ptr<Native>
+Symbol::unboxed(Unboxer& unboxer, ast::ElementKind kind) const {
+    return unboxer.native_read(*this->symbol, kind);
+}
+
+void Symbol::convert_closures(ClosureConverter& converter) {
+    converter.read(this->symbol);
+}
+
+std::unique_ptr<Expression> Symbol::inline_calls(Inliner&) { return nullptr; }
+
+std::unique_ptr<Expression> Symbol::inline_copy(Inliner& inliner) const {
+    // Other variables may resolve differently at the call site
+    return inliner.parameter(this->symbol);
+}
+
+std::unique_ptr<Expression>
+Symbol::partial_copy(PartialEvaluator& evaluator) const {
+    return evaluator.read(this->symbol);
+}
+
+std::optional<std::string> Symbol::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    return eliminator.read(*this->symbol);
+}
 
 } // namespace evaluator
@@ -0,0 +1,210 @@
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../dead_code.h"
+#include "../expression.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+using ast::Span;
+using utils::Depth;
+
+Unboxed::Unboxed(std::unique_ptr<Native> native)
+    : Expression(native->span), native(std::move(native)),
+      true_value(std::make_shared<ast::Boolean>(true, this->span)),
+      false_value(std::make_shared<ast::Boolean>(false, this->span)) {}
+
+ElementGuard Unboxed::evaluate(EvaluationContext context) const {
+    switch (this->native->kind) {
+    case ElementKind::INTEGER:
+        return context.garbage_collector->temporary(
+            this->boxes.integer(this->native->integer(), this->span)
+        );
+    case ElementKind::REAL:
+        return context.garbage_collector->temporary(
+            this->boxes.real(this->native->real(), this->span)
+        );
+    default:
+        return context.garbage_collector->temporary(
+            this->native->boolean() ? this->true_value : this->false_value
+        );
+    }
+}
+
+void Unboxed::display(std::ostream& stream, size_t depth) const {
+    stream << "Unboxed {\n";
+
+    stream << Depth(depth + 1) << "native = ";
+    this->native->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool Unboxed::_returns() const { return false; }
+bool Unboxed::_breaks() const { return false; }
+
+bool Unboxed::_can_evaluate_to(ElementKind kind) const {
+    return kind == this->native->kind;
+}
+
+bool Unboxed::_can_break_with(ElementKind) const { return false; }
+void Unboxed::_validate_no_free_break() const {}
+void Unboxed::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> Unboxed::clone() const {
+    return std::make_unique<Unboxed>(this->native->clone());
+}
+
+std::unique_ptr<Expression>
+Unboxed::eliminate_dead_code(DeadCodeEliminator&) {
+    return nullptr;
+}
+
+std::unique_ptr<Expression> Unboxed::fold_constants(Optimizer&) {
+    return nullptr;
+}
+
+ast::Kinds Unboxed::infer_types(TypeInference&) { return this->native->kind; }
+
+bool Unboxed::may_capture_scope() const { return false; }
+
+bool Unboxed::is_pure(PurityAnalysis&) const {
+    // Only reads local variables and calls pure built-ins
+    return true;
+}
+
+bool Unboxed::hoist_invariants(LoopOptimizer&) {
+    // Already cheaper than looking up an invariant
+    return false;
+}
+
+std::unique_ptr<Expression> Unboxed::unbox(Unboxer&) { return nullptr; }
+
+std::unique_ptr<Native> Unboxed::unboxed(Unboxer&, ElementKind kind) const {
+    if (kind != this->native->kind) {
+        return nullptr;
+    }
+    return this->native->clone();
+}
+
+UnboxedSetq::UnboxedSetq(
+    Span span, Slot* slot, std::unique_ptr<Native> initializer
+)
+    : Expression(span), slot(slot), initializer(std::move(initializer)) {}
+
+void UnboxedSetq::assign() const {
+    this->slot->initialized = true;
+    if (this->slot->kind == ElementKind::INTEGER) {
+        this->slot->integer = this->initializer->integer();
+    } else {
+        this->slot->real = this->initializer->real();
+    }
+}
+
+ElementGuard UnboxedSetq::evaluate(EvaluationContext context) const {
+    this->assign();
+    if (this->slot->kind == ElementKind::INTEGER) {
+        return context.garbage_collector->temporary(
+            this->boxes.integer(this->slot->integer, this->span)
+        );
+    }
+    return context.garbage_collector->temporary(
+        this->boxes.real(this->slot->real, this->span)
+    );
+}
+
+void UnboxedSetq::display(std::ostream& stream, size_t depth) const {
+    stream << "UnboxedSetq {\n";
+
+    stream << Depth(depth + 1)
+           << "variable = " << this->slot->variable->display_verbose(depth + 1)
+           << '\n';
+
+    stream << Depth(depth + 1) << "initializer = ";
+    this->initializer->display(stream, depth + 1);
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool UnboxedSetq::_returns() const { return false; }
+bool UnboxedSetq::_breaks() const { return false; }
+
+bool UnboxedSetq::_can_evaluate_to(ElementKind kind) const {
+    return kind == this->slot->kind;
+}
+
+bool UnboxedSetq::_can_break_with(ElementKind) const { return false; }
+void UnboxedSetq::_validate_no_free_break() const {}
+void UnboxedSetq::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> UnboxedSetq::clone() const {
+    return std::make_unique<UnboxedSetq>(
+        this->span, this->slot, this->initializer->clone()
+    );
+}
+
+std::unique_ptr<Expression>
+UnboxedSetq::eliminate_dead_code(DeadCodeEliminator&) {
+    return nullptr;
+}
+
+std::unique_ptr<Expression> UnboxedSetq::fold_constants(Optimizer&) {
+    return nullptr;
+}
+
+ast::Kinds UnboxedSetq::infer_types(TypeInference& inference) {
+    inference.assign(*this->slot->variable, this->slot->kind);
+    return this->slot->kind;
+}
+
+bool UnboxedSetq::may_capture_scope() const { return false; }
+
+bool UnboxedSetq::is_pure(PurityAnalysis&) const {
+    // Only variables of scopes no closure can reach are unboxed
+    return true;
+}
+
+bool UnboxedSetq::hoist_invariants(LoopOptimizer& optimizer) {
+    optimizer.assign(*this->slot->variable);
+    return false;
+}
+
+std::unique_ptr<Expression> UnboxedSetq::unbox(Unboxer&) { return nullptr; }
+
+void Unboxed::convert_closures(ClosureConverter&) {}
+
+void UnboxedSetq::convert_closures(ClosureConverter& converter) {
+    converter.assign(this->slot->variable);
+}
+
+std::unique_ptr<Expression> Unboxed::inline_calls(Inliner&) { return nullptr; }
+
+std::unique_ptr<Expression> UnboxedSetq::inline_calls(Inliner&) {
+    return nullptr;
+}
+
+std::optional<std::string> Unboxed::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator&
+) {
+    return std::nullopt;
+}
+
+std::optional<std::string> UnboxedSetq::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.assign(*this->slot->variable);
+    return std::nullopt;
+}
+
+} // namespace evaluator
@@ -0,0 +1,284 @@
+#include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
+#include "../control_flow.h"
+#include "../dead_code.h"
+#include "../error.h"
+#include "../expression.h"
+#include "../inliner.h"
+#include "../loop_optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+using ast::Span;
+using utils::Depth;
+
+UnboxedWhile::UnboxedWhile(
+    Span span,
+    std::vector<std::unique_ptr<Slot>> slots,
+    BuiltInGuard guard,
+    std::unique_ptr<Native> native_condition,
+    std::unique_ptr<Expression> condition,
+    Body body,
+    std::unique_ptr<Expression> fallback
+)
+    : Expression(span), slots(std::move(slots)), guard(std::move(guard)),
+      native_condition(std::move(native_condition)),
+      condition(std::move(condition)), body(std::move(body)),
+      fallback(std::move(fallback)),
+      result(std::make_shared<ast::Null>(span)) {
+    for (auto const& statement : this->body.body) {
+        this->assignments.push_back(
+            dynamic_cast<UnboxedSetq const*>(statement.get())
+        );
+    }
+}
+
+// Stores unboxed variables back into the scope when the loop exits, however it
+// exits.
+class SlotStore {
+    std::vector<std::unique_ptr<Slot>> const& slots;
+    Scope* scope;
+
+  public:
+    SlotStore(std::vector<std::unique_ptr<Slot>> const& slots, Scope* scope)
+        : slots(slots), scope(scope) {}
+
+    ~SlotStore() {
+        for (auto const& slot : this->slots) {
+            if (!slot->initialized) {
+                continue;
+            }
+
+            auto span = slot->variable->span;
+            if (slot->kind == ElementKind::INTEGER) {
+                this->scope->set_or_define(
+                    *slot->variable,
+                    std::make_shared<ast::Integer>(slot->integer, span)
+                );
+            } else {
+                this->scope->set_or_define(
+                    *slot->variable, std::make_shared<ast::Real>(slot->real, span)
+                );
+            }
+        }
+    }
+};
+
+ElementGuard UnboxedWhile::evaluate(EvaluationContext context) const {
+    if (!this->fallback) {
+        this->run(context);
+        return context.garbage_collector->temporary(this->result);
+    }
+
+    if (!this->guard.check(*context.scope)) {
+        return this->fallback->evaluate(context);
+    }
+
+    for (auto const& slot : this->slots) {
+        auto value = context.scope->lookup(*slot->variable);
+        slot->initialized = value->kind == slot->kind;
+        if (!slot->initialized) {
+            if (slot->read_before_assigned) {
+                return this->fallback->evaluate(context);
+            }
+            continue;
+        }
+
+        if (slot->kind == ElementKind::INTEGER) {
+            slot->integer = static_cast<ast::Integer const&>(*value).value;
+        } else {
+            slot->real = static_cast<ast::Real const&>(*value).value;
+        }
+    }
+
+    {
+        SlotStore store(this->slots, context.scope);
+        this->run(context);
+    }
+    return context.garbage_collector->temporary(this->result);
+}
+
+void UnboxedWhile::run(EvaluationContext context) const {
+    try {
+        while (true) {
+            if (this->native_condition) {
+                if (!this->native_condition->boolean()) {
+                    break;
+                }
+            } else {
+                auto condition = this->condition->evaluate(context);
+                if (condition.get()->kind != ElementKind::BOOLEAN) {
+                    throw EvaluationError("a boolean is expected", condition->span);
+                }
+                if (!static_cast<ast::Boolean const*>(condition.get())->value) {
+                    break;
+                }
+            }
+
+            auto const& body = this->body.body;
+            for (size_t index = 0; index < body.size(); ++index) {
+                if (auto assignment = this->assignments[index]) {
+                    assignment->assign();
+                } else {
+                    body[index]->evaluate(context);
+                }
+            }
+        }
+    } catch (BreakControlFlow&) {
+    }
+}
+
+void UnboxedWhile::display(std::ostream& stream, size_t depth) const {
+    stream << "UnboxedWhile {\n";
+
+    if (this->fallback) {
+        stream << Depth(depth + 1) << "assumes = ";
+        this->guard.display(stream);
+        stream << '\n';
+
+        stream << Depth(depth + 1) << "slots = [";
+        for (size_t index = 0; index < this->slots.size(); ++index) {
+            if (index > 0) {
+                stream << ", ";
+            }
+            stream << this->slots[index]->variable->value << ' '
+                   << this->slots[index]->kind;
+        }
+        stream << "]\n";
+    }
+
+    stream << Depth(depth + 1) << "condition = ";
+    if (this->native_condition) {
+        this->native_condition->display(stream, depth + 1);
+    } else {
+        this->condition->display(stream, depth + 1);
+    }
+    stream << '\n';
+
+    stream << Depth(depth + 1) << "body = ";
+    this->body.display(stream, depth + 1);
+    stream << '\n';
+
+    if (this->fallback) {
+        stream << Depth(depth + 1) << "fallback = ";
+        this->fallback->display(stream, depth + 1);
+        stream << '\n';
+    }
+
+    stream << Depth(depth + 1) << "span = " << this->span << '\n';
+
+    stream << Depth(depth) << '}';
+}
+
+bool UnboxedWhile::_returns() const {
+    if (this->native_condition) {
+        return false;
+    }
+    return this->condition->returns();
+}
+
+bool UnboxedWhile::_breaks() const { return false; }
+
+bool UnboxedWhile::_can_evaluate_to(ElementKind kind) const {
+    return kind == ElementKind::NULL_;
+}
+
+bool UnboxedWhile::_can_break_with(ElementKind) const { return false; }
+void UnboxedWhile::_validate_no_free_break() const {}
+void UnboxedWhile::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> UnboxedWhile::clone() const {
+    if (this->fallback) {
+        // The slots belong to this loop, so copies start from the original
+        return this->fallback->clone();
+    }
+
+    return std::make_unique<UnboxedWhile>(
+        this->span,
+        std::vector<std::unique_ptr<Slot>>(),
+        BuiltInGuard(),
+        this->native_condition ? this->native_condition->clone() : nullptr,
+        this->condition ? this->condition->clone() : nullptr,
+        this->body.clone(),
+        nullptr
+    );
+}
+
+std::unique_ptr<Expression>
+UnboxedWhile::eliminate_dead_code(DeadCodeEliminator&) {
+    // Statements of the body line up with the assignments found in them
+    return nullptr;
+}
+
+std::unique_ptr<Expression> UnboxedWhile::fold_constants(Optimizer&) {
+    return nullptr;
+}
+
+ast::Kinds UnboxedWhile::infer_types(TypeInference& inference) {
+    if (this->fallback) {
+        return inference.infer(this->fallback);
+    }
+    return ElementKind::NULL_;
+}
+
+bool UnboxedWhile::may_capture_scope() const {
+    // Loops that may are never unboxed
+    return false;
+}
+
+bool UnboxedWhile::is_pure(PurityAnalysis& analysis) const {
+    if (this->fallback) {
+        return this->fallback->is_pure(analysis);
+    }
+    // Nested loops only call pure built-ins and assign unboxed variables
+    return true;
+}
+
+bool UnboxedWhile::hoist_invariants(LoopOptimizer& optimizer) {
+    // Only the fallback is worth hoisting invariants from, and it assigns the
+    // same variables for loops around this one
+    if (this->fallback) {
+        optimizer.hoist(this->fallback);
+    }
+    return false;
+}
+
+std::unique_ptr<Expression> UnboxedWhile::unbox(Unboxer&) { return nullptr; }
+
+void UnboxedWhile::convert_closures(ClosureConverter& converter) {
+    // Unboxed loops create no closures, and only assign their slots
+    for (auto const& slot : this->slots) {
+        converter.assign(slot->variable);
+    }
+}
+
+std::unique_ptr<Expression> UnboxedWhile::inline_calls(Inliner&) {
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+UnboxedWhile::partial_copy(PartialEvaluator& evaluator) const {
+    // Loops nested in an unboxed one are copied from its fallback
+    if (!this->fallback) {
+        return nullptr;
+    }
+    return evaluator.copy(*this->fallback);
+}
+
+std::optional<std::string> UnboxedWhile::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    // Unboxed loops only call pure built-ins and assign their slots
+    for (auto const& slot : this->slots) {
+        eliminator.assign(*slot->variable);
+    }
+    return std::nullopt;
+}
+
+} // namespace evaluator
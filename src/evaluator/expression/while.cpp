@@ -1,7 +1,19 @@
 #include "../../utils.h"
+#include "../closure_conversion.h"
+#include "../common_subexpressions.h"
 #include "../control_flow.h"
+#include "../cpp_emitter.h"
+#include "../dead_code.h"
 #include "../error.h"
 #include "../expression.h"
+#include "../inliner.h"
+#include "../jit.h"
+#include "../loop_optimizer.h"
+#include "../optimizer.h"
+#include "../partial_evaluation.h"
+#include "../purity.h"
+#include "../type_inference.h"
+#include "../unboxing.h"
 
 namespace evaluator {
 
@@ -13,8 +25,30 @@ using utils::Depth;
 using utils::to_cons;
 
 While::While(Span span, std::unique_ptr<Expression> condition, Body body)
-    : Expression(span), condition(std::move(condition)), body(std::move(body)) {
-}
+    : Expression(span), condition(std::move(condition)), body(std::move(body)),
+      result(std::make_shared<Null>(span)) {}
+
+// Clears values of a loop's invariants while the loop runs, and restores them
+// afterwards in case the loop was entered again by a recursive call.
+class InvariantFrame {
+    std::vector<Invariant*> const& invariants;
+    std::vector<Invariant::Value> saved;
+
+  public:
+    InvariantFrame(std::vector<Invariant*> const& invariants)
+        : invariants(invariants) {
+        this->saved.reserve(invariants.size());
+        for (auto invariant : invariants) {
+            this->saved.push_back(invariant->reset());
+        }
+    }
+
+    ~InvariantFrame() {
+        for (size_t index = 0; index < this->invariants.size(); ++index) {
+            this->invariants[index]->restore(std::move(this->saved[index]));
+        }
+    }
+};
 
 std::unique_ptr<While>
 While::parse(Span span, std::shared_ptr<List> arguments) {
@@ -40,6 +74,7 @@ While::parse(Span span, std::shared_ptr<List> arguments) {
 }
 
 ElementGuard While::evaluate(EvaluationContext context) const {
+    InvariantFrame invariants(this->invariants);
     try {
         while (true) {
             auto condition = this->condition->evaluate(context);
@@ -59,9 +94,7 @@ ElementGuard While::evaluate(EvaluationContext context) const {
     } catch (BreakControlFlow&) {
     }
 
-    return context.garbage_collector->temporary(
-        std::make_shared<Null>(this->span)
-    );
+    return context.garbage_collector->temporary(this->result);
 }
 
 void While::display(std::ostream& stream, size_t depth) const {
@@ -80,13 +113,100 @@ void While::display(std::ostream& stream, size_t depth) const {
     stream << Depth(depth) << '}';
 }
 
-bool While::returns() const { return this->condition->returns(); }
-bool While::breaks() const { return false; }
-bool While::can_evaluate_to(ast::ElementKind kind) const {
+bool While::_returns() const { return this->condition->returns(); }
+bool While::_breaks() const { return false; }
+bool While::_can_evaluate_to(ast::ElementKind kind) const {
     return kind == ast::ElementKind::NULL_;
 }
-bool While::can_break_with(ast::ElementKind) const { return false; }
-void While::validate_no_free_break() const {}
-void While::validate_no_break_with_value() const {}
+bool While::_can_break_with(ast::ElementKind) const { return false; }
+void While::_validate_no_free_break() const {}
+void While::_validate_no_break_with_value() const {}
+
+std::unique_ptr<Expression> While::clone() const {
+    return std::make_unique<While>(
+        this->span, this->condition->clone(), this->body.clone()
+    );
+}
+
+std::unique_ptr<Expression>
+While::eliminate_dead_code(DeadCodeEliminator& eliminator) {
+    eliminator.eliminate(this->condition);
+    eliminator.eliminate(this->body);
+    return nullptr;
+}
+
+std::unique_ptr<Expression> While::fold_constants(Optimizer& optimizer) {
+    optimizer.fold_constants(this->condition);
+    optimizer.fold_constants(this->body);
+    return nullptr;
+}
+
+ast::Kinds While::infer_types(TypeInference& inference) {
+    return inference.infer_loop(this->condition, this->body);
+}
+
+bool While::may_capture_scope() const {
+    return this->condition->may_capture_scope() ||
+           this->body.may_capture_scope();
+}
+
+bool While::is_pure(PurityAnalysis& analysis) const {
+    return this->condition->is_pure(analysis) && this->body.is_pure(analysis);
+}
+
+ast::ElementKind While::jit(JitCompiler& compiler) const {
+    return compiler.emit_loop(*this->condition, this->body);
+}
+
+std::string While::emit_cpp(CppEmitter& emitter) const {
+    return emitter.emit_loop(*this->condition, this->body, *this->result);
+}
+
+bool While::hoist_invariants(LoopOptimizer& optimizer) {
+    bool rewriting = optimizer.is_rewriting();
+    auto invariants = optimizer.hoist_loop(this->condition, this->body);
+    if (rewriting) {
+        this->invariants = std::move(invariants);
+    }
+    return false;
+}
+
+std::unique_ptr<Expression> While::unbox(Unboxer& unboxer) {
+    return unboxer.unbox_loop(*this, this->condition, this->body);
+}
+
+void While::convert_closures(ClosureConverter& converter) {
+    converter.convert(this->condition);
+    converter.convert(this->body);
+}
+
+std::unique_ptr<Expression> While::inline_calls(Inliner& inliner) {
+    inliner.inline_calls(this->condition);
+    inliner.inline_calls(this->body);
+    return nullptr;
+}
+
+std::unique_ptr<Expression>
+While::partial_copy(PartialEvaluator& evaluator) const {
+    auto condition = evaluator.copy(*this->condition);
+    if (!condition) {
+        return nullptr;
+    }
+
+    auto body = evaluator.copy(this->body);
+    if (!body) {
+        return nullptr;
+    }
+    return std::make_unique<While>(
+        this->span, std::move(condition), std::move(*body)
+    );
+}
+
+std::optional<std::string> While::eliminate_common_subexpressions(
+    CommonSubexpressionEliminator& eliminator
+) {
+    eliminator.eliminate_loop(this->condition, this->body);
+    return std::nullopt;
+}
 
 } // namespace evaluator
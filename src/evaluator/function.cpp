@@ -8,14 +8,20 @@ using ast::Position;
 using ast::Span;
 
 CallFrame::CallFrame(
-    std::vector<std::shared_ptr<Element>> arguments,
+    std::span<std::shared_ptr<Element> const> arguments,
     Span call_site,
     EvaluationContext context
 )
-    : arguments(std::move(arguments)), call_site(call_site), context(context) {}
+    : arguments(arguments), call_site(call_site), context(context) {}
 
 Function::Function(ast::Span span) : Element(ElementKind::FUNCTION, span) {}
 
+bool Function::is_pure() const { return false; }
+
+ast::Kinds Function::result_kinds(std::vector<ast::Kinds> const&) const {
+    return ast::Kinds::all();
+}
+
 void Function::_display_pretty(std::ostream& stream) const {
     auto name = this->name();
     stream << "#(";
@@ -30,7 +36,15 @@ void Function::_display_pretty(std::ostream& stream) const {
 }
 
 BuiltInFunction::BuiltInFunction()
-    : Function(Span(Position(0, 0), Position(0, 0))) {}
+    : Function(Span(Position(0, 0), Position(0, 0))),
+      true_value(std::make_shared<ast::Boolean>(true, this->span)),
+      false_value(std::make_shared<ast::Boolean>(false, this->span)) {}
+
+std::shared_ptr<ast::Element> BuiltInFunction::boolean(bool value) const {
+    return value ? this->true_value : this->false_value;
+}
+
+bool BuiltInFunction::is_pure() const { return true; }
 
 void BuiltInFunction::_display_verbose(std::ostream& stream, size_t) const {
     stream << "BuiltInFunction(" << this->name() << ", " << this->span << ")";
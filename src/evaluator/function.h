@@ -1,17 +1,25 @@
+#pragma once
+
 #include "../ast/element.h"
 #include "expression.h"
+#include "memoization.h"
+#include "parse_cache.h"
 #include "scope.h"
 
 namespace evaluator {
 
+class NativeFunction;
+class OptimizationJob;
+
 class CallFrame {
   public:
-    std::vector<std::shared_ptr<ast::Element>> arguments;
+    // Borrowed from the caller, usually from an `ArgumentWindow`
+    std::span<std::shared_ptr<ast::Element> const> arguments;
     ast::Span call_site;
     EvaluationContext context;
 
     CallFrame(
-        std::vector<std::shared_ptr<ast::Element>> arguments,
+        std::span<std::shared_ptr<ast::Element> const> arguments,
         ast::Span call_site,
         EvaluationContext context
     );
@@ -23,6 +31,16 @@ class Function : public ast::Element {
 
     virtual ElementGuard call(CallFrame frame) const = 0;
 
+    // Whether calling the function has no effects besides computing its result
+    // from the arguments, so calls with known arguments may be folded.
+    virtual bool is_pure() const;
+    // Kinds of values the function may return given the kinds of arguments.
+    // An empty set means that the call always fails.
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
+
+    friend class TypeProfile;
+
   protected:
     virtual std::string_view name() const = 0;
     virtual void display_parameters(std::ostream& stream) const = 0;
@@ -31,22 +49,60 @@ class Function : public ast::Element {
 
 class UserDefinedFunction : public Function {
     Parameters parameters;
-    std::shared_ptr<Body> body;
+    mutable std::shared_ptr<Body> body;
     std::weak_ptr<Scope> scope;
+    // The scope of a converted closure, which only the function refers to
+    std::shared_ptr<Scope> captured;
+
+    mutable bool pure = false;
+    mutable uint64_t purity_version = 0;
+    mutable std::unique_ptr<MemoTable> memo_table;
+
+    // Set while the function may still be compiled or optimized in the
+    // background
+    mutable std::shared_ptr<Func const> source;
+    mutable size_t calls = 0;
+    // Kinds of the arguments of calls so far, by position, until compiled
+    mutable std::vector<ast::Kinds> argument_kinds;
+    mutable std::shared_ptr<NativeFunction> native;
+    mutable std::shared_ptr<OptimizationJob> optimization;
+    // Bodies replaced by optimized ones, which calls in progress may still be
+    // evaluating
+    mutable std::vector<std::shared_ptr<Body>> replaced;
+
+    ElementGuard invoke(CallFrame const& frame) const;
+    // Counts a call, compiles the function once it is hot, and switches to
+    // the optimized body once it is ready.
+    void tier_up(CallFrame const& frame) const;
 
   public:
     UserDefinedFunction(
         ast::Span span,
         Parameters parameters,
         std::shared_ptr<Body> body,
-        std::weak_ptr<Scope> scope
+        std::weak_ptr<Scope> scope,
+        std::shared_ptr<Scope> captured = nullptr
     );
 
     virtual ElementGuard call(CallFrame frame) const;
+    virtual bool is_pure() const;
+    // Whether calling the function evaluates `body`, which makes it a function
+    // created from the same definition.
+    bool has_body(Body const& body) const;
+    // Lets `Jit` compile and `BackgroundOptimizer` optimize a copy of
+    // `source`, the definition of the function, once it is hot.
+    void optimize_when_hot(std::shared_ptr<Func const> source);
 
     friend class ScopeVisitor;
+    friend class PartialEvaluator;
+    friend class PurityAnalysis;
+    friend class MemoizedFunction;
+    friend class SpecializedFunction;
 
   protected:
+    // Whether results of calls are cached while the function is pure.
+    virtual bool memoizes() const;
+
     virtual void display_parameters(std::ostream& stream) const;
     virtual void _display_verbose(std::ostream& stream, size_t depth) const = 0;
 };
@@ -58,7 +114,8 @@ class FuncFunction : public UserDefinedFunction {
         std::string name,
         Parameters parameters,
         std::shared_ptr<Body> body,
-        std::weak_ptr<Scope> scope
+        std::weak_ptr<Scope> scope,
+        std::shared_ptr<Scope> captured = nullptr
     );
 
   protected:
@@ -75,7 +132,40 @@ class LambdaFunction : public UserDefinedFunction {
         ast::Span span,
         Parameters parameters,
         std::shared_ptr<Body> body,
-        std::weak_ptr<Scope> scope
+        std::weak_ptr<Scope> scope,
+        std::shared_ptr<Scope> captured = nullptr
+    );
+
+  protected:
+    virtual void _display_verbose(std::ostream& stream, size_t depth) const;
+    virtual std::string_view name() const;
+};
+
+// A user-defined function returned by `memo`, which caches its results.
+class MemoizedFunction : public UserDefinedFunction {
+    std::shared_ptr<UserDefinedFunction> function;
+
+  public:
+    MemoizedFunction(std::shared_ptr<UserDefinedFunction> function);
+
+  protected:
+    virtual bool memoizes() const;
+    virtual void _display_verbose(std::ostream& stream, size_t depth) const;
+    virtual std::string_view name() const;
+};
+
+// A user-defined function returned by `specialize`, whose leading parameters
+// are bound to known values. The values are defined in `scope`, under the
+// scope of the original function.
+class SpecializedFunction : public UserDefinedFunction {
+    std::shared_ptr<UserDefinedFunction> function;
+
+  public:
+    SpecializedFunction(
+        std::shared_ptr<UserDefinedFunction> function,
+        Parameters parameters,
+        std::shared_ptr<Body> body,
+        std::shared_ptr<Scope> scope
     );
 
   protected:
@@ -84,9 +174,18 @@ class LambdaFunction : public UserDefinedFunction {
 };
 
 class BuiltInFunction : public Function {
+    std::shared_ptr<ast::Boolean> true_value;
+    std::shared_ptr<ast::Boolean> false_value;
+
   public:
     BuiltInFunction();
 
+    virtual bool is_pure() const;
+
+  protected:
+    // Returns a boolean element shared by all calls.
+    std::shared_ptr<ast::Element> boolean(bool value) const;
+
   private:
     virtual void _display_verbose(std::ostream& stream, size_t depth) const;
 };
@@ -95,6 +194,8 @@ class PlusFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   private:
     virtual std::string_view name() const;
@@ -105,6 +206,8 @@ class TimesFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   private:
     virtual std::string_view name() const;
@@ -115,6 +218,8 @@ class MinusFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   private:
     virtual std::string_view name() const;
@@ -125,6 +230,8 @@ class DivideFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   private:
     virtual std::string_view name() const;
@@ -145,6 +252,8 @@ class TailFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -155,6 +264,8 @@ class ConsFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -162,9 +273,34 @@ class ConsFunction : public BuiltInFunction {
 };
 
 class EvalFunction : public BuiltInFunction {
+    mutable ParseCache cache;
+
+  public:
+    using BuiltInFunction::BuiltInFunction;
+    virtual ElementGuard call(CallFrame frame) const;
+    virtual bool is_pure() const;
+
+  protected:
+    virtual std::string_view name() const;
+    virtual void display_parameters(std::ostream& stream) const;
+};
+
+class MemoFunction : public BuiltInFunction {
+  public:
+    using BuiltInFunction::BuiltInFunction;
+    virtual ElementGuard call(CallFrame frame) const;
+    virtual bool is_pure() const;
+
+  protected:
+    virtual std::string_view name() const;
+    virtual void display_parameters(std::ostream& stream) const;
+};
+
+class SpecializeFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual bool is_pure() const;
 
   protected:
     virtual std::string_view name() const;
@@ -175,6 +311,8 @@ class EqualFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -185,6 +323,8 @@ class NonequalFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -195,6 +335,8 @@ class LessFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -205,6 +347,8 @@ class LesseqFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -215,6 +359,8 @@ class GreaterFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -225,6 +371,8 @@ class GreatereqFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -235,6 +383,8 @@ class IsIntFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
     virtual std::string_view name() const;
     virtual void display_parameters(std::ostream& stream) const;
@@ -244,6 +394,8 @@ class IsRealFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -254,6 +406,8 @@ class IsBoolFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -264,6 +418,8 @@ class IsNullFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -274,6 +430,8 @@ class IsAtomFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -284,6 +442,8 @@ class IsListFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -294,6 +454,8 @@ class IsFuncFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -304,6 +466,8 @@ class AndFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -314,6 +478,8 @@ class OrFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -324,6 +490,8 @@ class XorFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -334,6 +502,8 @@ class NotFunction : public BuiltInFunction {
   public:
     using BuiltInFunction::BuiltInFunction;
     virtual ElementGuard call(CallFrame frame) const;
+    virtual ast::Kinds result_kinds(std::vector<ast::Kinds> const& arguments
+    ) const;
 
   protected:
     virtual std::string_view name() const;
@@ -11,11 +11,11 @@ namespace evaluator {
 using ast::Element;
 using ast::ElementKind;
 
-std::optional<double> cast_to_double(std::shared_ptr<Element> element) {
-    if (auto integer = std::dynamic_pointer_cast<ast::Integer>(element)) {
-        return integer->value;
-    } else if (auto real = std::dynamic_pointer_cast<ast::Real>(element)) {
-        return real->value;
+std::optional<double> cast_to_double(Element const& element) {
+    if (element.kind == ElementKind::INTEGER) {
+        return static_cast<ast::Integer const&>(element).value;
+    } else if (element.kind == ElementKind::REAL) {
+        return static_cast<ast::Real const&>(element).value;
     } else {
         return std::nullopt;
     }
@@ -26,18 +26,18 @@ std::shared_ptr<Element> evaluate_arithmetic_operation(
     std::function<int64_t(int64_t, int64_t)> operation_int,
     std::function<double(double, double)> operation_double
 ) {
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
     if (a_element->kind == ElementKind::INTEGER &&
         b_element->kind == ElementKind::INTEGER) {
-        auto a_integer = std::dynamic_pointer_cast<ast::Integer>(a_element);
-        auto b_integer = std::dynamic_pointer_cast<ast::Integer>(b_element);
+        auto a_integer = static_cast<ast::Integer const*>(a_element.get());
+        auto b_integer = static_cast<ast::Integer const*>(b_element.get());
         return std::make_shared<ast::Integer>(
             operation_int(a_integer->value, b_integer->value), frame.call_site
         );
     }
-    auto a = cast_to_double(a_element);
-    auto b = cast_to_double(b_element);
+    auto a = cast_to_double(*a_element);
+    auto b = cast_to_double(*b_element);
 
     if (!(a && b)) {
         return nullptr;
@@ -48,6 +48,26 @@ std::shared_ptr<Element> evaluate_arithmetic_operation(
     );
 }
 
+ast::Kinds arithmetic_result_kinds(std::vector<ast::Kinds> const& arguments) {
+    if (arguments.size() != 2) {
+        return ast::Kinds();
+    }
+
+    ast::Kinds numbers = ast::Kinds(ElementKind::INTEGER) | ElementKind::REAL;
+    auto a = arguments[0] & numbers;
+    auto b = arguments[1] & numbers;
+
+    ast::Kinds result;
+    if (a.contains(ElementKind::INTEGER) && b.contains(ElementKind::INTEGER)) {
+        result = result | ElementKind::INTEGER;
+    }
+    if ((a.contains(ElementKind::REAL) && !b.empty()) ||
+        (b.contains(ElementKind::REAL) && !a.empty())) {
+        result = result | ElementKind::REAL;
+    }
+    return result;
+}
+
 ElementGuard PlusFunction::call(CallFrame frame) const {
     if (frame.arguments.size() != 2) {
         throw EvaluationError(
@@ -70,6 +90,11 @@ ElementGuard PlusFunction::call(CallFrame frame) const {
     );
 }
 
+ast::Kinds PlusFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return arithmetic_result_kinds(arguments);
+}
+
 std::string_view PlusFunction::name() const { return "plus"; }
 void PlusFunction::display_parameters(std::ostream& stream) const {
     stream << "a b";
@@ -97,6 +122,11 @@ ElementGuard TimesFunction::call(CallFrame frame) const {
     );
 }
 
+ast::Kinds TimesFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return arithmetic_result_kinds(arguments);
+}
+
 std::string_view TimesFunction::name() const { return "times"; }
 void TimesFunction::display_parameters(std::ostream& stream) const {
     stream << "a b";
@@ -124,6 +154,11 @@ ElementGuard MinusFunction::call(CallFrame frame) const {
     );
 }
 
+ast::Kinds MinusFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return arithmetic_result_kinds(arguments);
+}
+
 std::string_view MinusFunction::name() const { return "minus"; }
 void MinusFunction::display_parameters(std::ostream& stream) const {
     stream << "a b";
@@ -156,6 +191,11 @@ ElementGuard DivideFunction::call(CallFrame frame) const {
     );
 }
 
+ast::Kinds DivideFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return arithmetic_result_kinds(arguments);
+}
+
 std::string_view DivideFunction::name() const { return "divide"; }
 void DivideFunction::display_parameters(std::ostream& stream) const {
     stream << "a b";
@@ -7,6 +7,19 @@ namespace evaluator {
 using ast::Element;
 using ast::ElementKind;
 
+ast::Kinds comparison_result_kinds(std::vector<ast::Kinds> const& arguments) {
+    if (arguments.size() != 2) {
+        return ast::Kinds();
+    }
+
+    ast::Kinds comparable = ast::Kinds(ElementKind::INTEGER) |
+                            ElementKind::REAL | ElementKind::BOOLEAN;
+    if ((arguments[0] & arguments[1] & comparable).empty()) {
+        return ast::Kinds();
+    }
+    return ElementKind::BOOLEAN;
+}
+
 ElementGuard EqualFunction::call(CallFrame frame) const {
     if (frame.arguments.size() != 2) {
         throw EvaluationError(
@@ -16,25 +29,25 @@ ElementGuard EqualFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
 
     bool result;
 
     if (a_element->kind == ElementKind::REAL &&
         b_element->kind == ElementKind::REAL) {
-        auto a_real = std::dynamic_pointer_cast<ast::Real>(a_element);
-        auto b_real = std::dynamic_pointer_cast<ast::Real>(b_element);
+        auto a_real = static_cast<ast::Real const*>(a_element.get());
+        auto b_real = static_cast<ast::Real const*>(b_element.get());
 
         result = a_real->value == b_real->value;
     } else if (a_element->kind == ElementKind::INTEGER && b_element->kind == ElementKind::INTEGER) {
-        auto a_int = std::dynamic_pointer_cast<ast::Integer>(a_element);
-        auto b_int = std::dynamic_pointer_cast<ast::Integer>(b_element);
+        auto a_int = static_cast<ast::Integer const*>(a_element.get());
+        auto b_int = static_cast<ast::Integer const*>(b_element.get());
 
         result = a_int->value == b_int->value;
     } else if (a_element->kind == ElementKind::BOOLEAN && b_element->kind == ElementKind::BOOLEAN) {
-        auto a_bool = std::dynamic_pointer_cast<ast::Boolean>(a_element);
-        auto b_bool = std::dynamic_pointer_cast<ast::Boolean>(b_element);
+        auto a_bool = static_cast<ast::Boolean const*>(a_element.get());
+        auto b_bool = static_cast<ast::Boolean const*>(b_element.get());
 
         result = a_bool->value == b_bool->value;
     } else {
@@ -45,9 +58,12 @@ ElementGuard EqualFunction::call(CallFrame frame) const {
         );
     }
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds EqualFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return comparison_result_kinds(arguments);
 }
 
 std::string_view EqualFunction::name() const { return "equal"; }
@@ -65,25 +81,25 @@ ElementGuard NonequalFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
 
     bool result;
 
     if (a_element->kind == ElementKind::REAL &&
         b_element->kind == ElementKind::REAL) {
-        auto a_real = std::dynamic_pointer_cast<ast::Real>(a_element);
-        auto b_real = std::dynamic_pointer_cast<ast::Real>(b_element);
+        auto a_real = static_cast<ast::Real const*>(a_element.get());
+        auto b_real = static_cast<ast::Real const*>(b_element.get());
 
         result = a_real->value != b_real->value;
     } else if (a_element->kind == ElementKind::INTEGER && b_element->kind == ElementKind::INTEGER) {
-        auto a_int = std::dynamic_pointer_cast<ast::Integer>(a_element);
-        auto b_int = std::dynamic_pointer_cast<ast::Integer>(b_element);
+        auto a_int = static_cast<ast::Integer const*>(a_element.get());
+        auto b_int = static_cast<ast::Integer const*>(b_element.get());
 
         result = a_int->value != b_int->value;
     } else if (a_element->kind == ElementKind::BOOLEAN && b_element->kind == ElementKind::BOOLEAN) {
-        auto a_bool = std::dynamic_pointer_cast<ast::Boolean>(a_element);
-        auto b_bool = std::dynamic_pointer_cast<ast::Boolean>(b_element);
+        auto a_bool = static_cast<ast::Boolean const*>(a_element.get());
+        auto b_bool = static_cast<ast::Boolean const*>(b_element.get());
 
         result = a_bool->value != b_bool->value;
     } else {
@@ -94,9 +110,12 @@ ElementGuard NonequalFunction::call(CallFrame frame) const {
         );
     }
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds NonequalFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return comparison_result_kinds(arguments);
 }
 
 std::string_view NonequalFunction::name() const { return "nonequal"; }
@@ -114,25 +133,25 @@ ElementGuard LessFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
 
     bool result;
 
     if (a_element->kind == ElementKind::REAL &&
         b_element->kind == ElementKind::REAL) {
-        auto a_real = std::dynamic_pointer_cast<ast::Real>(a_element);
-        auto b_real = std::dynamic_pointer_cast<ast::Real>(b_element);
+        auto a_real = static_cast<ast::Real const*>(a_element.get());
+        auto b_real = static_cast<ast::Real const*>(b_element.get());
 
         result = a_real->value < b_real->value;
     } else if (a_element->kind == ElementKind::INTEGER && b_element->kind == ElementKind::INTEGER) {
-        auto a_int = std::dynamic_pointer_cast<ast::Integer>(a_element);
-        auto b_int = std::dynamic_pointer_cast<ast::Integer>(b_element);
+        auto a_int = static_cast<ast::Integer const*>(a_element.get());
+        auto b_int = static_cast<ast::Integer const*>(b_element.get());
 
         result = a_int->value < b_int->value;
     } else if (a_element->kind == ElementKind::BOOLEAN && b_element->kind == ElementKind::BOOLEAN) {
-        auto a_bool = std::dynamic_pointer_cast<ast::Boolean>(a_element);
-        auto b_bool = std::dynamic_pointer_cast<ast::Boolean>(b_element);
+        auto a_bool = static_cast<ast::Boolean const*>(a_element.get());
+        auto b_bool = static_cast<ast::Boolean const*>(b_element.get());
 
         result = a_bool->value < b_bool->value;
     } else {
@@ -143,9 +162,12 @@ ElementGuard LessFunction::call(CallFrame frame) const {
         );
     }
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds LessFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return comparison_result_kinds(arguments);
 }
 
 std::string_view LessFunction::name() const { return "less"; }
@@ -163,25 +185,25 @@ ElementGuard LesseqFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
 
     bool result;
 
     if (a_element->kind == ElementKind::REAL &&
         b_element->kind == ElementKind::REAL) {
-        auto a_real = std::dynamic_pointer_cast<ast::Real>(a_element);
-        auto b_real = std::dynamic_pointer_cast<ast::Real>(b_element);
+        auto a_real = static_cast<ast::Real const*>(a_element.get());
+        auto b_real = static_cast<ast::Real const*>(b_element.get());
 
         result = a_real->value <= b_real->value;
     } else if (a_element->kind == ElementKind::INTEGER && b_element->kind == ElementKind::INTEGER) {
-        auto a_int = std::dynamic_pointer_cast<ast::Integer>(a_element);
-        auto b_int = std::dynamic_pointer_cast<ast::Integer>(b_element);
+        auto a_int = static_cast<ast::Integer const*>(a_element.get());
+        auto b_int = static_cast<ast::Integer const*>(b_element.get());
 
         result = a_int->value <= b_int->value;
     } else if (a_element->kind == ElementKind::BOOLEAN && b_element->kind == ElementKind::BOOLEAN) {
-        auto a_bool = std::dynamic_pointer_cast<ast::Boolean>(a_element);
-        auto b_bool = std::dynamic_pointer_cast<ast::Boolean>(b_element);
+        auto a_bool = static_cast<ast::Boolean const*>(a_element.get());
+        auto b_bool = static_cast<ast::Boolean const*>(b_element.get());
 
         result = a_bool->value <= b_bool->value;
     } else {
@@ -192,9 +214,12 @@ ElementGuard LesseqFunction::call(CallFrame frame) const {
         );
     }
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds LesseqFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return comparison_result_kinds(arguments);
 }
 
 std::string_view LesseqFunction::name() const { return "lesseq"; }
@@ -212,25 +237,25 @@ ElementGuard GreaterFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
 
     bool result;
 
     if (a_element->kind == ElementKind::REAL &&
         b_element->kind == ElementKind::REAL) {
-        auto a_real = std::dynamic_pointer_cast<ast::Real>(a_element);
-        auto b_real = std::dynamic_pointer_cast<ast::Real>(b_element);
+        auto a_real = static_cast<ast::Real const*>(a_element.get());
+        auto b_real = static_cast<ast::Real const*>(b_element.get());
 
         result = a_real->value > b_real->value;
     } else if (a_element->kind == ElementKind::INTEGER && b_element->kind == ElementKind::INTEGER) {
-        auto a_int = std::dynamic_pointer_cast<ast::Integer>(a_element);
-        auto b_int = std::dynamic_pointer_cast<ast::Integer>(b_element);
+        auto a_int = static_cast<ast::Integer const*>(a_element.get());
+        auto b_int = static_cast<ast::Integer const*>(b_element.get());
 
         result = a_int->value > b_int->value;
     } else if (a_element->kind == ElementKind::BOOLEAN && b_element->kind == ElementKind::BOOLEAN) {
-        auto a_bool = std::dynamic_pointer_cast<ast::Boolean>(a_element);
-        auto b_bool = std::dynamic_pointer_cast<ast::Boolean>(b_element);
+        auto a_bool = static_cast<ast::Boolean const*>(a_element.get());
+        auto b_bool = static_cast<ast::Boolean const*>(b_element.get());
 
         result = a_bool->value > b_bool->value;
     } else {
@@ -241,9 +266,12 @@ ElementGuard GreaterFunction::call(CallFrame frame) const {
         );
     }
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds GreaterFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return comparison_result_kinds(arguments);
 }
 
 std::string_view GreaterFunction::name() const { return "greater"; }
@@ -261,25 +289,25 @@ ElementGuard GreatereqFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
 
     bool result;
 
     if (a_element->kind == ElementKind::REAL &&
         b_element->kind == ElementKind::REAL) {
-        auto a_real = std::dynamic_pointer_cast<ast::Real>(a_element);
-        auto b_real = std::dynamic_pointer_cast<ast::Real>(b_element);
+        auto a_real = static_cast<ast::Real const*>(a_element.get());
+        auto b_real = static_cast<ast::Real const*>(b_element.get());
 
         result = a_real->value >= b_real->value;
     } else if (a_element->kind == ElementKind::INTEGER && b_element->kind == ElementKind::INTEGER) {
-        auto a_int = std::dynamic_pointer_cast<ast::Integer>(a_element);
-        auto b_int = std::dynamic_pointer_cast<ast::Integer>(b_element);
+        auto a_int = static_cast<ast::Integer const*>(a_element.get());
+        auto b_int = static_cast<ast::Integer const*>(b_element.get());
 
         result = a_int->value >= b_int->value;
     } else if (a_element->kind == ElementKind::BOOLEAN && b_element->kind == ElementKind::BOOLEAN) {
-        auto a_bool = std::dynamic_pointer_cast<ast::Boolean>(a_element);
-        auto b_bool = std::dynamic_pointer_cast<ast::Boolean>(b_element);
+        auto a_bool = static_cast<ast::Boolean const*>(a_element.get());
+        auto b_bool = static_cast<ast::Boolean const*>(b_element.get());
 
         result = a_bool->value >= b_bool->value;
     } else {
@@ -290,9 +318,12 @@ ElementGuard GreatereqFunction::call(CallFrame frame) const {
         );
     }
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds GreatereqFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return comparison_result_kinds(arguments);
 }
 
 std::string_view GreatereqFunction::name() const { return "greatereq"; }
@@ -13,10 +13,20 @@ ElementGuard EvalFunction::call(CallFrame frame) const {
         );
     }
 
-    auto expression = Expression::parse(frame.arguments[0]);
+    auto expression = this->cache.parse(frame.arguments[0]);
+
+    // The code may assign variables of the caller, also when `eval` is called
+    // under another name, so values cached in `Invariant`s and `Common`s until
+    // `Scope::version` changes must be computed again
+    struct Invalidate {
+        ~Invalidate() { ++Scope::version; }
+    } invalidate;
     return expression->evaluate(frame.context);
 }
 
+// Evaluated code can do anything
+bool EvalFunction::is_pure() const { return false; }
+
 std::string_view EvalFunction::name() const { return "eval"; }
 void EvalFunction::display_parameters(std::ostream& stream) const {
     stream << "program";
@@ -5,6 +5,7 @@ namespace evaluator {
 
 using ast::Cons;
 using ast::Element;
+using ast::ElementKind;
 using ast::List;
 using ast::Null;
 
@@ -16,7 +17,7 @@ ElementGuard HeadFunction::call(CallFrame frame) const {
             frame.call_site
         );
     }
-    auto list = frame.arguments[0];
+    auto const& list = frame.arguments[0];
 
     if (auto cons = std::dynamic_pointer_cast<Cons>(list)) {
         return frame.context.garbage_collector->temporary(cons->left);
@@ -44,7 +45,7 @@ ElementGuard TailFunction::call(CallFrame frame) const {
             frame.call_site
         );
     }
-    auto list = frame.arguments[0];
+    auto const& list = frame.arguments[0];
 
     if (auto cons = std::dynamic_pointer_cast<Cons>(list)) {
         return frame.context.garbage_collector->temporary(cons->right);
@@ -59,6 +60,14 @@ ElementGuard TailFunction::call(CallFrame frame) const {
     );
 }
 
+ast::Kinds TailFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    if (arguments.size() != 1) {
+        return ast::Kinds();
+    }
+    return ast::Kinds(ElementKind::NULL_) | ElementKind::CONS;
+}
+
 std::string_view TailFunction::name() const { return "tail"; }
 void TailFunction::display_parameters(std::ostream& stream) const {
     stream << "list";
@@ -73,7 +82,7 @@ ElementGuard ConsFunction::call(CallFrame frame) const {
         );
     }
 
-    auto left = frame.arguments[0];
+    auto const& left = frame.arguments[0];
     auto right = std::dynamic_pointer_cast<List>(frame.arguments[1]);
     if (!right) {
         throw EvaluationError(
@@ -86,6 +95,14 @@ ElementGuard ConsFunction::call(CallFrame frame) const {
     );
 }
 
+ast::Kinds ConsFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    if (arguments.size() != 2) {
+        return ast::Kinds();
+    }
+    return ElementKind::CONS;
+}
+
 std::string_view ConsFunction::name() const { return "cons"; }
 void ConsFunction::display_parameters(std::ostream& stream) const {
     stream << "head tail";
@@ -7,6 +7,21 @@ namespace evaluator {
 using ast::Element;
 using ast::ElementKind;
 
+ast::Kinds logical_result_kinds(
+    std::vector<ast::Kinds> const& arguments, size_t arity
+) {
+    if (arguments.size() != arity) {
+        return ast::Kinds();
+    }
+
+    for (auto argument : arguments) {
+        if (!argument.contains(ElementKind::BOOLEAN)) {
+            return ast::Kinds();
+        }
+    }
+    return ElementKind::BOOLEAN;
+}
+
 ElementGuard AndFunction::call(CallFrame frame) const {
     if (frame.arguments.size() != 2) {
         throw EvaluationError(
@@ -16,8 +31,8 @@ ElementGuard AndFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
 
     if (a_element->kind != ElementKind::BOOLEAN ||
         b_element->kind != ElementKind::BOOLEAN) {
@@ -26,13 +41,16 @@ ElementGuard AndFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_bool = std::dynamic_pointer_cast<ast::Boolean>(a_element);
-    auto b_bool = std::dynamic_pointer_cast<ast::Boolean>(b_element);
+    auto a_bool = static_cast<ast::Boolean const*>(a_element.get());
+    auto b_bool = static_cast<ast::Boolean const*>(b_element.get());
     auto result = a_bool->value && b_bool->value;
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds AndFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return logical_result_kinds(arguments, 2);
 }
 
 std::string_view AndFunction::name() const { return "and"; }
@@ -50,8 +68,8 @@ ElementGuard OrFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
 
     if (a_element->kind != ElementKind::BOOLEAN ||
         b_element->kind != ElementKind::BOOLEAN) {
@@ -60,13 +78,16 @@ ElementGuard OrFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_bool = std::dynamic_pointer_cast<ast::Boolean>(a_element);
-    auto b_bool = std::dynamic_pointer_cast<ast::Boolean>(b_element);
+    auto a_bool = static_cast<ast::Boolean const*>(a_element.get());
+    auto b_bool = static_cast<ast::Boolean const*>(b_element.get());
     auto result = a_bool->value || b_bool->value;
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds OrFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return logical_result_kinds(arguments, 2);
 }
 
 std::string_view OrFunction::name() const { return "or"; }
@@ -84,8 +105,8 @@ ElementGuard XorFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_element = frame.arguments[0];
-    auto b_element = frame.arguments[1];
+    auto const& a_element = frame.arguments[0];
+    auto const& b_element = frame.arguments[1];
 
     if (a_element->kind != ElementKind::BOOLEAN ||
         b_element->kind != ElementKind::BOOLEAN) {
@@ -94,13 +115,16 @@ ElementGuard XorFunction::call(CallFrame frame) const {
         );
     }
 
-    auto a_bool = std::dynamic_pointer_cast<ast::Boolean>(a_element);
-    auto b_bool = std::dynamic_pointer_cast<ast::Boolean>(b_element);
+    auto a_bool = static_cast<ast::Boolean const*>(a_element.get());
+    auto b_bool = static_cast<ast::Boolean const*>(b_element.get());
     auto result = a_bool->value != b_bool->value;
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds XorFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return logical_result_kinds(arguments, 2);
 }
 
 std::string_view XorFunction::name() const { return "xor"; }
@@ -118,7 +142,7 @@ ElementGuard NotFunction::call(CallFrame frame) const {
         );
     }
 
-    auto element = frame.arguments[0];
+    auto const& element = frame.arguments[0];
 
     if (element->kind != ElementKind::BOOLEAN) {
         throw EvaluationError(
@@ -126,12 +150,15 @@ ElementGuard NotFunction::call(CallFrame frame) const {
         );
     }
 
-    auto element_bool = std::dynamic_pointer_cast<ast::Boolean>(element);
+    auto element_bool = static_cast<ast::Boolean const*>(element.get());
     auto result = !element_bool->value;
 
-    return frame.context.garbage_collector->temporary(
-        std::make_shared<ast::Boolean>(result, this->span)
-    );
+    return frame.context.garbage_collector->temporary(this->boolean(result));
+}
+
+ast::Kinds NotFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return logical_result_kinds(arguments, 1);
 }
 
 std::string_view NotFunction::name() const { return "not"; }
@@ -0,0 +1,41 @@
+#include "../error.h"
+#include "../function.h"
+
+namespace evaluator {
+
+ElementGuard MemoFunction::call(CallFrame frame) const {
+    if (frame.arguments.size() != 1) {
+        throw EvaluationError(
+            "`memo` expects 1 argument, received " +
+                std::to_string(frame.arguments.size()),
+            frame.call_site
+        );
+    }
+
+    auto const& argument = frame.arguments[0];
+    if (argument->kind != ast::ElementKind::FUNCTION) {
+        throw EvaluationError(
+            "`memo` expects its argument to be a function", frame.call_site
+        );
+    }
+
+    // Built-in functions are cheap enough to call again
+    auto function = std::dynamic_pointer_cast<UserDefinedFunction>(argument);
+    if (!function || std::dynamic_pointer_cast<MemoizedFunction>(function)) {
+        return frame.context.garbage_collector->temporary(argument);
+    }
+
+    return frame.context.garbage_collector->temporary(
+        std::make_shared<MemoizedFunction>(function)
+    );
+}
+
+// Every call creates a new function
+bool MemoFunction::is_pure() const { return false; }
+
+std::string_view MemoFunction::name() const { return "memo"; }
+void MemoFunction::display_parameters(std::ostream& stream) const {
+    stream << "function";
+}
+
+} // namespace evaluator
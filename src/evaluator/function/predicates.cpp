@@ -17,16 +17,27 @@ ElementGuard is_element_kind(
         );
     }
 
-    auto element = frame.arguments[0];
+    auto const& element = frame.arguments[0];
     bool result = element->kind == kind;
     return frame.context.garbage_collector->temporary(
         std::make_shared<Boolean>(result, frame.call_site)
     );
 }
 
+ast::Kinds predicate_result_kinds(std::vector<ast::Kinds> const& arguments) {
+    if (arguments.size() != 1) {
+        return ast::Kinds();
+    }
+    return ElementKind::BOOLEAN;
+}
+
 ElementGuard IsIntFunction::call(CallFrame frame) const {
     return is_element_kind(frame, ElementKind::INTEGER, this->name());
 }
+ast::Kinds IsIntFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return predicate_result_kinds(arguments);
+}
 std::string_view IsIntFunction::name() const { return "isint"; }
 void IsIntFunction::display_parameters(std::ostream& stream) const {
     stream << "integer";
@@ -35,6 +46,10 @@ void IsIntFunction::display_parameters(std::ostream& stream) const {
 ElementGuard IsRealFunction::call(CallFrame frame) const {
     return is_element_kind(frame, ElementKind::REAL, this->name());
 }
+ast::Kinds IsRealFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return predicate_result_kinds(arguments);
+}
 std::string_view IsRealFunction::name() const { return "isreal"; }
 void IsRealFunction::display_parameters(std::ostream& stream) const {
     stream << "real";
@@ -43,6 +58,10 @@ void IsRealFunction::display_parameters(std::ostream& stream) const {
 ElementGuard IsBoolFunction::call(CallFrame frame) const {
     return is_element_kind(frame, ElementKind::BOOLEAN, this->name());
 }
+ast::Kinds IsBoolFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return predicate_result_kinds(arguments);
+}
 std::string_view IsBoolFunction::name() const { return "isbool"; }
 void IsBoolFunction::display_parameters(std::ostream& stream) const {
     stream << "boolean";
@@ -51,6 +70,10 @@ void IsBoolFunction::display_parameters(std::ostream& stream) const {
 ElementGuard IsNullFunction::call(CallFrame frame) const {
     return is_element_kind(frame, ElementKind::NULL_, this->name());
 }
+ast::Kinds IsNullFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return predicate_result_kinds(arguments);
+}
 std::string_view IsNullFunction::name() const { return "isnull"; }
 void IsNullFunction::display_parameters(std::ostream& stream) const {
     stream << "null";
@@ -59,6 +82,10 @@ void IsNullFunction::display_parameters(std::ostream& stream) const {
 ElementGuard IsAtomFunction::call(CallFrame frame) const {
     return is_element_kind(frame, ElementKind::SYMBOL, this->name());
 }
+ast::Kinds IsAtomFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return predicate_result_kinds(arguments);
+}
 std::string_view IsAtomFunction::name() const { return "isatom"; }
 void IsAtomFunction::display_parameters(std::ostream& stream) const {
     stream << "symbol";
@@ -73,7 +100,7 @@ ElementGuard IsListFunction::call(CallFrame frame) const {
         );
     }
 
-    auto element = frame.arguments[0];
+    auto const& element = frame.arguments[0];
     bool result = element->kind == ElementKind::CONS ||
                   element->kind == ElementKind::NULL_;
     return frame.context.garbage_collector->temporary(
@@ -81,6 +108,10 @@ ElementGuard IsListFunction::call(CallFrame frame) const {
     );
 }
 
+ast::Kinds IsListFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return predicate_result_kinds(arguments);
+}
 std::string_view IsListFunction::name() const { return "islist"; }
 void IsListFunction::display_parameters(std::ostream& stream) const {
     stream << "list";
@@ -89,6 +120,10 @@ void IsListFunction::display_parameters(std::ostream& stream) const {
 ElementGuard IsFuncFunction::call(CallFrame frame) const {
     return is_element_kind(frame, ElementKind::FUNCTION, this->name());
 }
+ast::Kinds IsFuncFunction::result_kinds(std::vector<ast::Kinds> const& arguments
+) const {
+    return predicate_result_kinds(arguments);
+}
 std::string_view IsFuncFunction::name() const { return "isfunc"; }
 void IsFuncFunction::display_parameters(std::ostream& stream) const {
     stream << "function";
@@ -0,0 +1,43 @@
+#include "../error.h"
+#include "../function.h"
+#include "../partial_evaluation.h"
+
+namespace evaluator {
+
+ElementGuard SpecializeFunction::call(CallFrame frame) const {
+    if (frame.arguments.empty()) {
+        throw EvaluationError(
+            "`specialize` expects at least 1 argument, received 0",
+            frame.call_site
+        );
+    }
+
+    auto function =
+        std::dynamic_pointer_cast<UserDefinedFunction>(frame.arguments[0]);
+    if (!function) {
+        throw EvaluationError(
+            "`specialize` expects its first argument to be a user-defined "
+            "function",
+            frame.call_site
+        );
+    }
+
+    return frame.context.garbage_collector->temporary(
+        PartialEvaluator::specialize(
+            function,
+            frame.arguments.subspan(1),
+            frame.call_site,
+            frame.context.garbage_collector
+        )
+    );
+}
+
+// Every call creates a new function
+bool SpecializeFunction::is_pure() const { return false; }
+
+std::string_view SpecializeFunction::name() const { return "specialize"; }
+void SpecializeFunction::display_parameters(std::ostream& stream) const {
+    stream << "function values...";
+}
+
+} // namespace evaluator
@@ -0,0 +1,76 @@
+#include "inline_cache.h"
+#include "function.h"
+
+namespace evaluator {
+
+std::shared_ptr<Function>
+InlineCache::lookup(ast::Symbol const& symbol, Scope& scope) {
+    if (this->function && this->version == Scope::version) {
+        return this->function;
+    }
+
+    auto function = std::dynamic_pointer_cast<Function>(scope.lookup(symbol));
+
+    // If no local scope has ever bound this name, the lookup could only have
+    // ended up in the global scope, no matter which scope it started from.
+    if (function && !Scope::is_declared_local(symbol.value)) {
+        this->function = function;
+        this->version = Scope::version;
+    } else {
+        this->function = nullptr;
+    }
+
+    return function;
+}
+
+void BuiltInGuard::assume(
+    std::shared_ptr<ast::Symbol> variable, std::shared_ptr<Function> function
+) {
+    for (auto const& [other, _] : this->assumptions) {
+        if (other->value == variable->value) {
+            return;
+        }
+    }
+
+    this->assumptions.emplace_back(variable, function);
+    this->version = 0;
+}
+
+void BuiltInGuard::merge(BuiltInGuard const& other) {
+    for (auto const& [variable, function] : other.assumptions) {
+        this->assume(variable, function);
+    }
+}
+
+bool BuiltInGuard::empty() const { return this->assumptions.empty(); }
+
+bool BuiltInGuard::check(Scope& scope) {
+    if (this->version == Scope::version) {
+        return this->holds;
+    }
+
+    this->holds = true;
+    for (auto const& [variable, function] : this->assumptions) {
+        if (Scope::is_declared_local(variable->value) ||
+            scope.lookup(*variable) != function) {
+            this->holds = false;
+            break;
+        }
+    }
+    this->version = Scope::version;
+
+    return this->holds;
+}
+
+void BuiltInGuard::display(std::ostream& stream) const {
+    stream << '[';
+    for (size_t index = 0; index < this->assumptions.size(); ++index) {
+        if (index > 0) {
+            stream << ", ";
+        }
+        stream << this->assumptions[index].first->value;
+    }
+    stream << ']';
+}
+
+} // namespace evaluator
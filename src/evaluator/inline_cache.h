@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "../ast/element.h"
+#include "scope.h"
+
+namespace evaluator {
+
+class Function;
+
+// Remembers which global function a call site's callee resolved to. The cached
+// function is reused until `Scope::version` changes, so calls to built-ins and
+// top-level functions skip walking the scope chain.
+class InlineCache {
+    std::shared_ptr<Function> function;
+    uint64_t version = 0;
+
+  public:
+    // Resolves `symbol` in `scope` and returns the function bound to it, or
+    // `nullptr` if the variable holds something else.
+    std::shared_ptr<Function> lookup(ast::Symbol const& symbol, Scope& scope);
+};
+
+// A set of assumptions that variables still hold the built-in functions an
+// optimization relied on. Like `InlineCache`, the assumptions are rechecked
+// only after `Scope::version` changes.
+class BuiltInGuard {
+    std::vector<std::pair<std::shared_ptr<ast::Symbol>, std::shared_ptr<Function>>>
+        assumptions;
+    uint64_t version = 0;
+    bool holds = false;
+
+  public:
+    void assume(
+        std::shared_ptr<ast::Symbol> variable, std::shared_ptr<Function> function
+    );
+    void merge(BuiltInGuard const& other);
+
+    bool empty() const;
+    bool check(Scope& scope);
+
+    void display(std::ostream& stream) const;
+};
+
+} // namespace evaluator
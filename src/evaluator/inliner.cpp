@@ -0,0 +1,137 @@
+#include "inliner.h"
+#include "optimizer.h"
+
+namespace evaluator {
+
+bool Inliner::enabled = true;
+
+Inliner::Inliner(Optimizer& optimizer) : optimizer(optimizer) {}
+
+void Inliner::inline_calls(std::unique_ptr<Expression>& expression) {
+    if (auto replacement = expression->inline_calls(*this)) {
+        expression = std::move(replacement);
+    }
+}
+
+void Inliner::inline_calls(Body& body) {
+    for (auto& expression : body.body) {
+        this->inline_calls(expression);
+    }
+}
+
+void Inliner::inline_program(Body& program) {
+    for (auto const& statement : program.body) {
+        auto func = dynamic_cast<Func const*>(statement.get());
+        if (!func) {
+            continue;
+        }
+
+        auto [definition, inserted] = this->definitions.try_emplace(
+            func->name->value,
+            Definition{func->parameters.parameters, func->body}
+        );
+        if (!inserted) {
+            // Calls may reach either definition
+            definition->second = std::nullopt;
+        }
+    }
+
+    this->inline_calls(program);
+}
+
+std::unique_ptr<Expression> Inliner::inline_call(
+    ast::Span span,
+    std::shared_ptr<ast::Symbol> const& callee,
+    std::vector<std::unique_ptr<Expression>>& arguments
+) {
+    auto found = this->definitions.find(callee->value);
+    if (found == this->definitions.end() || !found->second) {
+        return nullptr;
+    }
+    auto const& definition = *found->second;
+    if (definition.parameters.size() != arguments.size() ||
+        definition.body->body.size() != 1) {
+        return nullptr;
+    }
+    for (auto const& site : this->sites) {
+        if (site.name == callee->value) {
+            return nullptr;
+        }
+    }
+
+    if (this->sites.empty()) {
+        this->size = 0;
+    }
+
+    auto frame = std::make_unique<InlinedFrame>();
+    frame->parameters = definition.parameters;
+    frame->kinds.resize(arguments.size(), ast::Kinds::all());
+
+    this->sites.push_back(Site{callee->value, frame.get(), BuiltInGuard()});
+    auto body = this->copy(*definition.body->body.front());
+    auto guard = std::move(this->sites.back().guard);
+    this->sites.pop_back();
+    if (!body) {
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<Expression>> copies;
+    for (auto const& argument : arguments) {
+        copies.push_back(argument->clone());
+    }
+    auto fallback = std::make_unique<Call>(
+        span, std::make_unique<Symbol>(callee), std::move(copies)
+    );
+
+    return std::make_unique<Inlined>(
+        span,
+        callee,
+        definition.body,
+        std::move(guard),
+        std::move(arguments),
+        std::move(frame),
+        std::move(body),
+        std::move(fallback)
+    );
+}
+
+std::unique_ptr<Expression> Inliner::copy(Expression const& expression) {
+    if (++this->size > MAX_SIZE) {
+        return nullptr;
+    }
+    return expression.inline_copy(*this);
+}
+
+std::unique_ptr<Expression> Inliner::copy_call(
+    ast::Span span,
+    std::shared_ptr<ast::Symbol> const& callee,
+    std::vector<std::unique_ptr<Expression>>& arguments
+) {
+    // Functions passed as arguments would be called in the wrong scope, which
+    // only `eval` could tell apart
+    if (this->parameter(callee)) {
+        return nullptr;
+    }
+
+    if (auto function = this->optimizer.pure_built_in(*callee)) {
+        this->sites.back().guard.assume(callee, function);
+        return std::make_unique<Call>(
+            span, std::make_unique<Symbol>(callee), std::move(arguments)
+        );
+    }
+    return this->inline_call(span, callee, arguments);
+}
+
+std::unique_ptr<Expression>
+Inliner::parameter(std::shared_ptr<ast::Symbol> const& variable) {
+    auto frame = this->sites.back().frame;
+    auto const& parameters = frame->parameters;
+    for (size_t index = 0; index < parameters.size(); ++index) {
+        if (parameters[index]->value == variable->value) {
+            return std::make_unique<InlinedParameter>(variable, frame, index);
+        }
+    }
+    return nullptr;
+}
+
+} // namespace evaluator
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../ast/element.h"
+#include "expression.h"
+
+namespace evaluator {
+
+class Optimizer;
+
+// Replaces calls to small user-defined functions with copies of their bodies,
+// which saves creating a scope for the call, passing the arguments in a frame
+// and catching `return`.
+//
+// A function is inlined if it's defined by a single top-level `func` of the
+// program, and its body is a single expression of at most `MAX_SIZE` nodes
+// that reads nothing but its parameters and calls nothing but pure built-ins
+// and other functions that are inlined. So the function neither returns nor
+// recurses, and its body means the same in any scope. Arguments are still
+// evaluated once, in order, before the body.
+class Inliner {
+    struct Definition {
+        std::vector<std::shared_ptr<ast::Symbol>> parameters;
+        std::shared_ptr<Body> body;
+    };
+
+    // A call whose function body is being copied
+    struct Site {
+        std::string name;
+        InlinedFrame* frame;
+        BuiltInGuard guard;
+    };
+
+    Optimizer& optimizer;
+    // Unset for functions defined more than once
+    std::unordered_map<std::string, std::optional<Definition>> definitions;
+    // Calls being inlined, innermost last
+    std::vector<Site> sites;
+    // Nodes copied for the outermost call being inlined
+    size_t size = 0;
+
+  public:
+    // Whether calls are inlined at all
+    static bool enabled;
+    static constexpr size_t MAX_SIZE = 16;
+
+    Inliner(Optimizer& optimizer);
+
+    void inline_calls(std::unique_ptr<Expression>& expression);
+    void inline_calls(Body& body);
+    void inline_program(Body& program);
+
+    // Returns an inlined call of the function `callee` names, which takes the
+    // arguments over, or `nullptr` if the function can't be inlined.
+    std::unique_ptr<Expression> inline_call(
+        ast::Span span,
+        std::shared_ptr<ast::Symbol> const& callee,
+        std::vector<std::unique_ptr<Expression>>& arguments
+    );
+
+    // Copies a subexpression of the function body being inlined.
+    std::unique_ptr<Expression> copy(Expression const& expression);
+    // Copies a call in the function body being inlined, given copies of its
+    // arguments.
+    std::unique_ptr<Expression> copy_call(
+        ast::Span span,
+        std::shared_ptr<ast::Symbol> const& callee,
+        std::vector<std::unique_ptr<Expression>>& arguments
+    );
+    // Returns an expression that reads the parameter `variable` names, or
+    // `nullptr` if it isn't a parameter of the function being inlined.
+    std::unique_ptr<Expression>
+    parameter(std::shared_ptr<ast::Symbol> const& variable);
+};
+
+} // namespace evaluator
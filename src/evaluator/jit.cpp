@@ -0,0 +1,755 @@
+#include <bit>
+#include <fstream>
+#include <unistd.h>
+
+#include "function.h"
+#include "jit.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+
+// The code is called as `int code(uint64_t* slots, uint64_t* result)`, and
+// returns 0 once it has stored the result, or 1 if it bailed out
+using NativeCode = int (*)(uint64_t* slots, uint64_t* result);
+
+NativeFunction::NativeFunction(
+    std::unique_ptr<ExecutableCode> code,
+    std::vector<ElementKind> parameters,
+    ElementKind result,
+    BuiltInGuard guard,
+    size_t slots
+)
+    : code(std::move(code)), parameters(std::move(parameters)), result(result),
+      guard(std::move(guard)), slots(slots) {}
+
+std::shared_ptr<ast::Element>
+NativeFunction::call(CallFrame const& frame, Scope& scope) {
+    if (frame.arguments.size() != this->parameters.size()) {
+        return nullptr;
+    }
+
+    for (size_t index = 0; index < this->parameters.size(); ++index) {
+        auto const& argument = frame.arguments[index];
+        if (argument->kind != this->parameters[index]) {
+            return nullptr;
+        }
+
+        switch (argument->kind) {
+        case ElementKind::INTEGER:
+            this->slots[index] = static_cast<uint64_t>(
+                static_cast<ast::Integer const&>(*argument).value
+            );
+            break;
+        case ElementKind::REAL:
+            this->slots[index] = std::bit_cast<uint64_t>(
+                static_cast<ast::Real const&>(*argument).value
+            );
+            break;
+        default:
+            this->slots[index] =
+                static_cast<ast::Boolean const&>(*argument).value;
+            break;
+        }
+    }
+
+    if (!this->guard.check(scope)) {
+        return nullptr;
+    }
+
+    auto code = reinterpret_cast<NativeCode>(
+        const_cast<void*>(this->code->start())
+    );
+    uint64_t value = 0;
+    if (code(this->slots.data(), &value) != 0) {
+        return nullptr;
+    }
+
+    switch (this->result) {
+    case ElementKind::INTEGER:
+        return std::make_shared<ast::Integer>(
+            static_cast<int64_t>(value), frame.call_site
+        );
+    case ElementKind::REAL:
+        return std::make_shared<ast::Real>(
+            std::bit_cast<double>(value), frame.call_site
+        );
+    default:
+        return std::make_shared<ast::Boolean>(value != 0, frame.call_site);
+    }
+}
+
+// Stack operands and slots are 8 bytes each
+constexpr int32_t WORD = 8;
+
+int32_t slot_offset(size_t slot) { return static_cast<int32_t>(slot) * WORD; }
+
+JitCompiler::JitCompiler(Scope& global)
+    : global(global), bailout(this->assembler.new_label()),
+      exit(this->assembler.new_label()) {}
+
+void JitCompiler::reject() { throw Unsupported(); }
+
+std::vector<uint8_t> JitCompiler::compile(
+    Parameters const& parameters,
+    std::vector<ElementKind> const& kinds,
+    Body const& body
+) {
+    auto& assembler = this->assembler;
+
+    assembler.push(Register::RBP);
+    assembler.move(Register::RBP, Register::RSP);
+    assembler.push(Register::RBX);
+    assembler.push(Register::R12);
+    assembler.move(Register::RBX, Register::RDI);
+    assembler.move(Register::R12, Register::RSI);
+
+    this->frames.emplace_back();
+    for (size_t index = 0; index < parameters.parameters.size(); ++index) {
+        auto slot = this->declare(*parameters.parameters[index]);
+        this->kinds[slot] = kinds[index];
+        this->assigned[slot] = true;
+    }
+
+    auto kind = this->emit(body);
+    if (this->reachable) {
+        this->emit_result(kind);
+    }
+    if (!this->result) {
+        // The function never returns
+        this->reject();
+    }
+
+    assembler.bind(this->bailout);
+    assembler.move(Register::RAX, int64_t(1));
+    assembler.bind(this->exit);
+    assembler.load_address(Register::RSP, Register::RBP, -2 * WORD);
+    assembler.pop(Register::R12);
+    assembler.pop(Register::RBX);
+    assembler.pop(Register::RBP);
+    assembler.ret();
+
+    return assembler.finish();
+}
+
+ElementKind JitCompiler::result_kind() const { return *this->result; }
+size_t JitCompiler::slots() const { return this->kinds.size(); }
+BuiltInGuard const& JitCompiler::assumptions() const { return this->guard; }
+
+std::optional<size_t> JitCompiler::find(ast::Symbol const& variable) const {
+    for (auto frame = this->frames.rbegin(); frame != this->frames.rend();
+         ++frame) {
+        auto found = frame->find(variable.value);
+        if (found != frame->end()) {
+            return found->second;
+        }
+    }
+    return std::nullopt;
+}
+
+size_t JitCompiler::declare(ast::Symbol const& variable) {
+    auto slot = this->kinds.size();
+    this->kinds.push_back(ElementKind::NULL_);
+    this->assigned.push_back(false);
+    this->frames.back()[variable.value] = slot;
+    return slot;
+}
+
+void JitCompiler::join(std::vector<bool> other) {
+    other.resize(this->assigned.size(), false);
+    for (size_t slot = 0; slot < this->assigned.size(); ++slot) {
+        this->assigned[slot] = this->assigned[slot] && other[slot];
+    }
+}
+
+ElementKind JitCompiler::emit(Expression const& expression) {
+    return expression.jit(*this);
+}
+
+ElementKind JitCompiler::emit(Body const& body) {
+    auto kind = ElementKind::NULL_;
+    for (auto const& expression : body.body) {
+        // Statements after a `return` or `break` never run
+        if (!this->reachable) {
+            break;
+        }
+        kind = this->emit(*expression);
+    }
+    return kind;
+}
+
+ElementKind JitCompiler::emit_value(Expression const& expression) {
+    auto kind = this->emit(expression);
+    if (!this->reachable || (kind != ElementKind::INTEGER &&
+                             kind != ElementKind::REAL &&
+                             kind != ElementKind::BOOLEAN)) {
+        this->reject();
+    }
+    return kind;
+}
+
+void JitCompiler::push(ElementKind kind) {
+    if (kind == ElementKind::REAL) {
+        this->assembler.subtract(Register::RSP, WORD);
+        this->assembler.store(Register::RSP, 0, FloatRegister::XMM0);
+    } else {
+        this->assembler.push(Register::RAX);
+    }
+    ++this->depth;
+}
+
+void JitCompiler::emit_result(ElementKind kind) {
+    if (kind != ElementKind::INTEGER && kind != ElementKind::REAL &&
+        kind != ElementKind::BOOLEAN) {
+        this->reject();
+    }
+    if (this->result && *this->result != kind) {
+        this->reject();
+    }
+    this->result = kind;
+
+    if (kind == ElementKind::REAL) {
+        this->assembler.store(Register::R12, 0, FloatRegister::XMM0);
+    } else {
+        this->assembler.store(Register::R12, 0, Register::RAX);
+    }
+    this->assembler.move(Register::RAX, int64_t(0));
+    this->assembler.jump(this->exit);
+    this->reachable = false;
+}
+
+ElementKind JitCompiler::emit_constant(ast::Element const& element) {
+    switch (element.kind) {
+    case ElementKind::INTEGER:
+        this->assembler.move(
+            Register::RAX, static_cast<ast::Integer const&>(element).value
+        );
+        return ElementKind::INTEGER;
+    case ElementKind::REAL:
+        this->assembler.move(
+            Register::RAX,
+            std::bit_cast<int64_t>(static_cast<ast::Real const&>(element).value)
+        );
+        this->assembler.move(FloatRegister::XMM0, Register::RAX);
+        return ElementKind::REAL;
+    case ElementKind::BOOLEAN:
+        this->assembler.move(
+            Register::RAX,
+            int64_t(static_cast<ast::Boolean const&>(element).value)
+        );
+        return ElementKind::BOOLEAN;
+    default:
+        // Only usable as a value that is dropped
+        return ElementKind::NULL_;
+    }
+}
+
+ElementKind JitCompiler::emit_read(ast::Symbol const& variable) {
+    auto slot = this->find(variable);
+    if (!slot || !this->assigned[*slot]) {
+        this->reject();
+    }
+
+    auto kind = this->kinds[*slot];
+    if (kind == ElementKind::REAL) {
+        this->assembler.load(
+            FloatRegister::XMM0, Register::RBX, slot_offset(*slot)
+        );
+    } else {
+        this->assembler.load(Register::RAX, Register::RBX, slot_offset(*slot));
+    }
+    return kind;
+}
+
+ElementKind JitCompiler::emit_assignment(
+    ast::Symbol const& variable, Expression const& initializer
+) {
+    // Assigning a variable the function doesn't declare may define it
+    auto slot = this->find(variable);
+    if (!slot) {
+        this->reject();
+    }
+
+    auto kind = this->emit_value(initializer);
+    if (this->kinds[*slot] == ElementKind::NULL_) {
+        this->kinds[*slot] = kind;
+    } else if (this->kinds[*slot] != kind) {
+        this->reject();
+    }
+
+    if (kind == ElementKind::REAL) {
+        this->assembler.store(
+            Register::RBX, slot_offset(*slot), FloatRegister::XMM0
+        );
+    } else {
+        this->assembler.store(Register::RBX, slot_offset(*slot), Register::RAX);
+    }
+    this->assigned[*slot] = true;
+    return kind;
+}
+
+ElementKind JitCompiler::emit_cond(
+    Expression const& condition,
+    Expression const& then,
+    Expression const& otherwise
+) {
+    if (this->emit_value(condition) != ElementKind::BOOLEAN) {
+        this->reject();
+    }
+
+    auto otherwise_label = this->assembler.new_label();
+    auto end = this->assembler.new_label();
+    this->assembler.test(Register::RAX, Register::RAX);
+    this->assembler.jump_if(Condition::EQUAL, otherwise_label);
+
+    auto before = this->assigned;
+    auto then_kind = this->emit(then);
+    auto then_reachable = this->reachable;
+    auto then_assigned = std::move(this->assigned);
+    this->assembler.jump(end);
+
+    this->assembler.bind(otherwise_label);
+    this->assigned = std::move(before);
+    this->assigned.resize(then_assigned.size(), false);
+    this->reachable = true;
+    auto otherwise_kind = this->emit(otherwise);
+    this->assembler.bind(end);
+
+    if (!then_reachable) {
+        return otherwise_kind;
+    }
+    if (!this->reachable) {
+        this->assigned = std::move(then_assigned);
+        this->assigned.resize(this->kinds.size(), false);
+        this->reachable = true;
+        return then_kind;
+    }
+
+    this->join(std::move(then_assigned));
+    return then_kind == otherwise_kind ? then_kind : ElementKind::NULL_;
+}
+
+ElementKind JitCompiler::emit_loop(Expression const& condition, Body const& body) {
+    auto start = this->assembler.new_label();
+    this->targets.push_back(
+        Target{this->assembler.new_label(), this->depth, true, {}, std::nullopt}
+    );
+    auto end = this->targets.back().exit;
+
+    this->assembler.bind(start);
+    if (this->emit_value(condition) != ElementKind::BOOLEAN) {
+        this->reject();
+    }
+    // The condition is evaluated before leaving the loop in any way, while
+    // the body may not run at all
+    auto after_condition = this->assigned;
+    this->assembler.test(Register::RAX, Register::RAX);
+    this->assembler.jump_if(Condition::EQUAL, end);
+
+    this->emit(body);
+    if (this->reachable) {
+        this->assembler.jump(start);
+    }
+    this->assembler.bind(end);
+
+    this->assigned = std::move(after_condition);
+    this->assigned.resize(this->kinds.size(), false);
+    this->reachable = true;
+    this->targets.pop_back();
+    return ElementKind::NULL_;
+}
+
+ElementKind JitCompiler::emit_prog(Parameters const& variables, Body const& body) {
+    this->frames.emplace_back();
+    for (auto const& variable : variables.parameters) {
+        this->declare(*variable);
+    }
+    this->targets.push_back(
+        Target{this->assembler.new_label(), this->depth, false, {}, std::nullopt}
+    );
+
+    auto kind = this->emit(body);
+    auto& target = this->targets.back();
+    if (this->reachable) {
+        target.kinds.push_back(kind);
+        if (target.assigned) {
+            this->join(std::move(*target.assigned));
+        }
+        target.assigned = this->assigned;
+    }
+    this->assembler.bind(target.exit);
+
+    kind = ElementKind::NULL_;
+    if (!target.kinds.empty()) {
+        kind = target.kinds.front();
+        for (auto other : target.kinds) {
+            if (other != kind) {
+                kind = ElementKind::NULL_;
+            }
+        }
+    }
+    this->reachable = target.assigned.has_value();
+    if (this->reachable) {
+        this->assigned = std::move(*target.assigned);
+        this->assigned.resize(this->kinds.size(), false);
+    }
+
+    this->targets.pop_back();
+    this->frames.pop_back();
+    return kind;
+}
+
+ElementKind JitCompiler::emit_return(Expression const& expression) {
+    auto kind = this->emit(expression);
+    if (this->reachable) {
+        this->emit_result(kind);
+    }
+    return ElementKind::NULL_;
+}
+
+ElementKind JitCompiler::emit_break(Expression const& expression) {
+    if (this->targets.empty()) {
+        this->reject();
+    }
+
+    auto kind = this->emit(expression);
+    if (!this->reachable) {
+        return ElementKind::NULL_;
+    }
+
+    auto& target = this->targets.back();
+    if (!target.loop) {
+        target.kinds.push_back(kind);
+        auto assigned = this->assigned;
+        if (target.assigned) {
+            auto joined = std::move(*target.assigned);
+            joined.resize(assigned.size(), false);
+            for (size_t slot = 0; slot < assigned.size(); ++slot) {
+                assigned[slot] = assigned[slot] && joined[slot];
+            }
+        }
+        target.assigned = std::move(assigned);
+    }
+
+    if (this->depth > target.depth) {
+        this->assembler.add(
+            Register::RSP, static_cast<int32_t>(this->depth - target.depth) * WORD
+        );
+    }
+    this->assembler.jump(target.exit);
+    this->reachable = false;
+    return ElementKind::NULL_;
+}
+
+ElementKind JitCompiler::emit_call(
+    std::shared_ptr<ast::Symbol> const& callee,
+    std::vector<std::unique_ptr<Expression>> const& arguments
+) {
+    // Only built-ins no local variable may shadow
+    if (!callee || this->find(*callee) ||
+        Scope::is_declared_local(callee->value)) {
+        this->reject();
+    }
+    auto function = std::dynamic_pointer_cast<BuiltInFunction>(
+        this->global.find_variable(callee->value)
+    );
+    if (!function) {
+        this->reject();
+    }
+    this->guard.assume(callee, function);
+
+    if (arguments.size() == 2) {
+        if (auto operation = arithmetic_operation(*function)) {
+            return this->emit_arithmetic(
+                *operation, *arguments[0], *arguments[1]
+            );
+        }
+        if (auto operation = comparison_operation(*function)) {
+            return this->emit_comparison(
+                *operation, *arguments[0], *arguments[1]
+            );
+        }
+    }
+    return this->emit_logical(*function, arguments);
+}
+
+ElementKind JitCompiler::emit_arithmetic(
+    Arithmetic::Operation operation,
+    Expression const& left,
+    Expression const& right
+) {
+    auto& assembler = this->assembler;
+
+    auto left_kind = this->emit_value(left);
+    this->push(left_kind);
+    auto right_kind = this->emit_value(right);
+    if (left_kind == ElementKind::BOOLEAN ||
+        right_kind == ElementKind::BOOLEAN) {
+        this->reject();
+    }
+
+    if (left_kind == ElementKind::INTEGER &&
+        right_kind == ElementKind::INTEGER) {
+        assembler.move(Register::RCX, Register::RAX);
+        assembler.pop(Register::RAX);
+        --this->depth;
+
+        switch (operation) {
+        case Arithmetic::Operation::PLUS:
+            assembler.add(Register::RAX, Register::RCX);
+            break;
+        case Arithmetic::Operation::MINUS:
+            assembler.subtract(Register::RAX, Register::RCX);
+            break;
+        case Arithmetic::Operation::TIMES:
+            assembler.multiply(Register::RAX, Register::RCX);
+            break;
+        case Arithmetic::Operation::DIVIDE: {
+            // The evaluator reports division by zero
+            assembler.test(Register::RCX, Register::RCX);
+            assembler.jump_if(Condition::EQUAL, this->bailout);
+
+            // `idiv` would trap on the minimum integer divided by -1
+            auto divide = assembler.new_label();
+            auto done = assembler.new_label();
+            assembler.compare(Register::RCX, -1);
+            assembler.jump_if(Condition::NOT_EQUAL, divide);
+            assembler.negate(Register::RAX);
+            assembler.jump(done);
+            assembler.bind(divide);
+            assembler.sign_extend();
+            assembler.divide(Register::RCX);
+            assembler.bind(done);
+            break;
+        }
+        }
+        return ElementKind::INTEGER;
+    }
+
+    if (right_kind == ElementKind::INTEGER) {
+        assembler.convert(FloatRegister::XMM1, Register::RAX);
+    } else {
+        assembler.move(FloatRegister::XMM1, FloatRegister::XMM0);
+    }
+    if (left_kind == ElementKind::INTEGER) {
+        assembler.pop(Register::RAX);
+        assembler.convert(FloatRegister::XMM0, Register::RAX);
+    } else {
+        assembler.load(FloatRegister::XMM0, Register::RSP, 0);
+        assembler.add(Register::RSP, WORD);
+    }
+    --this->depth;
+
+    switch (operation) {
+    case Arithmetic::Operation::PLUS:
+        assembler.add(FloatRegister::XMM0, FloatRegister::XMM1);
+        break;
+    case Arithmetic::Operation::MINUS:
+        assembler.subtract(FloatRegister::XMM0, FloatRegister::XMM1);
+        break;
+    case Arithmetic::Operation::TIMES:
+        assembler.multiply(FloatRegister::XMM0, FloatRegister::XMM1);
+        break;
+    case Arithmetic::Operation::DIVIDE:
+        assembler.divide(FloatRegister::XMM0, FloatRegister::XMM1);
+        break;
+    }
+    return ElementKind::REAL;
+}
+
+ElementKind JitCompiler::emit_comparison(
+    Comparison::Operation operation,
+    Expression const& left,
+    Expression const& right
+) {
+    using Operation = Comparison::Operation;
+    auto& assembler = this->assembler;
+
+    auto kind = this->emit_value(left);
+    this->push(kind);
+    // Built-ins only compare values of the same kind, and order numbers
+    if (this->emit_value(right) != kind ||
+        (kind == ElementKind::BOOLEAN && operation != Operation::EQUAL &&
+         operation != Operation::NONEQUAL)) {
+        this->reject();
+    }
+    --this->depth;
+
+    if (kind != ElementKind::REAL) {
+        assembler.move(Register::RCX, Register::RAX);
+        assembler.pop(Register::RAX);
+        assembler.compare(Register::RAX, Register::RCX);
+
+        Condition condition = Condition::EQUAL;
+        switch (operation) {
+        case Operation::EQUAL:
+            condition = Condition::EQUAL;
+            break;
+        case Operation::NONEQUAL:
+            condition = Condition::NOT_EQUAL;
+            break;
+        case Operation::LESS:
+            condition = Condition::LESS;
+            break;
+        case Operation::LESSEQ:
+            condition = Condition::LESS_OR_EQUAL;
+            break;
+        case Operation::GREATER:
+            condition = Condition::GREATER;
+            break;
+        case Operation::GREATEREQ:
+            condition = Condition::GREATER_OR_EQUAL;
+            break;
+        }
+        assembler.set(condition, Register::RAX);
+        return ElementKind::BOOLEAN;
+    }
+
+    assembler.move(FloatRegister::XMM1, FloatRegister::XMM0);
+    assembler.load(FloatRegister::XMM0, Register::RSP, 0);
+    assembler.add(Register::RSP, WORD);
+
+    // Comparisons with NaN only hold for `nonequal`. Unordered operands set
+    // the carry and zero flags, so `less` is tested as `greater` with the
+    // operands swapped.
+    switch (operation) {
+    case Operation::EQUAL:
+        assembler.compare(FloatRegister::XMM0, FloatRegister::XMM1);
+        assembler.set(Condition::EQUAL, Register::RAX);
+        assembler.set(Condition::NO_PARITY, Register::RCX);
+        assembler.bitwise_and(Register::RAX, Register::RCX);
+        break;
+    case Operation::NONEQUAL:
+        assembler.compare(FloatRegister::XMM0, FloatRegister::XMM1);
+        assembler.set(Condition::NOT_EQUAL, Register::RAX);
+        assembler.set(Condition::PARITY, Register::RCX);
+        assembler.bitwise_or(Register::RAX, Register::RCX);
+        break;
+    case Operation::LESS:
+        assembler.compare(FloatRegister::XMM1, FloatRegister::XMM0);
+        assembler.set(Condition::ABOVE, Register::RAX);
+        break;
+    case Operation::LESSEQ:
+        assembler.compare(FloatRegister::XMM1, FloatRegister::XMM0);
+        assembler.set(Condition::ABOVE_OR_EQUAL, Register::RAX);
+        break;
+    case Operation::GREATER:
+        assembler.compare(FloatRegister::XMM0, FloatRegister::XMM1);
+        assembler.set(Condition::ABOVE, Register::RAX);
+        break;
+    case Operation::GREATEREQ:
+        assembler.compare(FloatRegister::XMM0, FloatRegister::XMM1);
+        assembler.set(Condition::ABOVE_OR_EQUAL, Register::RAX);
+        break;
+    }
+    return ElementKind::BOOLEAN;
+}
+
+ElementKind JitCompiler::emit_logical(
+    Function const& function,
+    std::vector<std::unique_ptr<Expression>> const& arguments
+) {
+    auto& assembler = this->assembler;
+
+    if (dynamic_cast<NotFunction const*>(&function) && arguments.size() == 1) {
+        if (this->emit_value(*arguments[0]) != ElementKind::BOOLEAN) {
+            this->reject();
+        }
+        assembler.bitwise_xor(Register::RAX, 1);
+        return ElementKind::BOOLEAN;
+    }
+
+    bool is_and = dynamic_cast<AndFunction const*>(&function);
+    bool is_or = dynamic_cast<OrFunction const*>(&function);
+    bool is_xor = dynamic_cast<XorFunction const*>(&function);
+    if (!(is_and || is_or || is_xor) || arguments.size() != 2) {
+        this->reject();
+    }
+
+    // Both arguments are evaluated, like for any built-in
+    if (this->emit_value(*arguments[0]) != ElementKind::BOOLEAN) {
+        this->reject();
+    }
+    this->push(ElementKind::BOOLEAN);
+    if (this->emit_value(*arguments[1]) != ElementKind::BOOLEAN) {
+        this->reject();
+    }
+    assembler.move(Register::RCX, Register::RAX);
+    assembler.pop(Register::RAX);
+    --this->depth;
+
+    if (is_and) {
+        assembler.bitwise_and(Register::RAX, Register::RCX);
+    } else if (is_or) {
+        assembler.bitwise_or(Register::RAX, Register::RCX);
+    } else {
+        assembler.bitwise_xor(Register::RAX, Register::RCX);
+    }
+    return ElementKind::BOOLEAN;
+}
+
+bool Jit::enabled = false;
+bool Jit::perf_map = false;
+
+// Appends a line naming the code to the map `perf` looks for.
+void write_perf_map(ExecutableCode const& code, std::string const& name) {
+    std::ofstream map(
+        "/tmp/perf-" + std::to_string(getpid()) + ".map", std::ios::app
+    );
+    map << std::hex << reinterpret_cast<uintptr_t>(code.start()) << ' '
+        << code.length() << std::dec << " jit:" << name << '\n';
+}
+
+std::unique_ptr<NativeFunction> Jit::compile(
+    Func const& definition,
+    std::vector<ast::Kinds> const& kinds,
+    Scope& global
+) {
+#if !defined(__x86_64__)
+    return nullptr;
+#endif
+
+    std::vector<ElementKind> parameters;
+    for (auto argument : kinds) {
+        if (argument.is(ElementKind::INTEGER)) {
+            parameters.push_back(ElementKind::INTEGER);
+        } else if (argument.is(ElementKind::REAL)) {
+            parameters.push_back(ElementKind::REAL);
+        } else if (argument.is(ElementKind::BOOLEAN)) {
+            parameters.push_back(ElementKind::BOOLEAN);
+        } else {
+            return nullptr;
+        }
+    }
+    if (parameters.size() != definition.parameters.parameters.size()) {
+        return nullptr;
+    }
+
+    JitCompiler compiler(global);
+    std::vector<uint8_t> code;
+    try {
+        code = compiler.compile(
+            definition.parameters, parameters, *definition.body
+        );
+    } catch (JitCompiler::Unsupported const&) {
+        return nullptr;
+    }
+
+    auto executable = ExecutableCode::map(code);
+    if (!executable) {
+        return nullptr;
+    }
+    if (Jit::perf_map) {
+        write_perf_map(*executable, definition.name->value);
+    }
+
+    return std::make_unique<NativeFunction>(
+        std::move(executable),
+        std::move(parameters),
+        compiler.result_kind(),
+        compiler.assumptions(),
+        compiler.slots()
+    );
+}
+
+} // namespace evaluator
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../ast/element.h"
+#include "../ast/kind.h"
+#include "assembler.h"
+#include "expression.h"
+#include "inline_cache.h"
+
+namespace evaluator {
+
+class CallFrame;
+
+// Machine code `Jit` compiled from a user-defined function for arguments of
+// some kinds.
+class NativeFunction {
+    std::unique_ptr<ExecutableCode> code;
+    std::vector<ast::ElementKind> parameters;
+    ast::ElementKind result;
+    BuiltInGuard guard;
+    // Values of the parameters and local variables while the code runs. The
+    // code calls nothing, so calls never nest.
+    std::vector<uint64_t> slots;
+
+  public:
+    NativeFunction(
+        std::unique_ptr<ExecutableCode> code,
+        std::vector<ast::ElementKind> parameters,
+        ast::ElementKind result,
+        BuiltInGuard guard,
+        size_t slots
+    );
+
+    // Runs the code if the arguments have the kinds it was compiled for and
+    // the built-ins it calls are still bound in `scope`. Returns the result,
+    // or `nullptr` if the function must be evaluated instead, also when the
+    // code bailed out, like on a division by zero.
+    std::shared_ptr<ast::Element> call(CallFrame const& frame, Scope& scope);
+};
+
+// Emits the machine code of a function through the nodes of its body. Values
+// of integers and booleans are computed into RAX, and of reals into XMM0;
+// operands wait on the machine stack. Variables live in slots the caller
+// passes in RBX, and the result is stored where R12 points to.
+//
+// Every variable holds values of a single kind: parameters the kinds they
+// were compiled for, and local variables the kind of their first
+// assignment. Variables may only be read where they are assigned on every
+// path, so the code never sees `prog` variables holding null.
+class JitCompiler {
+  public:
+    // Thrown by `reject` when the function can't be compiled.
+    class Unsupported {};
+
+  private:
+    // A `while` loop or `prog` that `break` exits
+    struct Target {
+        Assembler::Label exit;
+        // The number of operands on the stack on entry
+        size_t depth;
+        bool loop;
+        // For `prog`, the kinds of values it may exit with, and the variables
+        // assigned on every exit
+        std::vector<ast::ElementKind> kinds;
+        std::optional<std::vector<bool>> assigned;
+    };
+
+    Assembler assembler;
+    Scope& global;
+    BuiltInGuard guard;
+    // Slots of variables by name, innermost scope last
+    std::vector<std::unordered_map<std::string, size_t>> frames;
+    // Kinds of variables by slot, `NULL_` until assigned
+    std::vector<ast::ElementKind> kinds;
+    // Whether each variable is assigned on every path to the current point
+    std::vector<bool> assigned;
+    // Unset after an unconditional `return` or `break`
+    bool reachable = true;
+    std::vector<Target> targets;
+    // Operands on the stack
+    size_t depth = 0;
+    std::optional<ast::ElementKind> result;
+    Assembler::Label bailout;
+    Assembler::Label exit;
+
+    std::optional<size_t> find(ast::Symbol const& variable) const;
+    size_t declare(ast::Symbol const& variable);
+    // Joins the variables assigned on another path to the same point.
+    void join(std::vector<bool> other);
+
+    // Emits an expression whose value is used, which must be of a single
+    // kind native code can hold.
+    ast::ElementKind emit_value(Expression const& expression);
+    void push(ast::ElementKind kind);
+    // Stores the value as the result of the function and exits.
+    void emit_result(ast::ElementKind kind);
+
+    ast::ElementKind emit_arithmetic(
+        Arithmetic::Operation operation,
+        Expression const& left,
+        Expression const& right
+    );
+    ast::ElementKind emit_comparison(
+        Comparison::Operation operation,
+        Expression const& left,
+        Expression const& right
+    );
+    ast::ElementKind emit_logical(
+        Function const& function,
+        std::vector<std::unique_ptr<Expression>> const& arguments
+    );
+
+  public:
+    JitCompiler(Scope& global);
+
+    [[noreturn]] void reject();
+
+    // Emits the function, returning its code, the kind of its result and the
+    // number of slots it needs.
+    std::vector<uint8_t> compile(
+        Parameters const& parameters,
+        std::vector<ast::ElementKind> const& kinds,
+        Body const& body
+    );
+    ast::ElementKind result_kind() const;
+    size_t slots() const;
+    BuiltInGuard const& assumptions() const;
+
+    // Emits code computing the expression, and returns the kind of its value,
+    // or `NULL_` if native code can't use it.
+    ast::ElementKind emit(Expression const& expression);
+    ast::ElementKind emit(Body const& body);
+
+    ast::ElementKind emit_constant(ast::Element const& element);
+    ast::ElementKind emit_read(ast::Symbol const& variable);
+    ast::ElementKind
+    emit_assignment(ast::Symbol const& variable, Expression const& initializer);
+    ast::ElementKind emit_cond(
+        Expression const& condition,
+        Expression const& then,
+        Expression const& otherwise
+    );
+    ast::ElementKind emit_loop(Expression const& condition, Body const& body);
+    ast::ElementKind emit_prog(Parameters const& variables, Body const& body);
+    ast::ElementKind emit_return(Expression const& expression);
+    ast::ElementKind emit_break(Expression const& expression);
+    ast::ElementKind emit_call(
+        std::shared_ptr<ast::Symbol> const& callee,
+        std::vector<std::unique_ptr<Expression>> const& arguments
+    );
+};
+
+// Compiles hot global functions into x86-64 machine code, for the kinds of
+// arguments they were called with so far, if those are all integers, reals
+// or booleans. Only functions of `while`, `cond`, `prog`, local variables,
+// constants and calls of arithmetic, comparison and logical built-ins are
+// compiled; any other function keeps being evaluated.
+//
+// Calls with arguments of other kinds, or after a built-in the code calls
+// was rebound, evaluate the function instead. So do calls whose code bails
+// out, which is only possible before it has any effect outside of the call.
+class Jit {
+  public:
+    static constexpr size_t HOT = 64;
+
+    static bool enabled;
+    // Whether compiled functions are written to `/tmp/perf-<pid>.map`, for
+    // profilers to name them
+    static bool perf_map;
+
+    // Returns the code of `definition`, a function defined in `global`, for
+    // arguments of `kinds`, or `nullptr` if it can't be compiled.
+    static std::unique_ptr<NativeFunction> compile(
+        Func const& definition,
+        std::vector<ast::Kinds> const& kinds,
+        Scope& global
+    );
+};
+
+} // namespace evaluator
@@ -0,0 +1,120 @@
+#include <utility>
+
+#include "loop_optimizer.h"
+#include "optimizer.h"
+
+namespace evaluator {
+
+LoopOptimizer::LoopOptimizer(Optimizer& optimizer) : optimizer(optimizer) {}
+
+Optimizer& LoopOptimizer::get_optimizer() { return this->optimizer; }
+
+bool LoopOptimizer::hoist(std::unique_ptr<Expression>& expression) {
+    if (!this->rewriting || this->loops.empty()) {
+        return expression->hoist_invariants(*this);
+    }
+
+    this->candidates.emplace_back();
+    bool invariant = expression->hoist_invariants(*this);
+    auto children = std::move(this->candidates.back());
+    this->candidates.pop_back();
+
+    if (invariant) {
+        this->candidates.back().push_back(&expression);
+    } else {
+        for (auto child : children) {
+            this->hoist_candidate(*child);
+        }
+    }
+    return invariant;
+}
+
+void LoopOptimizer::hoist(Body& body) {
+    for (auto& expression : body.body) {
+        this->hoist(expression);
+    }
+}
+
+std::vector<Invariant*> LoopOptimizer::hoist_loop(
+    std::unique_ptr<Expression>& condition, Body& body
+) {
+    this->loops.push_back(Loop{this->scopes.size(), {}, {}});
+
+    bool rewriting = this->rewriting;
+    this->rewriting = false;
+    this->hoist(condition);
+    this->hoist(body);
+    this->rewriting = rewriting;
+
+    if (rewriting) {
+        this->candidates.emplace_back();
+        this->hoist(condition);
+        this->hoist(body);
+        for (auto candidate : this->candidates.back()) {
+            this->hoist_candidate(*candidate);
+        }
+        this->candidates.pop_back();
+    }
+
+    auto loop = std::move(this->loops.back());
+    this->loops.pop_back();
+    return std::move(loop.invariants);
+}
+
+void LoopOptimizer::hoist_function(Parameters const& parameters, Body& body) {
+    auto scopes = std::exchange(this->scopes, ScopeTracker());
+    auto loops = std::move(this->loops);
+
+    this->loops.clear();
+    this->enter_scope(parameters, !body.may_capture_scope());
+    this->hoist(body);
+
+    this->scopes = std::move(scopes);
+    this->loops = std::move(loops);
+}
+
+bool LoopOptimizer::is_rewriting() const { return this->rewriting; }
+
+void LoopOptimizer::hoist_candidate(std::unique_ptr<Expression>& expression) {
+    // Variables and constants are as cheap to evaluate as invariants
+    if (dynamic_cast<Symbol*>(expression.get()) ||
+        dynamic_cast<Quote*>(expression.get())) {
+        return;
+    }
+
+    auto invariant = std::make_unique<Invariant>(std::move(expression));
+    this->loops.back().invariants.push_back(invariant.get());
+    expression = std::move(invariant);
+}
+
+void LoopOptimizer::enter_scope(Parameters const& parameters, bool tracked) {
+    this->scopes.enter_scope(parameters, tracked);
+}
+
+void LoopOptimizer::exit_scope() { this->scopes.exit_scope(); }
+
+bool LoopOptimizer::is_invariant(ast::Symbol const& variable) const {
+    if (this->loops.empty()) {
+        return false;
+    }
+
+    auto const& loop = this->loops.back();
+    auto frame = this->scopes.find_tracked(variable);
+    if (!frame || *frame >= loop.first_frame) {
+        return false;
+    }
+    return !loop.assigned.contains({*frame, variable.value});
+}
+
+void LoopOptimizer::assign(ast::Symbol const& variable) {
+    auto frame = this->scopes.find_frame(variable);
+    if (frame == this->scopes.size()) {
+        return;
+    }
+
+    for (auto& loop : this->loops) {
+        loop.assigned.emplace(frame, variable.value);
+    }
+}
+
+} // namespace evaluator
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../ast/element.h"
+#include "expression.h"
+#include "scope_tracker.h"
+
+namespace evaluator {
+
+class Optimizer;
+
+// Hoists loop-invariant expressions out of `while` loops by wrapping them in
+// `Invariant`, which evaluates them once per entry into the loop.
+//
+// An expression is invariant if it only calls pure built-ins and reads
+// variables that no code in the loop assigns, declared outside the loop by
+// scopes `ScopeTracker` tracks. `eval` called under another name isn't seen,
+// so calling it changes `Scope::version`, which makes invariants evaluate
+// again.
+//
+// Each loop is analyzed twice: the first pass only collects assigned
+// variables, and the second one hoists expressions.
+class LoopOptimizer {
+    struct Loop {
+        // Variables of frames from this one on are declared inside the loop
+        size_t first_frame;
+        std::set<std::pair<size_t, std::string>> assigned;
+        std::vector<Invariant*> invariants;
+    };
+
+    Optimizer& optimizer;
+    ScopeTracker scopes;
+    std::vector<Loop> loops;
+    // Invariant subexpressions of the expressions being visited, which are
+    // hoisted unless their parent turns out to be invariant as well
+    std::vector<std::vector<std::unique_ptr<Expression>*>> candidates;
+    bool rewriting = true;
+
+    void hoist_candidate(std::unique_ptr<Expression>& expression);
+
+  public:
+    LoopOptimizer(Optimizer& optimizer);
+
+    Optimizer& get_optimizer();
+
+    bool hoist(std::unique_ptr<Expression>& expression);
+    void hoist(Body& body);
+    // Returns the invariants hoisted out of the loop.
+    std::vector<Invariant*>
+    hoist_loop(std::unique_ptr<Expression>& condition, Body& body);
+    void hoist_function(Parameters const& parameters, Body& body);
+
+    // Whether expressions may be rewritten, which is only allowed once all
+    // assignments in the loops around them are known.
+    bool is_rewriting() const;
+
+    void enter_scope(Parameters const& parameters, bool tracked);
+    void exit_scope();
+
+    bool is_invariant(ast::Symbol const& variable) const;
+    void assign(ast::Symbol const& variable);
+};
+
+} // namespace evaluator
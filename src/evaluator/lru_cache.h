@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace evaluator {
+
+// A map of bounded size that evicts the least recently used entry when full.
+template <
+    typename Key,
+    typename Value,
+    typename Hash = std::hash<Key>,
+    typename Equal = std::equal_to<Key>>
+class LruCache {
+    using Entry = std::pair<Key, Value>;
+
+    // The most recently used entry goes first
+    std::list<Entry> entries;
+    std::unordered_map<
+        Key,
+        typename std::list<Entry>::iterator,
+        Hash,
+        Equal>
+        index;
+    size_t capacity;
+
+  public:
+    LruCache(size_t capacity) : capacity(capacity) {}
+
+    // Returns the value cached for `key`, or `nullptr` if there is none.
+    Value* find(Key const& key) {
+        auto found = this->index.find(key);
+        if (found == this->index.end()) {
+            return nullptr;
+        }
+
+        this->entries.splice(this->entries.begin(), this->entries, found->second);
+        return &found->second->second;
+    }
+
+    // Returns whether an entry had to be evicted to fit the new one.
+    bool insert(Key key, Value value) {
+        if (this->capacity == 0) {
+            return false;
+        }
+        if (auto existing = this->find(key)) {
+            *existing = std::move(value);
+            return false;
+        }
+
+        bool evicted = false;
+        if (this->entries.size() >= this->capacity) {
+            this->index.erase(this->entries.back().first);
+            this->entries.pop_back();
+            evicted = true;
+        }
+
+        this->entries.emplace_front(key, std::move(value));
+        this->index.emplace(std::move(key), this->entries.begin());
+        return evicted;
+    }
+
+    void clear() {
+        this->index.clear();
+        this->entries.clear();
+    }
+
+    size_t size() const { return this->entries.size(); }
+};
+
+} // namespace evaluator
@@ -0,0 +1,334 @@
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../utils.h"
+#include "error.h"
+#include "evaluator.h"
+#include "function.h"
+#include "lru_cache.h"
+#include "macros.h"
+
+namespace evaluator {
+
+using ast::Cons;
+using ast::Element;
+using ast::List;
+using ast::Span;
+using utils::to_cons;
+
+namespace {
+
+constexpr std::array SPECIAL_FORMS{
+    "quote",
+    "setq",
+    "func",
+    "lambda",
+    "prog",
+    "return",
+    "while",
+    "break",
+    "cond",
+    "switch",
+    "macro"
+};
+
+// Defined macros, and the evaluator their bodies run in
+class MacroTable {
+  public:
+    // Declared first, so the functions it created are released before it
+    Evaluator environment;
+    std::unordered_map<std::string, ElementGuard> expanders;
+    std::vector<Macros::Definition> definitions;
+    LruCache<std::shared_ptr<Cons>, std::shared_ptr<Element>> expansions;
+    size_t depth = 0;
+
+    MacroTable() : expansions(Macros::CACHE_CAPACITY) {}
+};
+
+MacroTable& table() {
+    static MacroTable table;
+    return table;
+}
+
+// Renames the variables an expansion declares, unless they come from the
+// arguments. Parts of the expansion that don't change are shared with it.
+class Hygiene {
+    // Elements the expansion took from the arguments of the form
+    std::unordered_set<Element const*> arguments;
+    // Names of the renamed variables in scope
+    std::unordered_map<std::string, std::string> renamed;
+
+    static size_t next;
+
+    void collect(std::shared_ptr<Element> const& element);
+    std::shared_ptr<List> rename_list(std::shared_ptr<List> const& list);
+    std::shared_ptr<List> rename_scope(std::shared_ptr<Cons> const& rest);
+
+  public:
+    Hygiene(std::shared_ptr<List> const& arguments);
+
+    std::shared_ptr<Element> rename(std::shared_ptr<Element> const& element);
+};
+
+size_t Hygiene::next = 0;
+
+Hygiene::Hygiene(std::shared_ptr<List> const& arguments) {
+    this->collect(arguments);
+}
+
+void Hygiene::collect(std::shared_ptr<Element> const& element) {
+    if (!this->arguments.insert(element.get()).second) {
+        return;
+    }
+    if (auto cons = std::dynamic_pointer_cast<Cons>(element)) {
+        this->collect(cons->left);
+        this->collect(cons->right);
+    }
+}
+
+std::shared_ptr<Element>
+Hygiene::rename(std::shared_ptr<Element> const& element) {
+    if (this->arguments.contains(element.get())) {
+        return element;
+    }
+
+    if (auto symbol = std::dynamic_pointer_cast<ast::Symbol>(element)) {
+        auto renamed = this->renamed.find(symbol->value);
+        if (renamed == this->renamed.end()) {
+            return element;
+        }
+        return std::make_shared<ast::Symbol>(renamed->second, symbol->span);
+    }
+
+    auto cons = std::dynamic_pointer_cast<Cons>(element);
+    if (!cons) {
+        return element;
+    }
+
+    if (auto head = std::dynamic_pointer_cast<ast::Symbol>(cons->left)) {
+        if (head->value == "quote") {
+            return element;
+        }
+
+        auto rest = to_cons(cons->right);
+        if (head->value == "func" && rest) {
+            // The name is defined where the expansion is, so only the
+            // parameters are renamed
+            if (auto scope = to_cons(rest->right)) {
+                auto renamed = this->rename_scope(scope);
+                if (renamed == scope) {
+                    return element;
+                }
+                return std::make_shared<Cons>(
+                    cons->left,
+                    std::make_shared<Cons>(rest->left, renamed, rest->span),
+                    cons->span
+                );
+            }
+        } else if (rest &&
+                   (head->value == "prog" || head->value == "lambda")) {
+            auto renamed = this->rename_scope(rest);
+            if (renamed == rest) {
+                return element;
+            }
+            return std::make_shared<Cons>(cons->left, renamed, cons->span);
+        }
+    }
+
+    return this->rename_list(cons);
+}
+
+std::shared_ptr<List> Hygiene::rename_list(std::shared_ptr<List> const& list) {
+    auto cons = to_cons(list);
+    if (!cons || this->arguments.contains(cons.get())) {
+        return list;
+    }
+
+    auto left = this->rename(cons->left);
+    auto right = this->rename_list(cons->right);
+    if (left == cons->left && right == cons->right) {
+        return list;
+    }
+    return std::make_shared<Cons>(
+        std::move(left), std::move(right), cons->span
+    );
+}
+
+// Renames the variables that `rest`, a parameter list followed by a body,
+// declares and uses.
+std::shared_ptr<List>
+Hygiene::rename_scope(std::shared_ptr<Cons> const& rest) {
+    if (this->arguments.contains(rest.get())) {
+        return rest;
+    }
+
+    auto parameters = std::dynamic_pointer_cast<List>(rest->left);
+    if (!parameters) {
+        // Left for the parser to report
+        return this->rename_list(rest);
+    }
+
+    auto outer = this->renamed;
+    std::vector<std::shared_ptr<Element>> renamed;
+    bool changed = false;
+    for (auto cons = to_cons(parameters); cons; cons = to_cons(cons->right)) {
+        auto parameter = std::dynamic_pointer_cast<ast::Symbol>(cons->left);
+        if (!parameter) {
+            return this->rename_list(rest);
+        }
+
+        if (this->arguments.contains(parameter.get())) {
+            // Variables of the arguments shadow renamed ones
+            this->renamed.erase(parameter->value);
+            renamed.push_back(parameter);
+        } else {
+            auto name =
+                parameter->value + "#" + std::to_string(Hygiene::next++);
+            this->renamed[parameter->value] = name;
+            renamed.push_back(
+                std::make_shared<ast::Symbol>(name, parameter->span)
+            );
+            changed = true;
+        }
+    }
+
+    std::shared_ptr<List> list = parameters;
+    if (changed) {
+        list = std::make_shared<ast::Null>(parameters->span);
+        for (auto parameter = renamed.rbegin(); parameter != renamed.rend();
+             ++parameter) {
+            list = std::make_shared<Cons>(*parameter, list, parameters->span);
+        }
+    }
+    auto body = this->rename_list(rest->right);
+    this->renamed = std::move(outer);
+
+    if (list == rest->left && body == rest->right) {
+        return rest;
+    }
+    return std::make_shared<Cons>(
+        std::move(list), std::move(body), rest->span
+    );
+}
+
+} // namespace
+
+size_t Macros::version = 0;
+std::unordered_map<std::string, size_t> Macros::shadowed;
+
+Macros::Shadow::Shadow(Parameters const& variables) {
+    for (auto const& variable : variables.parameters) {
+        ++Macros::shadowed[variable->value];
+        this->names.push_back(variable->value);
+    }
+}
+
+Macros::Shadow::~Shadow() {
+    for (auto const& name : this->names) {
+        auto shadowed = Macros::shadowed.find(name);
+        if (--shadowed->second == 0) {
+            Macros::shadowed.erase(shadowed);
+        }
+    }
+}
+
+bool Macros::is_defined(std::string const& name) {
+    return !Macros::shadowed.contains(name) &&
+           table().expanders.contains(name);
+}
+
+void Macros::define(Span span, std::shared_ptr<List> arguments) {
+    auto cons = to_cons(arguments);
+    if (!cons) {
+        throw EvaluationError(
+            "`macro` misses a macro name, a parameter list and a body", span
+        );
+    }
+
+    auto name = std::dynamic_pointer_cast<ast::Symbol>(cons->left);
+    if (!name) {
+        throw EvaluationError(
+            "`macro` expects a macro name as its first argument",
+            cons->left->span
+        );
+    }
+    for (auto form : SPECIAL_FORMS) {
+        if (name->value == form) {
+            throw EvaluationError(
+                "`macro` can't redefine the special form `" + name->value + "`",
+                name->span
+            );
+        }
+    }
+
+    std::vector<std::unique_ptr<Expression>> expressions;
+    expressions.push_back(Lambda::parse(span, cons->right));
+    Program program{Body(std::move(expressions))};
+
+    auto& table = evaluator::table();
+    auto expander = table.environment.evaluate(std::move(program));
+    table.expanders.erase(name->value);
+    table.expanders.emplace(name->value, std::move(expander));
+    table.definitions.push_back(Definition{span, std::move(arguments)});
+
+    // Forms expanded before may expand differently now
+    table.expansions.clear();
+    ++Macros::version;
+}
+
+std::vector<Macros::Definition> const& Macros::definitions() {
+    return table().definitions;
+}
+
+std::unique_ptr<Expression>
+Macros::expand(std::shared_ptr<Cons> const& form) {
+    auto& table = evaluator::table();
+    auto name = std::static_pointer_cast<ast::Symbol>(form->left);
+
+    if (table.depth == Macros::MAX_DEPTH) {
+        throw EvaluationError(
+            "macro `" + name->value + "` expands more than " +
+                std::to_string(Macros::MAX_DEPTH) + " levels deep",
+            form->span
+        );
+    }
+
+    std::shared_ptr<Element> expansion;
+    if (auto found = table.expansions.find(form)) {
+        expansion = *found;
+    } else {
+        std::vector<std::shared_ptr<Element>> arguments;
+        for (auto cons = to_cons(form->right); cons;
+             cons = to_cons(cons->right)) {
+            arguments.push_back(cons->left);
+        }
+
+        auto& expander = table.expanders.at(name->value);
+        auto function = std::dynamic_pointer_cast<Function>(*expander);
+        auto result = table.environment.call(*function, arguments, form->span);
+
+        expansion = Hygiene(form->right).rename(*result);
+        table.expansions.insert(form, expansion);
+    }
+
+    ++table.depth;
+    try {
+        auto expression = Expression::parse(expansion);
+        --table.depth;
+        return expression;
+    } catch (...) {
+        --table.depth;
+        throw;
+    }
+}
+
+void Macros::clear() {
+    auto& table = evaluator::table();
+    table.expanders.clear();
+    table.definitions.clear();
+    table.expansions.clear();
+    ++Macros::version;
+}
+
+} // namespace evaluator
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../ast/element.h"
+#include "expression.h"
+
+namespace evaluator {
+
+// Expands macros while code is parsed, so the code they generate is built
+// once, and then validated and optimized like code written by hand.
+//
+// `(macro name (parameters) body...)` defines a macro for all code parsed
+// after it, including by `eval`. A form starting with its name is replaced by
+// what the body returns when called with the forms of the arguments, which
+// aren't evaluated. Bodies are evaluated like lambdas, by an evaluator of
+// their own, since nothing of the program has run yet: they only see the
+// built-ins. Within `func`, `lambda` and `prog`, variables hide macros named
+// like them, so forms starting with those names stay calls.
+//
+// Expansions are hygienic in that variables they declare can't capture the
+// variables of the arguments: parameters of `prog`, `lambda` and `func` that
+// the macro built, rather than took from the arguments, are renamed to names
+// programs can't spell. Other variables keep their names, so they mean
+// whatever they mean where the macro is used.
+//
+// Expansions are cached by the identity of the form, so a form parsed again,
+// like one `eval` no longer has in its cache, isn't expanded again.
+class Macros {
+    // How many scopes around the code being parsed declare each name
+    static std::unordered_map<std::string, size_t> shadowed;
+
+  public:
+    // The arguments of a `macro` form, kept so that programs translated by
+    // `CppEmitter` can define the macros again for `eval`
+    struct Definition {
+        ast::Span span;
+        std::shared_ptr<ast::List> arguments;
+    };
+
+    static constexpr size_t CACHE_CAPACITY = 256;
+    // How deeply expansions may nest, to stop macros that expand forever
+    static constexpr size_t MAX_DEPTH = 256;
+
+    // Incremented whenever a macro is defined, so that code parsed before can
+    // be told apart
+    static size_t version;
+
+    // Hides macros named like `variables` while the body of the scope
+    // declaring them is parsed.
+    class Shadow {
+        std::vector<std::string> names;
+
+      public:
+        Shadow(Parameters const& variables);
+        Shadow(Shadow const&) = delete;
+        ~Shadow();
+    };
+
+    // Returns whether forms starting with `name` use a macro where the code
+    // being parsed is.
+    static bool is_defined(std::string const& name);
+    // Defines a macro from the arguments of a `macro` form.
+    static void define(ast::Span span, std::shared_ptr<ast::List> arguments);
+    // Returns the definitions of the macros, in the order they were defined.
+    static std::vector<Definition> const& definitions();
+    // Returns the expression a form using a macro expands to.
+    static std::unique_ptr<Expression>
+    expand(std::shared_ptr<ast::Cons> const& form);
+    // Forgets all macros, like between programs evaluated in one process.
+    static void clear();
+};
+
+} // namespace evaluator
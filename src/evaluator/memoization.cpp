@@ -0,0 +1,110 @@
+#include "memoization.h"
+#include "scope.h"
+
+namespace evaluator {
+
+using ast::Element;
+using ast::ElementKind;
+
+std::ostream& operator<<(std::ostream& stream, MemoStatistics const& self) {
+    auto calls = self.hits + self.misses;
+    stream << "memoization: " << self.hits << " hits, " << self.misses
+           << " misses";
+    if (calls > 0) {
+        stream << " (" << self.hits * 100 / calls << "% hit rate)";
+    }
+    stream << ", " << self.evictions << " evictions, " << self.invalidations
+           << " invalidations";
+    return stream;
+}
+
+bool MemoTable::automatic = false;
+MemoStatistics MemoTable::statistics;
+
+size_t MemoTable::ArgumentsHash::operator()(Arguments const& arguments) const {
+    size_t hash = arguments.size();
+    for (auto const& argument : arguments) {
+        hash = hash * 31 + ast::structural_hash(*argument);
+    }
+    return hash;
+}
+
+bool MemoTable::ArgumentsEqual::operator()(
+    Arguments const& a, Arguments const& b
+) const {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t index = 0; index < a.size(); ++index) {
+        if (!ast::structurally_equal(*a[index], *b[index])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Functions are compared by identity, and calling equal closures may give
+// different results, so values that contain functions aren't cached.
+bool is_plain_data(Element const& element) {
+    Element const* current = &element;
+    while (current->kind == ElementKind::CONS) {
+        auto cons = static_cast<ast::Cons const*>(current);
+        if (!is_plain_data(*cons->left)) {
+            return false;
+        }
+        current = cons->right.get();
+    }
+    return current->kind != ElementKind::FUNCTION;
+}
+
+bool is_plain_data(std::span<std::shared_ptr<Element> const> elements) {
+    for (auto const& element : elements) {
+        if (!is_plain_data(*element)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MemoTable::MemoTable() : cache(MemoTable::CAPACITY) {}
+
+std::shared_ptr<Element>
+MemoTable::find(std::span<std::shared_ptr<Element> const> arguments) {
+    if (this->version != Scope::version) {
+        if (this->cache.size() > 0) {
+            ++MemoTable::statistics.invalidations;
+        }
+        this->cache.clear();
+        this->version = Scope::version;
+    }
+
+    if (!is_plain_data(arguments)) {
+        return nullptr;
+    }
+
+    Arguments key(arguments.begin(), arguments.end());
+    if (auto result = this->cache.find(key)) {
+        ++MemoTable::statistics.hits;
+        return *result;
+    }
+    ++MemoTable::statistics.misses;
+    return nullptr;
+}
+
+void MemoTable::insert(
+    std::span<std::shared_ptr<Element> const> arguments,
+    std::shared_ptr<Element> result
+) {
+    // The call may have changed the version, e.g. by binding a new local name
+    if (this->version != Scope::version || !is_plain_data(arguments) ||
+        !is_plain_data(*result)) {
+        return;
+    }
+
+    Arguments key(arguments.begin(), arguments.end());
+    if (this->cache.insert(std::move(key), std::move(result))) {
+        ++MemoTable::statistics.evictions;
+    }
+}
+
+} // namespace evaluator
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "../ast/element.h"
+#include "lru_cache.h"
+
+namespace evaluator {
+
+class MemoStatistics {
+  public:
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t invalidations = 0;
+
+    friend std::ostream&
+    operator<<(std::ostream& stream, MemoStatistics const& self);
+};
+
+// Caches results of a pure function by its arguments, compared structurally.
+// The cache is dropped whenever `Scope::version` changes, since the function
+// may call global functions that have been replaced since.
+class MemoTable {
+    using Arguments = std::vector<std::shared_ptr<ast::Element>>;
+
+    struct ArgumentsHash {
+        size_t operator()(Arguments const& arguments) const;
+    };
+    struct ArgumentsEqual {
+        bool operator()(Arguments const& a, Arguments const& b) const;
+    };
+
+    LruCache<Arguments, std::shared_ptr<ast::Element>, ArgumentsHash, ArgumentsEqual>
+        cache;
+    uint64_t version = 0;
+
+  public:
+    static constexpr size_t CAPACITY = 4096;
+
+    // Whether pure user-defined functions are memoized without `memo`
+    static bool automatic;
+    static MemoStatistics statistics;
+
+    MemoTable();
+
+    // Returns the cached result of a call, or `nullptr` if there is none.
+    std::shared_ptr<ast::Element>
+    find(std::span<std::shared_ptr<ast::Element> const> arguments);
+    void insert(
+        std::span<std::shared_ptr<ast::Element> const> arguments,
+        std::shared_ptr<ast::Element> result
+    );
+};
+
+} // namespace evaluator
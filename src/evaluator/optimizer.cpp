@@ -0,0 +1,55 @@
+#include "optimizer.h"
+#include "function.h"
+
+namespace evaluator {
+
+Optimizer::Optimizer(
+    GarbageCollector* garbage_collector,
+    std::shared_ptr<Scope> global,
+    bool detached
+)
+    : garbage_collector(garbage_collector), global(global),
+      detached(detached) {}
+
+std::shared_ptr<Function>
+Optimizer::pure_built_in(ast::Symbol const& variable) const {
+    if (!this->detached && Scope::is_declared_local(variable.value)) {
+        return nullptr;
+    }
+
+    auto function = std::dynamic_pointer_cast<BuiltInFunction>(
+        this->global->find_variable(variable.value)
+    );
+    if (!function || !function->is_pure()) {
+        return nullptr;
+    }
+    return function;
+}
+
+bool Optimizer::never_evaluates(ast::Symbol const& variable) const {
+    if (!this->detached && Scope::is_declared_local(variable.value)) {
+        return false;
+    }
+
+    auto function = this->global->find_variable(variable.value);
+    return std::dynamic_pointer_cast<BuiltInFunction>(function) &&
+           !std::dynamic_pointer_cast<EvalFunction>(function);
+}
+
+EvaluationContext Optimizer::context() const {
+    return EvaluationContext(this->garbage_collector, this->global.get());
+}
+
+void Optimizer::fold_constants(std::unique_ptr<Expression>& expression) {
+    if (auto folded = expression->fold_constants(*this)) {
+        expression = std::move(folded);
+    }
+}
+
+void Optimizer::fold_constants(Body& body) {
+    for (auto& expression : body.body) {
+        this->fold_constants(expression);
+    }
+}
+
+} // namespace evaluator
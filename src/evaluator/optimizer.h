@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+
+#include "../ast/element.h"
+#include "expression.h"
+#include "scope.h"
+
+namespace evaluator {
+
+class Function;
+
+// Rewrites parsed programs into equivalent ones that are faster to evaluate.
+// Optimizations that rely on variables holding built-in functions record
+// their assumptions in a `BuiltInGuard` and keep the original expression to
+// fall back to, since a program may rebind any variable at runtime.
+class Optimizer {
+    GarbageCollector* garbage_collector;
+    std::shared_ptr<Scope> global;
+    // Set if `global` is a copy on another thread, holding only the built-ins
+    // no local variable shadowed when it was made
+    bool detached;
+
+  public:
+    Optimizer(
+        GarbageCollector* garbage_collector,
+        std::shared_ptr<Scope> global,
+        bool detached = false
+    );
+
+    // Returns the function `variable` refers to if it's a pure built-in
+    // function that may be relied on, or `nullptr` otherwise.
+    std::shared_ptr<Function> pure_built_in(ast::Symbol const& variable) const;
+    // Returns whether calling `variable` can't evaluate code in the scope of
+    // the caller, that is if it refers to a built-in function other than
+    // `eval` that may be relied on.
+    bool never_evaluates(ast::Symbol const& variable) const;
+
+    EvaluationContext context() const;
+
+    void fold_constants(std::unique_ptr<Expression>& expression);
+    void fold_constants(Body& body);
+};
+
+} // namespace evaluator
@@ -0,0 +1,81 @@
+#include "macros.h"
+#include "parse_cache.h"
+
+namespace evaluator {
+
+using ast::Element;
+
+std::ostream& operator<<(std::ostream& stream, ParseStatistics const& self) {
+    auto hits = self.identity_hits + self.structural_hits;
+    auto parses = hits + self.misses;
+    stream << "eval parse cache: " << self.identity_hits << " hits by identity, "
+           << self.structural_hits << " hits by contents, " << self.misses
+           << " misses";
+    if (parses > 0) {
+        stream << " (" << hits * 100 / parses << "% hit rate)";
+    }
+    stream << ", " << self.evictions << " evictions";
+    return stream;
+}
+
+ParseStatistics ParseCache::statistics;
+
+size_t ParseCache::IdentityHash::operator()(
+    std::shared_ptr<Element> const& element
+) const {
+    return std::hash<Element*>()(element.get());
+}
+
+bool ParseCache::IdentityEqual::operator()(
+    std::shared_ptr<Element> const& a, std::shared_ptr<Element> const& b
+) const {
+    return a == b;
+}
+
+size_t ParseCache::StructuralHash::operator()(
+    std::shared_ptr<Element> const& element
+) const {
+    return ast::structural_hash(*element);
+}
+
+bool ParseCache::StructuralEqual::operator()(
+    std::shared_ptr<Element> const& a, std::shared_ptr<Element> const& b
+) const {
+    return ast::structurally_equal(*a, *b);
+}
+
+ParseCache::ParseCache()
+    : by_identity(ParseCache::CAPACITY), by_contents(ParseCache::CAPACITY),
+      macros(Macros::version) {}
+
+std::shared_ptr<Expression const>
+ParseCache::parse(std::shared_ptr<Element> const& element) {
+    // Forms may use macros defined since they were parsed
+    if (this->macros != Macros::version) {
+        this->by_identity.clear();
+        this->by_contents.clear();
+        this->macros = Macros::version;
+    }
+
+    if (auto expression = this->by_identity.find(element)) {
+        ++ParseCache::statistics.identity_hits;
+        return *expression;
+    }
+
+    std::shared_ptr<Expression const> expression;
+    if (auto found = this->by_contents.find(element)) {
+        ++ParseCache::statistics.structural_hits;
+        expression = *found;
+    } else {
+        ++ParseCache::statistics.misses;
+        expression = Expression::parse(element);
+        if (this->by_contents.insert(element, expression)) {
+            ++ParseCache::statistics.evictions;
+        }
+    }
+
+    this->by_identity.insert(element, expression);
+    return expression;
+}
+
+} // namespace evaluator
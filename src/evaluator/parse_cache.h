@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+
+#include "../ast/element.h"
+#include "expression.h"
+#include "lru_cache.h"
+
+namespace evaluator {
+
+class ParseStatistics {
+  public:
+    size_t identity_hits = 0;
+    size_t structural_hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+
+    friend std::ostream&
+    operator<<(std::ostream& stream, ParseStatistics const& self);
+};
+
+// Remembers expressions `eval` parsed, so evaluating the same form again
+// doesn't parse and validate it again. Forms are looked up by identity first,
+// which is cheap and covers quoted forms evaluated in a loop, and then by
+// contents, which covers forms built anew each time.
+//
+// An expression found by contents keeps the spans of the form it was parsed
+// from, so errors point to where that form was built.
+class ParseCache {
+    struct IdentityHash {
+        size_t operator()(std::shared_ptr<ast::Element> const& element) const;
+    };
+    struct IdentityEqual {
+        bool operator()(
+            std::shared_ptr<ast::Element> const& a,
+            std::shared_ptr<ast::Element> const& b
+        ) const;
+    };
+    struct StructuralHash {
+        size_t operator()(std::shared_ptr<ast::Element> const& element) const;
+    };
+    struct StructuralEqual {
+        bool operator()(
+            std::shared_ptr<ast::Element> const& a,
+            std::shared_ptr<ast::Element> const& b
+        ) const;
+    };
+
+    // Expressions are shared so that evicting one doesn't destroy it while
+    // it is still being evaluated
+    template <typename Hash, typename Equal>
+    using Cache = LruCache<
+        std::shared_ptr<ast::Element>,
+        std::shared_ptr<Expression const>,
+        Hash,
+        Equal>;
+
+    Cache<IdentityHash, IdentityEqual> by_identity;
+    Cache<StructuralHash, StructuralEqual> by_contents;
+    // `Macros::version` when the caches were filled
+    size_t macros;
+
+  public:
+    static constexpr size_t CAPACITY = 256;
+
+    static ParseStatistics statistics;
+
+    ParseCache();
+
+    std::shared_ptr<Expression const>
+    parse(std::shared_ptr<ast::Element> const& element);
+};
+
+} // namespace evaluator
@@ -0,0 +1,150 @@
+#include "partial_evaluation.h"
+#include "error.h"
+#include "function.h"
+#include "optimizer.h"
+#include "pass_manager.h"
+
+namespace evaluator {
+
+PartialEvaluator::PartialEvaluator(
+    std::span<std::shared_ptr<ast::Symbol> const> parameters,
+    std::span<std::shared_ptr<ast::Element> const> values,
+    Optimizer const& optimizer
+)
+    : optimizer(optimizer) {
+    for (size_t index = 0; index < values.size(); ++index) {
+        this->values[parameters[index]->value] = values[index];
+    }
+}
+
+std::shared_ptr<UserDefinedFunction> PartialEvaluator::specialize(
+    std::shared_ptr<UserDefinedFunction> const& function,
+    std::span<std::shared_ptr<ast::Element> const> values,
+    ast::Span call_site,
+    GarbageCollector* garbage_collector
+) {
+    auto const& parameters = function->parameters.parameters;
+    if (values.size() > parameters.size()) {
+        throw EvaluationError(
+            "`specialize` received " + std::to_string(values.size()) +
+                " values for a function of " +
+                std::to_string(parameters.size()) + " parameters",
+            call_site
+        );
+    }
+
+    auto parent = function->scope.lock();
+    if (!parent) {
+        throw std::logic_error(
+            "Failed to specialize a user-defined function because the garbage "
+            "collector dropped its parent scope too early. This is a bug."
+        );
+    }
+
+    // The scope of the new function keeps the values, so the garbage
+    // collector sees what they refer to even once they are in the body
+    auto bound = std::span(parameters).first(values.size());
+    auto scope = parent->create_child();
+    for (size_t index = 0; index < values.size(); ++index) {
+        scope->define(*bound[index], values[index]);
+    }
+    Parameters remaining(
+        function->span,
+        std::vector(parameters.begin() + values.size(), parameters.end())
+    );
+
+    Optimizer optimizer(garbage_collector, parent->global());
+    PartialEvaluator evaluator(bound, values, optimizer);
+    if (auto copy = evaluator.copy(*function->body)) {
+        auto body = std::make_shared<Body>(std::move(*copy));
+
+        // Passes take variables declared nowhere for globals, so closures only
+        // get all of them
+        if (parent->is_global()) {
+            std::vector<std::unique_ptr<Expression>> expressions;
+            expressions.push_back(
+                std::make_unique<Lambda>(function->span, remaining, body)
+            );
+            Program program{Body(std::move(expressions))};
+            PassManager::run_detached(program, optimizer);
+        } else {
+            optimizer.fold_constants(*body);
+        }
+
+        return std::make_shared<SpecializedFunction>(
+            function, std::move(remaining), std::move(body), std::move(scope)
+        );
+    }
+
+    std::vector<std::unique_ptr<Expression>> arguments;
+    for (auto const& value : values) {
+        arguments.push_back(std::make_unique<Quote>(value->span, value));
+    }
+    for (auto const& parameter : remaining.parameters) {
+        arguments.push_back(std::make_unique<Symbol>(parameter));
+    }
+    std::vector<std::unique_ptr<Expression>> call;
+    call.push_back(std::make_unique<Call>(
+        function->span,
+        std::make_unique<Quote>(function->span, function),
+        std::move(arguments)
+    ));
+
+    return std::make_shared<SpecializedFunction>(
+        function,
+        std::move(remaining),
+        std::make_shared<Body>(std::move(call)),
+        std::move(scope)
+    );
+}
+
+bool PartialEvaluator::is_known(ast::Symbol const& variable) const {
+    return this->values.contains(variable.value) &&
+           !this->shadowed.contains(variable.value);
+}
+
+std::unique_ptr<Expression>
+PartialEvaluator::copy(Expression const& expression) {
+    return expression.partial_copy(*this);
+}
+
+std::optional<Body> PartialEvaluator::copy(Body const& body) {
+    return body.partial_copy(*this);
+}
+
+std::optional<Body>
+PartialEvaluator::copy_scope(Parameters const& variables, Body const& body) {
+    for (auto const& variable : variables.parameters) {
+        ++this->shadowed[variable->value];
+    }
+
+    auto copy = this->copy(body);
+
+    for (auto const& variable : variables.parameters) {
+        auto shadowed = this->shadowed.find(variable->value);
+        if (--shadowed->second == 0) {
+            this->shadowed.erase(shadowed);
+        }
+    }
+    return copy;
+}
+
+std::unique_ptr<Expression>
+PartialEvaluator::read(std::shared_ptr<ast::Symbol> const& variable) const {
+    if (this->is_known(*variable)) {
+        return std::make_unique<Quote>(
+            variable->span, this->values.at(variable->value)
+        );
+    }
+    return std::make_unique<Symbol>(variable);
+}
+
+bool PartialEvaluator::assign(ast::Symbol const& variable) const {
+    return !this->is_known(variable);
+}
+
+bool PartialEvaluator::call(ast::Symbol const* callee) const {
+    return callee && this->optimizer.never_evaluates(*callee);
+}
+
+} // namespace evaluator
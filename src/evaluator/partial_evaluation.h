@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../ast/element.h"
+#include "expression.h"
+
+namespace evaluator {
+
+class Optimizer;
+class UserDefinedFunction;
+
+// Specializes user-defined functions for known values of their leading
+// parameters, for `specialize`. The body is copied with reads of those
+// parameters replaced by their values, and the copy is optimized like a
+// program, so that what only depends on them is folded away.
+//
+// Copies are made of expressions as parsed: optimized ones are copied from
+// the expression they fall back to. A parameter is only replaced if the body
+// can't assign it, that is if it has no `setq` or `func` of the parameter
+// where it isn't shadowed and calls no function that may be `eval`, which is
+// any function but the other built-ins. Otherwise, or if the body can't be
+// copied, the function calls the original one instead.
+class PartialEvaluator {
+    // Values of the parameters being replaced
+    std::unordered_map<std::string, std::shared_ptr<ast::Element>> values;
+    // How many scopes around the current expression declare each name
+    std::unordered_map<std::string, size_t> shadowed;
+    Optimizer const& optimizer;
+
+    bool is_known(ast::Symbol const& variable) const;
+
+  public:
+    PartialEvaluator(
+        std::span<std::shared_ptr<ast::Symbol> const> parameters,
+        std::span<std::shared_ptr<ast::Element> const> values,
+        Optimizer const& optimizer
+    );
+
+    // Returns a function that calls `function` with `values` before its
+    // arguments.
+    static std::shared_ptr<UserDefinedFunction> specialize(
+        std::shared_ptr<UserDefinedFunction> const& function,
+        std::span<std::shared_ptr<ast::Element> const> values,
+        ast::Span call_site,
+        GarbageCollector* garbage_collector
+    );
+
+    // Returns the copy of the expression, or `nullptr` if it can't be copied.
+    std::unique_ptr<Expression> copy(Expression const& expression);
+    std::optional<Body> copy(Body const& body);
+    // Copies a body evaluated in a scope declaring `variables`.
+    std::optional<Body>
+    copy_scope(Parameters const& variables, Body const& body);
+
+    // Returns an expression reading `variable` in the copy.
+    std::unique_ptr<Expression>
+    read(std::shared_ptr<ast::Symbol> const& variable) const;
+    // Returns whether `variable` may be assigned or defined in the copy.
+    bool assign(ast::Symbol const& variable) const;
+    // Returns whether the copy may call `callee`, or a computed function if
+    // it's null.
+    bool call(ast::Symbol const* callee) const;
+};
+
+} // namespace evaluator
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <iostream>
+
+#include "closure_conversion.h"
+#include "common_subexpressions.h"
+#include "dead_code.h"
+#include "inliner.h"
+#include "loop_optimizer.h"
+#include "optimizer.h"
+#include "pass_manager.h"
+#include "type_inference.h"
+#include "unboxing.h"
+
+namespace evaluator {
+
+std::ostream& operator<<(std::ostream& stream, PassStatistics const& self) {
+    stream << "optimization passes:";
+    bool first = true;
+    for (auto const& pass : self.passes) {
+        if (pass.runs == 0) {
+            continue;
+        }
+
+        auto time =
+            std::chrono::duration_cast<std::chrono::microseconds>(pass.time);
+        stream << (first ? " " : ", ") << pass.name << ' ' << time.count()
+               << " us";
+        first = false;
+    }
+    if (first) {
+        stream << " none ran";
+    }
+    return stream;
+}
+
+unsigned PassManager::level = PassManager::MAX_LEVEL;
+std::string PassManager::dump_after;
+PassStatistics PassManager::statistics;
+
+// Every pass keeps the program evaluating the same on its own, so the passes
+// of a level may run without the ones above it.
+static PassManager::Pass const PASSES[] = {
+    {"dead-code",
+     1,
+     [](Program& program, Optimizer&) {
+         DeadCodeEliminator eliminator;
+         program.eliminate_dead_code(eliminator);
+     }},
+    {"closure-conversion",
+     1,
+     [](Program& program, Optimizer& optimizer) {
+         ClosureConverter converter(optimizer);
+         program.convert_closures(converter);
+     }},
+    {"inlining",
+     2,
+     [](Program& program, Optimizer& optimizer) {
+         if (Inliner::enabled) {
+             Inliner inliner(optimizer);
+             program.inline_calls(inliner);
+         }
+     }},
+    {"common-subexpressions",
+     2,
+     [](Program& program, Optimizer& optimizer) {
+         CommonSubexpressionEliminator eliminator(optimizer);
+         program.eliminate_common_subexpressions(eliminator);
+     }},
+    {"constant-folding",
+     1,
+     [](Program& program, Optimizer& optimizer) {
+         program.fold_constants(optimizer);
+     }},
+    {"type-inference",
+     1,
+     [](Program& program, Optimizer& optimizer) {
+         TypeInference inference(optimizer);
+         program.infer_types(inference);
+     }},
+    {"unboxing",
+     2,
+     [](Program& program, Optimizer&) {
+         Unboxer unboxer;
+         program.unbox(unboxer);
+     }},
+    {"loop-invariants",
+     2,
+     [](Program& program, Optimizer& optimizer) {
+         LoopOptimizer loop_optimizer(optimizer);
+         program.hoist_invariants(loop_optimizer);
+     }},
+};
+
+std::span<PassManager::Pass const> PassManager::passes() { return PASSES; }
+
+bool PassManager::has_pass(std::string_view name) {
+    return std::ranges::any_of(PASSES, [name](Pass const& pass) {
+        return pass.name == name;
+    });
+}
+
+void PassManager::run(
+    Program& program, Optimizer& optimizer, unsigned level
+) {
+    auto& statistics = PassManager::statistics.passes;
+    if (statistics.empty()) {
+        for (auto const& pass : PASSES) {
+            statistics.push_back(PassStatistics::Pass{pass.name});
+        }
+    }
+
+    for (size_t index = 0; index < std::size(PASSES); ++index) {
+        auto const& pass = PASSES[index];
+        if (pass.level <= level) {
+            auto start = std::chrono::steady_clock::now();
+            pass.run(program, optimizer);
+            statistics[index].time += std::chrono::steady_clock::now() - start;
+            ++statistics[index].runs;
+        }
+
+        if (pass.name == PassManager::dump_after) {
+            std::cout << "; after " << pass.name << '\n'
+                      << program << std::endl;
+        }
+    }
+}
+
+void PassManager::run_detached(Program& program, Optimizer& optimizer) {
+    for (auto const& pass : PASSES) {
+        if (pass.level <= PassManager::level) {
+            pass.run(program, optimizer);
+        }
+    }
+}
+
+} // namespace evaluator
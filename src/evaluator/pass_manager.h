@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "expression.h"
+
+namespace evaluator {
+
+class Optimizer;
+
+class PassStatistics {
+  public:
+    struct Pass {
+        std::string_view name;
+        size_t runs = 0;
+        std::chrono::nanoseconds time{0};
+    };
+
+    // In the order the passes run
+    std::vector<Pass> passes;
+
+    friend std::ostream&
+    operator<<(std::ostream& stream, PassStatistics const& self);
+};
+
+// Runs the optimizations of a program as a sequence of passes, each rewriting
+// the expression tree in place. A pass runs at its own optimization level and
+// above, so `-O0` evaluates the program as parsed. Each pass is timed, and the
+// program can be printed after any of them.
+class PassManager {
+  public:
+    struct Pass {
+        std::string_view name;
+        // The lowest optimization level the pass runs at
+        unsigned level;
+        void (*run)(Program& program, Optimizer& optimizer);
+    };
+
+    static constexpr unsigned MAX_LEVEL = 2;
+
+    static unsigned level;
+    // The pass to print the program after, or an empty string for none
+    static std::string dump_after;
+    static PassStatistics statistics;
+
+    // Returns the passes in the order they run.
+    static std::span<Pass const> passes();
+    static bool has_pass(std::string_view name);
+
+    // Runs the passes up to `level` on the program.
+    static void run(Program& program, Optimizer& optimizer, unsigned level);
+    // Runs the passes of the current level on a program optimized while
+    // another one runs, on another thread or for `specialize`, which neither
+    // times nor prints them.
+    static void run_detached(Program& program, Optimizer& optimizer);
+};
+
+} // namespace evaluator
@@ -0,0 +1,77 @@
+#include "purity.h"
+#include "error.h"
+#include "function.h"
+
+namespace evaluator {
+
+bool PurityAnalysis::is_pure(UserDefinedFunction const& function) {
+    if (auto found = this->functions.find(&function);
+        found != this->functions.end()) {
+        return found->second;
+    }
+
+    auto closure = function.scope.lock();
+    if (!closure) {
+        return false;
+    }
+
+    this->functions[&function] = true;
+
+    auto scopes = std::move(this->scopes);
+    auto outer_closure = this->closure;
+    this->scopes.clear();
+    this->closure = closure.get();
+
+    this->enter_scope(function.parameters);
+    bool pure = function.body->is_pure(*this);
+
+    this->scopes = std::move(scopes);
+    this->closure = outer_closure;
+
+    this->functions[&function] = pure;
+    return pure;
+}
+
+void PurityAnalysis::enter_scope(Parameters const& parameters) {
+    std::unordered_set<std::string> scope;
+    for (auto const& parameter : parameters.parameters) {
+        scope.insert(parameter->value);
+    }
+    this->scopes.push_back(std::move(scope));
+}
+
+void PurityAnalysis::exit_scope() { this->scopes.pop_back(); }
+
+bool PurityAnalysis::is_local(ast::Symbol const& variable) const {
+    for (auto const& scope : this->scopes) {
+        if (scope.contains(variable.value)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PurityAnalysis::is_pure_function(ast::Symbol const& variable) {
+    // A variable that was ever bound locally may resolve to something else
+    // when the function is called from another place
+    if (Scope::is_declared_local(variable.value)) {
+        return false;
+    }
+
+    std::shared_ptr<ast::Element> value;
+    try {
+        value = this->closure->lookup(variable);
+    } catch (EvaluationError const&) {
+        return false;
+    }
+
+    if (auto function = std::dynamic_pointer_cast<UserDefinedFunction>(value)) {
+        return this->is_pure(*function);
+    }
+    if (auto function = std::dynamic_pointer_cast<Function>(value)) {
+        return function->is_pure();
+    }
+    return false;
+}
+
+} // namespace evaluator
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../ast/element.h"
+#include "expression.h"
+#include "scope.h"
+
+namespace evaluator {
+
+class UserDefinedFunction;
+
+// Decides whether user-defined functions are pure: they assign only their own
+// variables, read nothing but their own variables and pure global functions,
+// and call only pure functions. Calls to a pure function with equal arguments
+// always have equal results, as long as `Scope::version` stays the same.
+class PurityAnalysis {
+    std::vector<std::unordered_set<std::string>> scopes;
+    Scope* closure = nullptr;
+    // Functions being analyzed are assumed to be pure, so recursive functions
+    // may be pure too
+    std::unordered_map<UserDefinedFunction const*, bool> functions;
+
+  public:
+    bool is_pure(UserDefinedFunction const& function);
+
+    void enter_scope(Parameters const& parameters);
+    void exit_scope();
+
+    bool is_local(ast::Symbol const& variable) const;
+    // Whether the variable is global and holds a pure function.
+    bool is_pure_function(ast::Symbol const& variable);
+};
+
+} // namespace evaluator
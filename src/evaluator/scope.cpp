@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -7,12 +8,40 @@
 
 namespace evaluator {
 
-Scope::Scope(std::shared_ptr<Scope> parent) : parent(parent) {}
+uint64_t Scope::version = 1;
+std::unordered_set<std::string> Scope::local_names;
+
+Scope::Scope(std::shared_ptr<Scope> parent) : parent(parent) {
+    if (parent == nullptr) {
+        ++Scope::version;
+    }
+}
 
 void Scope::define(
     ast::Symbol const& symbol, std::shared_ptr<ast::Element> value
 ) {
-    this->variables[symbol.value] = value;
+    auto& variable = this->variables[symbol.value];
+
+    if (this->parent != nullptr) {
+        Scope::declare_local(symbol.value);
+    } else if (variable && variable->kind == ast::ElementKind::FUNCTION) {
+        ++Scope::version;
+    }
+
+    variable = value;
+}
+
+void Scope::declare_local(std::string const& name) {
+    if (!Scope::local_names.contains(name)) {
+        Scope::local_names.insert(name);
+        ++Scope::version;
+    }
+}
+
+bool Scope::is_global() const { return this->parent == nullptr; }
+
+bool Scope::is_declared_local(std::string const& name) {
+    return Scope::local_names.contains(name);
 }
 
 Scope* Scope::find_scope(ast::Symbol const& symbol) {
@@ -47,6 +76,98 @@ std::shared_ptr<ast::Element> Scope::lookup(ast::Symbol const& symbol) {
     );
 }
 
+std::shared_ptr<ast::Element> Scope::find_variable(std::string const& name) {
+    auto variable = this->variables.find(name);
+    if (variable == this->variables.end()) {
+        return nullptr;
+    }
+    return variable->second;
+}
+
+std::weak_ptr<Scope> Scope::capture() {
+    this->captured = true;
+    return this->weak_from_this();
+}
+
+std::shared_ptr<Scope>
+Scope::copy(std::vector<std::shared_ptr<ast::Symbol>> const& variables) {
+    auto scope = this->global()->create_child();
+    for (auto const& variable : variables) {
+        scope->define(*variable, this->lookup(*variable));
+    }
+    return scope;
+}
+
+std::shared_ptr<Scope> Scope::create_child() {
+    return std::shared_ptr<Scope>(new Scope(this->shared_from_this()));
+}
+
+std::shared_ptr<Scope> Scope::global() {
+    auto global = this;
+    while (global->parent != nullptr) {
+        global = global->parent.get();
+    }
+    return global->shared_from_this();
+}
+
+ArgumentWindow ArgumentStack::allocate(size_t count) {
+    auto previous_chunk = this->current;
+    if (this->chunks.empty() ||
+        this->chunks[this->current].size - this->chunks[this->current].used <
+            count) {
+        if (!this->chunks.empty()) {
+            ++this->current;
+        }
+
+        // Chunks after the current one are empty, so a chunk that is too small
+        // can be replaced
+        auto size = std::max(ArgumentStack::CHUNK_SIZE, count);
+        if (this->current == this->chunks.size()) {
+            this->chunks.emplace_back();
+        }
+        auto& chunk = this->chunks[this->current];
+        if (!chunk.slots || chunk.size < count) {
+            chunk.slots =
+                std::make_unique<std::shared_ptr<ast::Element>[]>(size);
+            chunk.size = size;
+        }
+    }
+
+    auto& chunk = this->chunks[this->current];
+    std::span<std::shared_ptr<ast::Element>> slots(
+        chunk.slots.get() + chunk.used, count
+    );
+    chunk.used += count;
+
+    return ArgumentWindow(this, this->current, previous_chunk, slots);
+}
+
+ArgumentWindow::ArgumentWindow(
+    ArgumentStack* stack,
+    size_t chunk,
+    size_t previous_chunk,
+    std::span<std::shared_ptr<ast::Element>> slots
+)
+    : stack(stack), chunk(chunk), previous_chunk(previous_chunk),
+      slots(slots) {}
+
+ArgumentWindow::~ArgumentWindow() {
+    for (auto& slot : this->slots) {
+        slot.reset();
+    }
+    this->stack->chunks[this->chunk].used -= this->slots.size();
+    this->stack->current = this->previous_chunk;
+}
+
+std::shared_ptr<ast::Element>& ArgumentWindow::operator[](size_t index) {
+    return this->slots[index];
+}
+
+std::span<std::shared_ptr<ast::Element> const>
+ArgumentWindow::arguments() const {
+    return this->slots;
+}
+
 GarbageCollector::GarbageCollector() {}
 
 ScopeGuard GarbageCollector::create_scope(std::shared_ptr<Scope> parent) {
@@ -57,9 +178,55 @@ ScopeGuard GarbageCollector::create_scope(std::shared_ptr<Scope> parent) {
     return ScopeGuard(this, scope);
 }
 
+ScopeGuard GarbageCollector::create_local_scope(std::shared_ptr<Scope> parent
+) {
+    std::shared_ptr<Scope> scope;
+    if (this->free_scopes.empty()) {
+        scope.reset(new Scope(parent));
+    } else {
+        scope = std::move(this->free_scopes.back());
+        this->free_scopes.pop_back();
+        scope->parent = std::move(parent);
+    }
+    this->local_scopes.push_back(scope);
+    return ScopeGuard(this, scope, true);
+}
+
+void GarbageCollector::release_local_scope(std::shared_ptr<Scope> scope) {
+    if (this->local_scopes.back() == scope) {
+        this->local_scopes.pop_back();
+    } else {
+        this->local_scopes.erase(
+            std::find(this->local_scopes.begin(), this->local_scopes.end(), scope)
+        );
+    }
+
+    if (scope->captured) {
+        // Only `eval` called through another name can get here, as the
+        // analysis can't see it
+        this->dead_scopes.insert(std::move(scope));
+        return;
+    }
+
+    // Nested scopes may still refer to it while they unwind
+    if (scope.use_count() == 1 &&
+        this->free_scopes.size() < GarbageCollector::MAX_FREE_SCOPES) {
+        scope->variables.clear();
+        scope->parent = nullptr;
+        this->free_scopes.push_back(std::move(scope));
+    }
+}
+
+ArgumentWindow GarbageCollector::allocate_arguments(size_t count) {
+    return this->argument_stack.allocate(count);
+}
+
 ElementGuard GarbageCollector::temporary(std::shared_ptr<ast::Element> value) {
-    if (auto function = std::dynamic_pointer_cast<UserDefinedFunction>(value)) {
-        this->temporary_functions.insert(function);
+    if (value->kind == ast::ElementKind::FUNCTION) {
+        if (auto function =
+                std::dynamic_pointer_cast<UserDefinedFunction>(value)) {
+            this->temporary_functions.insert(function);
+        }
     }
     return ElementGuard(this, value);
 }
@@ -131,15 +298,39 @@ void GarbageCollector::collect() {
             return;
         }
     }
+    for (auto& scope : this->local_scopes) {
+        if (visitor.visit_scope(scope)) {
+            return;
+        }
+    }
+    auto const& chunks = this->argument_stack.chunks;
+    for (size_t index = 0; index < chunks.size(); ++index) {
+        for (size_t slot = 0; slot < chunks[index].used; ++slot) {
+            if (auto function = std::dynamic_pointer_cast<UserDefinedFunction>(
+                    chunks[index].slots[slot]
+                )) {
+                if (visitor.visit_function(function)) {
+                    return;
+                }
+            }
+        }
+    }
 
     this->dead_scopes = std::move(visitor.next_dead_scopes);
 }
 
-ScopeGuard::ScopeGuard(GarbageCollector* gc, std::shared_ptr<Scope> scope)
-    : garbage_collector(gc), scope(scope) {}
+ScopeGuard::ScopeGuard(
+    GarbageCollector* gc, std::shared_ptr<Scope> scope, bool local
+)
+    : garbage_collector(gc), scope(scope), local(local) {}
 
 ScopeGuard::~ScopeGuard() {
-    if (!this->garbage_collector) {
+    if (!this->garbage_collector || !this->scope) {
+        return;
+    }
+
+    if (this->local) {
+        this->garbage_collector->release_local_scope(std::move(this->scope));
         return;
     }
 
@@ -149,6 +340,7 @@ ScopeGuard::~ScopeGuard() {
 
 std::shared_ptr<Scope> ScopeGuard::operator*() { return this->scope; }
 std::shared_ptr<Scope> ScopeGuard::operator->() { return this->scope; }
+Scope* ScopeGuard::get() const { return this->scope.get(); }
 
 ElementGuard::ElementGuard(
     GarbageCollector* gc, std::shared_ptr<ast::Element> element
@@ -160,9 +352,11 @@ ElementGuard::~ElementGuard() {
         return;
     }
 
-    if (auto function =
-            std::dynamic_pointer_cast<UserDefinedFunction>(this->element)) {
-        this->garbage_collector->temporary_functions.erase(function);
+    if (this->element && this->element->kind == ast::ElementKind::FUNCTION) {
+        if (auto function =
+                std::dynamic_pointer_cast<UserDefinedFunction>(this->element)) {
+            this->garbage_collector->temporary_functions.erase(function);
+        }
     }
     if (this->collect_garbage) {
         this->garbage_collector->collect();
@@ -177,6 +371,8 @@ std::shared_ptr<ast::Element> ElementGuard::operator->() {
     return this->element;
 }
 
+ast::Element* ElementGuard::get() const { return this->element.get(); }
+
 void ElementGuard::deactivate() { this->collect_garbage = false; }
 
 } // namespace evaluator
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "../ast/element.h"
 
@@ -11,9 +14,13 @@ namespace evaluator {
 
 class UserDefinedFunction;
 
-class Scope {
+class Scope : public std::enable_shared_from_this<Scope> {
     std::unordered_map<std::string, std::shared_ptr<ast::Element>> variables;
     std::shared_ptr<Scope> parent;
+    // Whether a closure was defined in the scope
+    bool captured = false;
+
+    static std::unordered_set<std::string> local_names;
 
     Scope(std::shared_ptr<Scope> parent);
 
@@ -26,25 +33,114 @@ class Scope {
         ast::Symbol const& symbol, std::shared_ptr<ast::Element> value
     );
     std::shared_ptr<ast::Element> lookup(ast::Symbol const& symbol);
-
+    // Unlike `lookup`, doesn't look into parent scopes and returns `nullptr`
+    // if the variable is not defined.
+    std::shared_ptr<ast::Element> find_variable(std::string const& name);
+    // The reference closures defined in the scope keep to it.
+    std::weak_ptr<Scope> capture();
+    // Creates a scope directly under the global one, holding the current
+    // values of `variables`.
+    std::shared_ptr<Scope>
+    copy(std::vector<std::shared_ptr<ast::Symbol>> const& variables);
+    // Creates an empty scope under this one, which only the caller refers to,
+    // like the scope `copy` creates.
+    std::shared_ptr<Scope> create_child();
+    std::shared_ptr<Scope> global();
+    bool is_global() const;
+
+    // Incremented every time a binding changes in a way that may invalidate
+    // global lookups cached at call sites: a global function is replaced, a
+    // new global scope is created, or a name is bound in a local scope for the
+    // first time.
+    static uint64_t version;
+
+    // Whether `name` has ever been bound in a non-global scope, in which case
+    // lookups of it may resolve differently depending on the starting scope.
+    static bool is_declared_local(std::string const& name);
+    static void declare_local(std::string const& name);
+
+    friend class BackgroundOptimizer;
     friend class GarbageCollector;
     friend class ScopeVisitor;
 };
 
 class ScopeGuard;
 class ElementGuard;
+class ArgumentWindow;
+
+// Slots that arguments of calls are evaluated into. Slots are allocated in
+// chunks that are never moved, so a window stays valid while nested calls
+// allocate their own, and once the stack has grown deep enough, passing
+// arguments doesn't allocate at all.
+class ArgumentStack {
+    static constexpr size_t CHUNK_SIZE = 256;
+
+    struct Chunk {
+        std::unique_ptr<std::shared_ptr<ast::Element>[]> slots;
+        size_t size;
+        size_t used = 0;
+    };
+
+    std::vector<Chunk> chunks;
+    size_t current = 0;
+
+  public:
+    ArgumentWindow allocate(size_t count);
+
+    friend class ArgumentWindow;
+    friend class GarbageCollector;
+};
+
+// Slots for arguments of a single call. Windows must be destroyed in the
+// reverse order of allocation, which clears their slots.
+class ArgumentWindow {
+    ArgumentStack* stack;
+    size_t chunk;
+    size_t previous_chunk;
+    std::span<std::shared_ptr<ast::Element>> slots;
+
+    ArgumentWindow(
+        ArgumentStack* stack,
+        size_t chunk,
+        size_t previous_chunk,
+        std::span<std::shared_ptr<ast::Element>> slots
+    );
+
+  public:
+    ArgumentWindow(ArgumentWindow const&) = delete;
+    ~ArgumentWindow();
+
+    std::shared_ptr<ast::Element>& operator[](size_t index);
+    std::span<std::shared_ptr<ast::Element> const> arguments() const;
+
+    friend class ArgumentStack;
+};
 
 class GarbageCollector {
+    static constexpr size_t MAX_FREE_SCOPES = 64;
+
     std::unordered_set<std::shared_ptr<Scope>> alive_scopes;
     std::unordered_set<std::shared_ptr<Scope>> dead_scopes;
+    // Scopes created by `create_local_scope`, innermost last
+    std::vector<std::shared_ptr<Scope>> local_scopes;
+    std::vector<std::shared_ptr<Scope>> free_scopes;
     std::unordered_set<std::shared_ptr<UserDefinedFunction>>
         temporary_functions;
+    ArgumentStack argument_stack;
+
+    void release_local_scope(std::shared_ptr<Scope> scope);
 
   public:
     GarbageCollector();
 
     ScopeGuard create_scope(std::shared_ptr<Scope> parent);
+    // For scopes that no closure captures, so nothing can reach them once
+    // their guard is destroyed. They are only tracked as roots while alive and
+    // are recycled afterwards, instead of waiting for a collection.
+    ScopeGuard create_local_scope(std::shared_ptr<Scope> parent);
     ElementGuard temporary(std::shared_ptr<ast::Element> value);
+    // Arguments in the window are protected until it's destroyed.
+    ArgumentWindow allocate_arguments(size_t count);
 
     void collect();
 
@@ -55,8 +151,9 @@ class GarbageCollector {
 class ScopeGuard {
     GarbageCollector* garbage_collector;
     std::shared_ptr<Scope> scope;
+    bool local;
 
-    ScopeGuard(GarbageCollector*, std::shared_ptr<Scope>);
+    ScopeGuard(GarbageCollector*, std::shared_ptr<Scope>, bool local = false);
 
   public:
     ScopeGuard(ScopeGuard const&) = delete;
@@ -64,6 +161,7 @@ class ScopeGuard {
     ~ScopeGuard();
     std::shared_ptr<Scope> operator*();
     std::shared_ptr<Scope> operator->();
+    Scope* get() const;
 
     friend class GarbageCollector;
 };
@@ -81,6 +179,7 @@ class ElementGuard {
     ~ElementGuard();
     std::shared_ptr<ast::Element> operator*();
     std::shared_ptr<ast::Element> operator->();
+    ast::Element* get() const;
 
     // Still protect the element, but don't try to collect garbage when
     // destroyed
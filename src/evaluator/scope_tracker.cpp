@@ -0,0 +1,35 @@
+#include "scope_tracker.h"
+
+namespace evaluator {
+
+void ScopeTracker::enter_scope(Parameters const& parameters, bool tracked) {
+    Frame frame{{}, tracked};
+    for (auto const& parameter : parameters.parameters) {
+        frame.variables.insert(parameter->value);
+    }
+    this->frames.push_back(std::move(frame));
+}
+
+void ScopeTracker::exit_scope() { this->frames.pop_back(); }
+
+size_t ScopeTracker::size() const { return this->frames.size(); }
+
+size_t ScopeTracker::find_frame(ast::Symbol const& variable) const {
+    for (size_t index = this->frames.size(); index > 0; --index) {
+        if (this->frames[index - 1].variables.contains(variable.value)) {
+            return index - 1;
+        }
+    }
+    return this->frames.size();
+}
+
+std::optional<size_t>
+ScopeTracker::find_tracked(ast::Symbol const& variable) const {
+    auto frame = this->find_frame(variable);
+    if (frame == this->frames.size() || !this->frames[frame].tracked) {
+        return std::nullopt;
+    }
+    return frame;
+}
+
+} // namespace evaluator
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../ast/element.h"
+#include "expression.h"
+
+namespace evaluator {
+
+// The scopes around the code an optimization visits, innermost last, which
+// tell apart variables of the same name declared by different scopes.
+//
+// A scope is tracked if no closure or `eval` can reach it, as only then all
+// assignments to its variables are visible in the code being visited.
+class ScopeTracker {
+    struct Frame {
+        std::unordered_set<std::string> variables;
+        bool tracked;
+    };
+
+    std::vector<Frame> frames;
+
+  public:
+    void enter_scope(Parameters const& parameters, bool tracked);
+    void exit_scope();
+
+    // Returns the number of scopes entered and not exited yet.
+    size_t size() const;
+    // Returns the index of the innermost frame declaring `variable`, or the
+    // number of frames if it is global.
+    size_t find_frame(ast::Symbol const& variable) const;
+    // Returns the index of the innermost frame declaring `variable` if that
+    // frame is tracked.
+    std::optional<size_t> find_tracked(ast::Symbol const& variable) const;
+};
+
+} // namespace evaluator
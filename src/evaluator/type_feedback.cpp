@@ -0,0 +1,119 @@
+#include <mutex>
+#include <sstream>
+
+#include "function.h"
+#include "type_feedback.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+
+TypeProfile::TypeProfile(ast::Span span, std::string site, size_t arguments)
+    : span(span), site(std::move(site)), arguments(arguments) {}
+
+bool TypeProfile::evaluated() {
+    return ++this->evaluations == TypeFeedback::HOT;
+}
+
+void TypeProfile::record(
+    std::span<std::shared_ptr<ast::Element> const> arguments
+) {
+    ++this->evaluations;
+    for (size_t index = 0;
+         index < arguments.size() && index < this->arguments.size();
+         ++index) {
+        this->record(index, arguments[index]->kind);
+    }
+}
+
+void TypeProfile::record_callee(Function const& function) {
+    if (this->polymorphic || this->callee == &function) {
+        return;
+    }
+    if (this->callee) {
+        this->polymorphic = true;
+        return;
+    }
+
+    this->callee = &function;
+    auto name = function.name();
+    this->callee_name = name.empty() ? "lambda" : std::string(name);
+}
+
+std::optional<ElementKind> TypeProfile::single_kind(
+    size_t index, std::span<ElementKind const> allowed
+) const {
+    for (auto kind : allowed) {
+        if (this->arguments[index].is(kind)) {
+            return kind;
+        }
+    }
+    return std::nullopt;
+}
+
+void TypeProfile::specialize(std::initializer_list<ElementKind> kinds) {
+    std::ostringstream stream;
+    bool first = true;
+    for (auto kind : kinds) {
+        stream << (first ? "" : ", ") << kind;
+        first = false;
+    }
+    this->specialization = stream.str();
+}
+
+std::ostream& operator<<(std::ostream& stream, TypeProfile const& self) {
+    stream << self.span << ' ' << self.site << ": " << self.evaluations
+           << " evaluations";
+
+    if (self.polymorphic) {
+        stream << ", polymorphic callee";
+    } else if (self.callee) {
+        stream << ", callee " << self.callee_name;
+    }
+
+    stream << ", arguments [";
+    for (size_t index = 0; index < self.arguments.size(); ++index) {
+        stream << (index == 0 ? "" : ", ") << self.arguments[index];
+    }
+    stream << ']';
+
+    if (!self.specialization.empty()) {
+        stream << ", specialized for " << self.specialization;
+    }
+    return stream;
+}
+
+std::ostream& operator<<(std::ostream& stream, TypeProfiles const& self) {
+    stream << "type profiles:";
+    bool first = true;
+    for (auto const& profile : self.profiles) {
+        if (profile->evaluations == 0) {
+            continue;
+        }
+        stream << "\n  " << *profile;
+        first = false;
+    }
+    if (first) {
+        stream << " none recorded";
+    }
+    return stream;
+}
+
+bool TypeFeedback::enabled = true;
+bool TypeFeedback::dumping = false;
+TypeProfiles TypeFeedback::recorded;
+
+std::shared_ptr<TypeProfile>
+TypeFeedback::profile(ast::Span span, std::string site, size_t arguments) {
+    auto profile =
+        std::make_shared<TypeProfile>(span, std::move(site), arguments);
+    if (TypeFeedback::dumping) {
+        // Functions optimized in the background create profiles too
+        static std::mutex mutex;
+        std::lock_guard lock(mutex);
+        TypeFeedback::recorded.profiles.push_back(profile);
+    }
+    return profile;
+}
+
+} // namespace evaluator
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../ast/element.h"
+#include "../ast/span.h"
+
+namespace evaluator {
+
+class Function;
+
+// What a call site saw at runtime: how many times it was evaluated, the kinds
+// of its arguments, and the functions it called.
+class TypeProfile {
+  public:
+    ast::Span span;
+    std::string site;
+    size_t evaluations = 0;
+    // Kinds of the arguments seen so far, by position
+    std::vector<ast::Kinds> arguments;
+    // The function called, until a second one is
+    Function const* callee = nullptr;
+    std::string callee_name;
+    bool polymorphic = false;
+    // How the site was specialized once hot, or an empty string
+    std::string specialization;
+
+    TypeProfile(ast::Span span, std::string site, size_t arguments);
+
+    // Counts an evaluation, and returns whether the site just became hot.
+    bool evaluated();
+    void record(size_t index, ast::ElementKind kind) {
+        this->arguments[index] = this->arguments[index] | kind;
+    }
+    void record(std::span<std::shared_ptr<ast::Element> const> arguments);
+    void record_callee(Function const& function);
+    // Returns the kind of all arguments at `index` seen so far if it is one
+    // of `allowed`.
+    std::optional<ast::ElementKind>
+    single_kind(size_t index, std::span<ast::ElementKind const> allowed) const;
+    // Notes that the site was specialized for arguments of `kinds`.
+    void specialize(std::initializer_list<ast::ElementKind> kinds);
+
+    friend std::ostream&
+    operator<<(std::ostream& stream, TypeProfile const& self);
+};
+
+// The profiles of the call sites created while dumping profiles is enabled.
+class TypeProfiles {
+  public:
+    std::vector<std::shared_ptr<TypeProfile>> profiles;
+
+    friend std::ostream&
+    operator<<(std::ostream& stream, TypeProfiles const& self);
+};
+
+// Specializes calls of arithmetic and comparison built-ins whose argument
+// kinds type inference couldn't predict, like `(less n 2)` where `n` is a
+// parameter, for the kinds they turn out to be called with. Each such call
+// records the kinds of its arguments, and once it has been evaluated `HOT`
+// times and always saw the same kinds it computes them natively. Arguments of
+// other kinds are still passed to the built-in itself.
+//
+// Calls of user-defined functions are only profiled, not specialized: their
+// `InlineCache` already finds the callee once per `Scope::version`, and the
+// call has to go through `UserDefinedFunction::call` to count it for the JIT
+// and background optimizer and to look up memoized results anyway.
+class TypeFeedback {
+  public:
+    static constexpr size_t HOT = 64;
+
+    static bool enabled;
+    // Whether other calls record profiles too, to be printed after evaluation
+    static bool dumping;
+    static TypeProfiles recorded;
+
+    // Returns a new profile for a call site, keeping it for dumping if that
+    // is enabled.
+    static std::shared_ptr<TypeProfile>
+    profile(ast::Span span, std::string site, size_t arguments);
+};
+
+} // namespace evaluator
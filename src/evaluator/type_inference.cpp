@@ -0,0 +1,197 @@
+#include "type_inference.h"
+#include "optimizer.h"
+
+namespace evaluator {
+
+using ast::Kinds;
+
+void TypeInference::Environment::join(Environment const& other) {
+    if (!other.reachable) {
+        return;
+    }
+    if (!this->reachable) {
+        *this = other;
+        return;
+    }
+
+    for (size_t index = 0; index < this->frames.size(); ++index) {
+        for (auto& [name, kinds] : this->frames[index].variables) {
+            kinds = kinds | other.frames[index].variables.at(name);
+        }
+    }
+}
+
+bool TypeInference::Environment::operator==(Environment const& other) const {
+    if (this->reachable != other.reachable) {
+        return false;
+    }
+    if (!this->reachable) {
+        return true;
+    }
+
+    for (size_t index = 0; index < this->frames.size(); ++index) {
+        if (this->frames[index].variables != other.frames[index].variables) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TypeInference::TypeInference(Optimizer& optimizer) : optimizer(optimizer) {}
+
+Optimizer& TypeInference::get_optimizer() { return this->optimizer; }
+
+ast::Kinds TypeInference::infer(std::unique_ptr<Expression>& expression) {
+    auto kinds = expression->infer_types(*this);
+    if (this->replacement) {
+        expression = std::move(this->replacement);
+    }
+    return kinds;
+}
+
+ast::Kinds TypeInference::infer(Body& body) {
+    Kinds kinds = ast::ElementKind::NULL_;
+    for (auto& expression : body.body) {
+        kinds = this->infer(expression);
+    }
+    return kinds;
+}
+
+ast::Kinds
+TypeInference::infer_loop(std::unique_ptr<Expression>& condition, Body& body) {
+    // Find the kinds variables have at the start of any iteration first, and
+    // only then specialize the loop for them.
+    bool rewriting = this->rewriting;
+    this->rewriting = false;
+
+    auto entry = this->environment;
+    while (true) {
+        this->enter_break_target();
+        this->infer(condition);
+        this->infer(body);
+        this->break_targets.pop_back();
+
+        auto next = entry;
+        next.join(this->environment);
+        if (next == entry) {
+            break;
+        }
+        entry = std::move(next);
+        this->environment = entry;
+    }
+
+    this->rewriting = rewriting;
+    this->environment = entry;
+
+    this->enter_break_target();
+    this->infer(condition);
+    auto exit = this->environment;
+    this->infer(body);
+    exit.join(this->break_targets.back().environment);
+    this->break_targets.pop_back();
+
+    this->environment = std::move(exit);
+    return ast::ElementKind::NULL_;
+}
+
+void TypeInference::infer_function(Parameters const& parameters, Body& body) {
+    auto environment = std::move(this->environment);
+    auto break_targets = std::move(this->break_targets);
+
+    this->environment = Environment();
+    this->break_targets.clear();
+    this->enter_scope(parameters, Kinds::all(), !body.may_capture_scope());
+    this->infer(body);
+
+    this->environment = std::move(environment);
+    this->break_targets = std::move(break_targets);
+}
+
+bool TypeInference::is_rewriting() const { return this->rewriting; }
+
+void TypeInference::replace_with(std::unique_ptr<Expression> expression) {
+    this->replacement = std::move(expression);
+}
+
+TypeInference::Environment TypeInference::save() const {
+    return this->environment;
+}
+
+void TypeInference::restore(Environment environment) {
+    this->environment = std::move(environment);
+}
+
+void TypeInference::join(Environment const& environment) {
+    this->environment.join(environment);
+}
+
+void TypeInference::enter_scope(
+    Parameters const& parameters, ast::Kinds kinds, bool tracked
+) {
+    Environment::Frame frame{{}, tracked};
+    for (auto const& parameter : parameters.parameters) {
+        frame.variables[parameter->value] = kinds;
+    }
+    this->environment.frames.push_back(std::move(frame));
+}
+
+void TypeInference::exit_scope() { this->environment.frames.pop_back(); }
+
+TypeInference::BreakTarget TypeInference::unreachable_target() const {
+    BreakTarget target{this->environment, Kinds()};
+    target.environment.reachable = false;
+    return target;
+}
+
+void TypeInference::enter_break_target() {
+    this->break_targets.push_back(this->unreachable_target());
+}
+
+ast::Kinds TypeInference::exit_break_target() {
+    auto target = std::move(this->break_targets.back());
+    this->break_targets.pop_back();
+    this->environment.join(target.environment);
+    return target.kinds;
+}
+
+ast::Kinds TypeInference::lookup(ast::Symbol const& variable) const {
+    auto const& frames = this->environment.frames;
+    for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame) {
+        auto found = frame->variables.find(variable.value);
+        if (found == frame->variables.end()) {
+            continue;
+        }
+        return frame->tracked ? found->second : Kinds::all();
+    }
+    return Kinds::all();
+}
+
+void TypeInference::assign(ast::Symbol const& variable, ast::Kinds kinds) {
+    if (!this->environment.reachable) {
+        return;
+    }
+
+    auto& frames = this->environment.frames;
+    for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame) {
+        auto found = frame->variables.find(variable.value);
+        if (found != frame->variables.end()) {
+            found->second = kinds;
+            return;
+        }
+    }
+}
+
+void TypeInference::diverge_with_return() {
+    this->environment.reachable = false;
+}
+
+void TypeInference::diverge_with_break(ast::Kinds kinds) {
+    auto& target = this->break_targets.back();
+    target.environment.join(this->environment);
+    if (this->environment.reachable) {
+        target.kinds = target.kinds | kinds;
+    }
+    this->environment.reachable = false;
+}
+
+} // namespace evaluator
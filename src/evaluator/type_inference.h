@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../ast/element.h"
+#include "../ast/kind.h"
+#include "expression.h"
+
+namespace evaluator {
+
+class Optimizer;
+
+// Infers which kinds of values expressions may evaluate to and specializes
+// calls to built-in functions whose argument kinds are known.
+//
+// Only variables of scopes that no closure or `eval` call can reach are
+// tracked, since only then all assignments to them are visible in the code
+// being analyzed. Everything else may hold any kind of value.
+class TypeInference {
+  public:
+    class Environment {
+        struct Frame {
+            std::unordered_map<std::string, ast::Kinds> variables;
+            bool tracked;
+        };
+
+        std::vector<Frame> frames;
+        bool reachable = true;
+
+        friend class TypeInference;
+
+      public:
+        void join(Environment const& other);
+        bool operator==(Environment const& other) const;
+    };
+
+  private:
+    struct BreakTarget {
+        Environment environment;
+        ast::Kinds kinds;
+    };
+
+    Optimizer& optimizer;
+    Environment environment;
+    std::vector<BreakTarget> break_targets;
+    bool rewriting = true;
+    std::unique_ptr<Expression> replacement;
+
+    BreakTarget unreachable_target() const;
+
+  public:
+    TypeInference(Optimizer& optimizer);
+
+    Optimizer& get_optimizer();
+
+    ast::Kinds infer(std::unique_ptr<Expression>& expression);
+    ast::Kinds infer(Body& body);
+    ast::Kinds infer_loop(std::unique_ptr<Expression>& condition, Body& body);
+    void infer_function(Parameters const& parameters, Body& body);
+
+    // Whether expressions may replace themselves with specialized versions.
+    // Inside loops, this is only allowed once the kinds of variables are final.
+    bool is_rewriting() const;
+    void replace_with(std::unique_ptr<Expression> expression);
+
+    Environment save() const;
+    void restore(Environment environment);
+    void join(Environment const& environment);
+
+    void enter_scope(Parameters const& parameters, ast::Kinds kinds, bool tracked);
+    void exit_scope();
+    void enter_break_target();
+    ast::Kinds exit_break_target();
+
+    ast::Kinds lookup(ast::Symbol const& variable) const;
+    void assign(ast::Symbol const& variable, ast::Kinds kinds);
+
+    void diverge_with_return();
+    void diverge_with_break(ast::Kinds kinds);
+};
+
+} // namespace evaluator
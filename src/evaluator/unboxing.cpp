@@ -0,0 +1,272 @@
+#include <utility>
+
+#include "unboxing.h"
+
+namespace evaluator {
+
+using ast::ElementKind;
+
+Unboxer::Mode Unboxer::get_mode() const { return this->mode; }
+
+void Unboxer::unbox(std::unique_ptr<Expression>& expression) {
+    ++this->depth;
+    auto replacement = expression->unbox(*this);
+    --this->depth;
+
+    if (replacement) {
+        expression = std::move(replacement);
+    }
+}
+
+void Unboxer::unbox(Body& body) {
+    for (auto& expression : body.body) {
+        this->unbox(expression);
+    }
+}
+
+std::unique_ptr<Expression> Unboxer::unbox_loop(
+    Expression const& loop, std::unique_ptr<Expression>& condition, Body& body
+) {
+    switch (this->mode) {
+    case Mode::ANALYZING:
+        this->unbox(condition);
+        this->unbox(body);
+        return nullptr;
+    case Mode::REWRITING:
+        return this->rewrite_loop(loop.span, condition, body, nullptr);
+    case Mode::SEARCHING:
+        break;
+    }
+
+    this->mode = Mode::ANALYZING;
+    this->eligible = true;
+    this->statement_depth = this->depth + 1;
+    this->unbox(condition);
+    this->unbox(body);
+    if (this->eligible) {
+        this->resolve();
+    }
+    this->mode = Mode::SEARCHING;
+
+    bool unboxes = false;
+    for (auto const& [key, candidate] : this->candidates) {
+        unboxes = unboxes || !candidate.excluded;
+    }
+
+    std::unique_ptr<Expression> unboxed;
+    if (this->eligible && unboxes) {
+        this->mode = Mode::REWRITING;
+        unboxed = this->rewrite_loop(loop.span, condition, body, loop.clone());
+        this->mode = Mode::SEARCHING;
+    }
+
+    this->guard = BuiltInGuard();
+    this->candidates.clear();
+    this->uses.clear();
+    this->assignments.clear();
+    this->assigned_first.clear();
+
+    if (!unboxed) {
+        // Loops nested in this one may still be unboxed on their own
+        this->unbox(condition);
+        this->unbox(body);
+    }
+    return unboxed;
+}
+
+std::unique_ptr<UnboxedWhile> Unboxer::rewrite_loop(
+    ast::Span span,
+    std::unique_ptr<Expression>& condition,
+    Body& body,
+    std::unique_ptr<Expression> fallback
+) {
+    auto native_condition = condition->unboxed(*this, ElementKind::BOOLEAN);
+    if (native_condition) {
+        condition = nullptr;
+    } else {
+        this->unbox(condition);
+    }
+    this->unbox(body);
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    BuiltInGuard guard;
+    if (fallback) {
+        for (auto& [key, candidate] : this->candidates) {
+            if (!candidate.excluded) {
+                slots.push_back(std::move(candidate.slot));
+            }
+        }
+        guard = std::move(this->guard);
+    }
+
+    return std::make_unique<UnboxedWhile>(
+        span,
+        std::move(slots),
+        std::move(guard),
+        std::move(native_condition),
+        std::move(condition),
+        Body(std::move(body.body)),
+        std::move(fallback)
+    );
+}
+
+void Unboxer::unbox_function(Parameters const& parameters, Body& body) {
+    auto scopes = std::exchange(this->scopes, ScopeTracker());
+
+    this->enter_scope(parameters, !body.may_capture_scope());
+    this->unbox(body);
+
+    this->scopes = std::move(scopes);
+}
+
+void Unboxer::enter_scope(Parameters const& parameters, bool tracked) {
+    this->scopes.enter_scope(parameters, tracked);
+}
+
+void Unboxer::exit_scope() { this->scopes.exit_scope(); }
+
+Unboxer::Candidate* Unboxer::find_candidate(ast::Symbol const& variable) {
+    Key key{this->scopes.find_frame(variable), variable.value};
+    auto found = this->candidates.find(key);
+    if (found == this->candidates.end() || found->second.excluded) {
+        return nullptr;
+    }
+    return &found->second;
+}
+
+std::optional<Unboxer::Key>
+Unboxer::add_candidate(std::shared_ptr<ast::Symbol> const& variable) {
+    auto frame = this->scopes.find_tracked(*variable);
+    if (!frame) {
+        return std::nullopt;
+    }
+
+    Key key{*frame, variable->value};
+    if (!this->candidates.contains(key)) {
+        this->candidates.emplace(
+            key, Candidate{std::make_unique<Slot>(variable)}
+        );
+    }
+    return key;
+}
+
+void Unboxer::exclude(Candidate& candidate) {
+    candidate.excluded = true;
+    this->changed = true;
+}
+
+void Unboxer::resolve() {
+    do {
+        this->changed = false;
+
+        // Reading variables natively settles their kinds
+        for (auto [expression, kind] : this->uses) {
+            expression->unboxed(*this, kind);
+        }
+
+        for (auto [key, initializer] : this->assignments) {
+            auto& candidate = this->candidates.at(key);
+            if (candidate.excluded) {
+                continue;
+            }
+            if (candidate.slot->kind == ElementKind::NULL_ ||
+                !initializer->unboxed(*this, candidate.slot->kind)) {
+                this->exclude(candidate);
+            }
+        }
+    } while (this->changed);
+
+    // Variables never read natively aren't worth unboxing
+    for (auto& [key, candidate] : this->candidates) {
+        if (candidate.slot->kind == ElementKind::NULL_) {
+            candidate.excluded = true;
+        }
+    }
+}
+
+void Unboxer::reject() {
+    if (this->mode == Mode::ANALYZING) {
+        this->eligible = false;
+    }
+}
+
+void Unboxer::assume(BuiltInGuard const& guard) {
+    if (this->mode == Mode::ANALYZING) {
+        this->guard.merge(guard);
+    }
+}
+
+void Unboxer::use(Expression const& expression, ElementKind kind) {
+    if (this->mode == Mode::ANALYZING) {
+        this->uses.emplace_back(&expression, kind);
+    }
+}
+
+void Unboxer::assign(
+    std::shared_ptr<ast::Symbol> const& variable, Expression const& initializer
+) {
+    if (this->mode != Mode::ANALYZING) {
+        return;
+    }
+
+    if (auto key = this->add_candidate(variable)) {
+        this->assignments.emplace_back(*key, &initializer);
+        if (this->depth == this->statement_depth) {
+            this->assigned_first.insert(*key);
+        }
+    } else {
+        // Assigning a variable other code can see may rebind a built-in
+        this->eligible = false;
+    }
+}
+
+std::unique_ptr<Expression>
+Unboxer::read(std::shared_ptr<ast::Symbol> const& variable) {
+    if (this->mode == Mode::ANALYZING) {
+        auto key = this->add_candidate(variable);
+        if (key && !this->assigned_first.contains(*key)) {
+            this->candidates.at(*key).slot->read_before_assigned = true;
+        }
+        return nullptr;
+    }
+
+    if (auto slot = this->slot(*variable)) {
+        return std::make_unique<Unboxed>(
+            std::make_unique<NativeSlot>(variable->span, slot)
+        );
+    }
+    return nullptr;
+}
+
+std::unique_ptr<Native>
+Unboxer::native_read(ast::Symbol const& variable, ElementKind kind) {
+    auto candidate = this->find_candidate(variable);
+    if (!candidate) {
+        return nullptr;
+    }
+
+    auto& slot = *candidate->slot;
+    if (slot.kind == ElementKind::NULL_ && this->mode == Mode::ANALYZING) {
+        slot.kind = kind;
+        this->changed = true;
+    }
+    if (slot.kind != kind) {
+        if (this->mode == Mode::ANALYZING) {
+            this->exclude(*candidate);
+        }
+        return nullptr;
+    }
+
+    return std::make_unique<NativeSlot>(variable.span, &slot);
+}
+
+Slot* Unboxer::slot(ast::Symbol const& variable) {
+    if (this->mode != Mode::REWRITING) {
+        return nullptr;
+    }
+
+    auto candidate = this->find_candidate(variable);
+    return candidate ? candidate->slot.get() : nullptr;
+}
+
+} // namespace evaluator
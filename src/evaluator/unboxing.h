@@ -0,0 +1,122 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../ast/element.h"
+#include "../ast/kind.h"
+#include "expression.h"
+#include "inline_cache.h"
+#include "scope_tracker.h"
+
+namespace evaluator {
+
+// Keeps integer and real variables of `while` loops in native slots while the
+// loops run, replacing loops with `UnboxedWhile`. Values are only boxed when
+// they escape: when passed to a built-in, returned, or used as the value of
+// an expression that isn't computed natively.
+//
+// A variable is kept unboxed if some specialized arithmetic or comparison in
+// the loop reads it as a number of a single kind, and every assignment to it
+// in the loop computes a number of that kind natively. Only variables of
+// scopes `ScopeTracker` tracks are considered.
+//
+// Loops that call functions other than pure built-ins, declare variables or
+// assign variables outside of such scopes are left alone, since they could
+// rebind the built-ins the native code relies on while it runs.
+//
+// Each loop is analyzed first without changing it, and only rewritten once
+// the variables to keep unboxed are known.
+class Unboxer {
+  public:
+    enum class Mode {
+        // Looking for loops to unbox
+        SEARCHING,
+        // Collecting uses and assignments of variables in a loop
+        ANALYZING,
+        // Rewriting a loop to use slots
+        REWRITING,
+    };
+
+  private:
+    struct Candidate {
+        std::unique_ptr<Slot> slot;
+        bool excluded = false;
+    };
+
+    using Key = std::pair<size_t, std::string>;
+
+    ScopeTracker scopes;
+    Mode mode = Mode::SEARCHING;
+
+    // The state of the outermost loop being analyzed or rewritten
+    bool eligible = true;
+    BuiltInGuard guard;
+    std::map<Key, Candidate> candidates;
+    // Expressions that specialized calls read as numbers of the given kind
+    std::vector<std::pair<Expression const*, ast::ElementKind>> uses;
+    std::vector<std::pair<Key, Expression const*>> assignments;
+    // Variables assigned by statements of the loop body visited so far, which
+    // are always evaluated before the following ones
+    std::set<Key> assigned_first;
+    size_t depth = 0;
+    size_t statement_depth = 0;
+    bool changed = false;
+
+    // Returns the candidate for `variable` if it may still be kept unboxed.
+    Candidate* find_candidate(ast::Symbol const& variable);
+    // Adds `variable` as a candidate if its scope is tracked, returning its key.
+    std::optional<Key> add_candidate(std::shared_ptr<ast::Symbol> const& variable
+    );
+    void exclude(Candidate& candidate);
+    // Excludes candidates until all uses and assignments of the remaining
+    // ones can be computed natively.
+    void resolve();
+    // Rewrites a loop in place for the current candidates. Only the outermost
+    // loop has a fallback, and takes over the slots and the guard.
+    std::unique_ptr<UnboxedWhile> rewrite_loop(
+        ast::Span span,
+        std::unique_ptr<Expression>& condition,
+        Body& body,
+        std::unique_ptr<Expression> fallback
+    );
+
+  public:
+    Mode get_mode() const;
+
+    void unbox(std::unique_ptr<Expression>& expression);
+    void unbox(Body& body);
+    // Returns the loop to replace `loop` with, if any.
+    std::unique_ptr<Expression> unbox_loop(
+        Expression const& loop, std::unique_ptr<Expression>& condition, Body& body
+    );
+    void unbox_function(Parameters const& parameters, Body& body);
+
+    void enter_scope(Parameters const& parameters, bool tracked);
+    void exit_scope();
+
+    // Marks the loop being analyzed as one that can't be unboxed.
+    void reject();
+    void assume(BuiltInGuard const& guard);
+    void use(Expression const& expression, ast::ElementKind kind);
+    void assign(
+        std::shared_ptr<ast::Symbol> const& variable,
+        Expression const& initializer
+    );
+
+    // Returns a boxed read of `variable` if it is kept unboxed.
+    std::unique_ptr<Expression>
+    read(std::shared_ptr<ast::Symbol> const& variable);
+    // Returns a native read of `variable` if it is kept unboxed as `kind`.
+    std::unique_ptr<Native>
+    native_read(ast::Symbol const& variable, ast::ElementKind kind);
+    // Returns the slot of `variable` if it is kept unboxed.
+    Slot* slot(ast::Symbol const& variable);
+};
+
+} // namespace evaluator
@@ -9,9 +9,11 @@ FuncFunction::FuncFunction(
     std::string name,
     Parameters parameters,
     std::shared_ptr<Body> body,
-    std::weak_ptr<Scope> scope
+    std::weak_ptr<Scope> scope,
+    std::shared_ptr<Scope> captured
 )
-    : UserDefinedFunction(span, parameters, body, scope), _name(name) {}
+    : UserDefinedFunction(span, parameters, body, scope, std::move(captured)),
+      _name(name) {}
 
 std::string_view FuncFunction::name() const { return this->_name; }
 
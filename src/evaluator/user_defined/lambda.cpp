@@ -8,9 +8,10 @@ LambdaFunction::LambdaFunction(
     ast::Span span,
     Parameters parameters,
     std::shared_ptr<Body> body,
-    std::weak_ptr<Scope> scope
+    std::weak_ptr<Scope> scope,
+    std::shared_ptr<Scope> captured
 )
-    : UserDefinedFunction(span, parameters, body, scope) {}
+    : UserDefinedFunction(span, parameters, body, scope, std::move(captured)) {}
 
 void LambdaFunction::_display_verbose(std::ostream& stream, size_t) const {
     stream << "LambdaFunction(" << this->span << ")";
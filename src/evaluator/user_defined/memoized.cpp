@@ -0,0 +1,22 @@
+#include "../function.h"
+
+namespace evaluator {
+
+MemoizedFunction::MemoizedFunction(std::shared_ptr<UserDefinedFunction> function)
+    : UserDefinedFunction(
+          function->span, function->parameters, function->body, function->scope
+      ),
+      function(function) {}
+
+bool MemoizedFunction::memoizes() const { return true; }
+
+std::string_view MemoizedFunction::name() const {
+    return this->function->name();
+}
+
+void MemoizedFunction::_display_verbose(std::ostream& stream, size_t) const {
+    stream << "MemoizedFunction(" << this->function->display_pretty() << ", "
+           << this->span << ")";
+}
+
+} // namespace evaluator
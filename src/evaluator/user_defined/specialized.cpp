@@ -0,0 +1,25 @@
+#include "../function.h"
+
+namespace evaluator {
+
+SpecializedFunction::SpecializedFunction(
+    std::shared_ptr<UserDefinedFunction> function,
+    Parameters parameters,
+    std::shared_ptr<Body> body,
+    std::shared_ptr<Scope> scope
+)
+    : UserDefinedFunction(
+          function->span, std::move(parameters), std::move(body), scope, scope
+      ),
+      function(std::move(function)) {}
+
+std::string_view SpecializedFunction::name() const {
+    return this->function->name();
+}
+
+void SpecializedFunction::_display_verbose(std::ostream& stream, size_t) const {
+    stream << "SpecializedFunction(" << this->function->display_pretty()
+           << ", " << this->span << ")";
+}
+
+} // namespace evaluator
@@ -1,6 +1,9 @@
+#include "../background_optimizer.h"
 #include "../control_flow.h"
 #include "../error.h"
 #include "../function.h"
+#include "../jit.h"
+#include "../purity.h"
 
 namespace evaluator {
 
@@ -8,11 +11,102 @@ UserDefinedFunction::UserDefinedFunction(
     ast::Span span,
     Parameters parameters,
     std::shared_ptr<Body> body,
-    std::weak_ptr<Scope> scope
+    std::weak_ptr<Scope> scope,
+    std::shared_ptr<Scope> captured
 )
-    : Function(span), parameters(parameters), body(body), scope(scope) {}
+    : Function(span), parameters(parameters), body(body), scope(scope),
+      captured(std::move(captured)) {}
 
 ElementGuard UserDefinedFunction::call(CallFrame frame) const {
+    if (this->source) {
+        this->tier_up(frame);
+    }
+
+    if (!this->memoizes() || !this->is_pure()) {
+        return this->invoke(frame);
+    }
+
+    if (!this->memo_table) {
+        this->memo_table = std::make_unique<MemoTable>();
+    }
+    if (auto result = this->memo_table->find(frame.arguments)) {
+        return frame.context.garbage_collector->temporary(result);
+    }
+
+    auto result = this->invoke(frame);
+    this->memo_table->insert(frame.arguments, *result);
+    return result;
+}
+
+bool UserDefinedFunction::is_pure() const {
+    if (this->purity_version != Scope::version) {
+        PurityAnalysis analysis;
+        this->pure = analysis.is_pure(*this);
+        this->purity_version = Scope::version;
+    }
+    return this->pure;
+}
+
+bool UserDefinedFunction::has_body(Body const& body) const {
+    return this->body.get() == &body;
+}
+
+void UserDefinedFunction::optimize_when_hot(std::shared_ptr<Func const> source
+) {
+    this->source = std::move(source);
+}
+
+void UserDefinedFunction::tier_up(CallFrame const& frame) const {
+    ++this->calls;
+
+    if (Jit::enabled && this->calls <= Jit::HOT) {
+        auto& kinds = this->argument_kinds;
+        kinds.resize(this->parameters.parameters.size());
+        if (frame.arguments.size() == kinds.size()) {
+            for (size_t index = 0; index < kinds.size(); ++index) {
+                kinds[index] = kinds[index] | frame.arguments[index]->kind;
+            }
+        }
+
+        if (this->calls == Jit::HOT) {
+            if (auto global = this->scope.lock()) {
+                this->native = Jit::compile(*this->source, kinds, *global);
+            }
+            kinds.clear();
+        }
+    }
+
+    if (!BackgroundOptimizer::enabled) {
+        if (this->calls >= Jit::HOT) {
+            this->source = nullptr;
+        }
+        return;
+    }
+
+    if (!this->optimization) {
+        if (this->calls == BackgroundOptimizer::HOT) {
+            if (auto global = this->scope.lock()) {
+                this->optimization =
+                    BackgroundOptimizer::submit(*this->source, *global);
+            }
+        }
+        return;
+    }
+
+    if (!this->optimization->done.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (auto body = this->optimization->result) {
+        this->replaced.push_back(std::move(this->body));
+        this->body = std::move(body);
+    }
+    this->optimization = nullptr;
+    this->source = nullptr;
+}
+
+bool UserDefinedFunction::memoizes() const { return MemoTable::automatic; }
+
+ElementGuard UserDefinedFunction::invoke(CallFrame const& frame) const {
     if (this->parameters.parameters.size() != frame.arguments.size()) {
         std::string message;
 
@@ -36,7 +130,15 @@ ElementGuard UserDefinedFunction::call(CallFrame frame) const {
             "collector dropped its parent scope too early. This is a bug."
         );
     }
-    auto scope = frame.context.garbage_collector->create_scope(parent_scope);
+
+    if (this->native) {
+        if (auto result = this->native->call(frame, *parent_scope)) {
+            return frame.context.garbage_collector->temporary(result);
+        }
+    }
+
+    auto scope =
+        this->body->create_scope(frame.context.garbage_collector, parent_scope);
 
     for (size_t parameter_index = 0;
          parameter_index < this->parameters.parameters.size();
@@ -49,7 +151,7 @@ ElementGuard UserDefinedFunction::call(CallFrame frame) const {
 
     try {
         return this->body->evaluate(
-            EvaluationContext(frame.context.garbage_collector, *scope)
+            EvaluationContext(frame.context.garbage_collector, scope.get())
         );
     } catch (ReturnControlFlow& e) {
         return std::move(e.element);
@@ -8,17 +8,33 @@
 
 #include "ast/element.h"
 #include "ast/span.h"
+#include "evaluator/background_optimizer.h"
+#include "evaluator/cpp_emitter.h"
 #include "evaluator/error.h"
 #include "evaluator/evaluator.h"
+#include "evaluator/inliner.h"
+#include "evaluator/jit.h"
+#include "evaluator/memoization.h"
+#include "evaluator/parse_cache.h"
+#include "evaluator/pass_manager.h"
+#include "evaluator/type_feedback.h"
 #include "reader/error.h"
 #include "reader/parser.h"
 #include "reader/scanner.h"
 
 using ast::Element;
 using ast::Position;
+using evaluator::BackgroundOptimizer;
+using evaluator::CppEmitter;
 using evaluator::EvaluationError;
 using evaluator::Evaluator;
+using evaluator::Inliner;
+using evaluator::Jit;
+using evaluator::MemoTable;
+using evaluator::ParseCache;
+using evaluator::PassManager;
 using evaluator::Program;
+using evaluator::TypeFeedback;
 using reader::Parser;
 using reader::Scanner;
 using reader::SyntaxError;
@@ -27,6 +43,7 @@ enum class Mode {
     LexicalAnalysis,
     SyntaxAnalysis,
     SemanticAnalysis,
+    EmitCpp,
     PrintResult,
     Silent,
     Auto,
@@ -34,6 +51,7 @@ enum class Mode {
 
 enum class ArgumentErrorCause {
     UnknownOption,
+    UnknownPass,
     ExtraArgument,
 };
 
@@ -52,6 +70,9 @@ class ArgumentError : public std::exception {
         case ArgumentErrorCause::UnknownOption:
             stream << "unknown option '" << error.argument << "'";
             break;
+        case ArgumentErrorCause::UnknownPass:
+            stream << "unknown optimization pass '" << error.argument << "'";
+            break;
         case ArgumentErrorCause::ExtraArgument:
             stream << "extra argument '" << error.argument << "'";
             break;
@@ -66,12 +87,38 @@ class Arguments {
     constexpr static const std::string_view LEXICAL = "--lexical";
     constexpr static const std::string_view SYNTAX = "--syntax";
     constexpr static const std::string_view SEMANTIC = "--semantic";
+    constexpr static const std::string_view EMIT_CPP = "--emit-cpp";
     constexpr static const std::string_view PRINT = "--print";
     constexpr static const std::string_view SILENT = "--silent";
     constexpr static const std::string_view AUTO = "--auto";
+    constexpr static const std::string_view NO_INLINE = "--no-inline";
+    constexpr static const std::string_view OPT_LEVEL = "-O";
+    constexpr static const std::string_view DUMP_IR = "--dump-ir=";
+    constexpr static const std::string_view PASS_STATS = "--pass-stats";
+    constexpr static const std::string_view NO_TYPE_FEEDBACK =
+        "--no-type-feedback";
+    constexpr static const std::string_view TYPE_PROFILE = "--type-profile";
+    constexpr static const std::string_view BACKGROUND = "--background";
+    constexpr static const std::string_view JIT = "--jit";
+    constexpr static const std::string_view PERF_MAP = "--perf-map";
+    constexpr static const std::string_view MEMOIZE = "--memoize";
+    constexpr static const std::string_view MEMO_STATS = "--memo-stats";
+    constexpr static const std::string_view EVAL_STATS = "--eval-stats";
 
   public:
     bool help = false;
+    bool inline_calls = true;
+    unsigned opt_level = PassManager::MAX_LEVEL;
+    std::string_view dump_ir;
+    bool pass_stats = false;
+    bool type_feedback = true;
+    bool type_profile = false;
+    bool background = false;
+    bool jit = false;
+    bool perf_map = false;
+    bool memoize = false;
+    bool memo_stats = false;
+    bool eval_stats = false;
     Mode mode = Mode::Auto;
     std::optional<std::string_view> file = std::nullopt;
 
@@ -92,12 +139,47 @@ class Arguments {
                     this->mode = Mode::SyntaxAnalysis;
                 } else if (argument == SEMANTIC) {
                     this->mode = Mode::SemanticAnalysis;
+                } else if (argument == EMIT_CPP) {
+                    this->mode = Mode::EmitCpp;
                 } else if (argument == PRINT) {
                     this->mode = Mode::PrintResult;
                 } else if (argument == SILENT) {
                     this->mode = Mode::Silent;
                 } else if (argument == AUTO) {
                     this->mode = Mode::Auto;
+                } else if (argument == NO_INLINE) {
+                    this->inline_calls = false;
+                } else if (argument.starts_with(OPT_LEVEL) &&
+                           argument.size() == OPT_LEVEL.size() + 1 &&
+                           argument.back() >= '0' &&
+                           static_cast<unsigned>(argument.back() - '0') <=
+                               PassManager::MAX_LEVEL) {
+                    this->opt_level = argument.back() - '0';
+                } else if (argument.starts_with(DUMP_IR)) {
+                    this->dump_ir = argument.substr(DUMP_IR.size());
+                    if (!PassManager::has_pass(this->dump_ir)) {
+                        throw ArgumentError(
+                            ArgumentErrorCause::UnknownPass, this->dump_ir
+                        );
+                    }
+                } else if (argument == PASS_STATS) {
+                    this->pass_stats = true;
+                } else if (argument == NO_TYPE_FEEDBACK) {
+                    this->type_feedback = false;
+                } else if (argument == TYPE_PROFILE) {
+                    this->type_profile = true;
+                } else if (argument == BACKGROUND) {
+                    this->background = true;
+                } else if (argument == JIT) {
+                    this->jit = true;
+                } else if (argument == PERF_MAP) {
+                    this->perf_map = true;
+                } else if (argument == MEMOIZE) {
+                    this->memoize = true;
+                } else if (argument == MEMO_STATS) {
+                    this->memo_stats = true;
+                } else if (argument == EVAL_STATS) {
+                    this->eval_stats = true;
                 } else {
                     throw ArgumentError(
                         ArgumentErrorCause::UnknownOption, argument
@@ -135,6 +217,11 @@ class Arguments {
                   << "\tParse the AST and print the program. Do "
                      "not process it further"
                   << std::endl;
+        std::cerr << "\t" << EMIT_CPP
+                  << "\tTranslate the program into C++ and print it. Built "
+                     "against the interpreter's library, it prints the "
+                     "result of the program"
+                  << std::endl;
         std::cerr << "\t" << PRINT
                   << "\t\tEvaluate the code and always print its "
                      "result. This is the default mode for REPL"
@@ -147,6 +234,57 @@ class Arguments {
                   << "\t\tKeep the default mode (--print for REPL and "
                      "--silent otherwise)"
                   << std::endl;
+        std::cerr << "\t" << NO_INLINE
+                  << "\tDo not replace calls to small user-defined functions "
+                     "with their bodies"
+                  << std::endl;
+        std::cerr << "\t" << OPT_LEVEL << "<level>"
+                  << "\tOptimize the code at the given level, from 0 (not at "
+                     "all) to "
+                  << PassManager::MAX_LEVEL << " (the default)" << std::endl;
+        std::cerr << "\t" << DUMP_IR << "<pass>"
+                  << "\tPrint the program after the given optimization pass. "
+                     "Passes are";
+        for (auto const& pass : PassManager::passes()) {
+            std::cerr << ' ' << pass.name << " (-O" << pass.level << ')';
+        }
+        std::cerr << std::endl;
+        std::cerr << "\t" << PASS_STATS
+                  << "\tPrint the time each optimization pass took after "
+                     "evaluation"
+                  << std::endl;
+        std::cerr << "\t" << NO_TYPE_FEEDBACK
+                  << "\tDo not specialize hot arithmetic and comparisons for "
+                     "the kinds of arguments they were called with"
+                  << std::endl;
+        std::cerr << "\t" << TYPE_PROFILE
+                  << "\tPrint the kinds of arguments and the functions each "
+                     "call was evaluated with after evaluation"
+                  << std::endl;
+        std::cerr << "\t" << BACKGROUND
+                  << "\tOptimize programs up to -O"
+                  << BackgroundOptimizer::EAGER_LEVEL
+                  << " before running them, and hot functions fully on a "
+                     "background thread"
+                  << std::endl;
+        std::cerr << "\t" << JIT
+                  << "\t\tCompile hot functions over integers, reals and "
+                     "booleans into x86-64 machine code"
+                  << std::endl;
+        std::cerr << "\t" << PERF_MAP
+                  << "\tWrite the functions compiled by " << JIT
+                  << " to /tmp/perf-<pid>.map for profilers" << std::endl;
+        std::cerr << "\t" << MEMOIZE
+                  << "\tCache results of calls to all pure user-defined "
+                     "functions, not only the ones passed to `memo`"
+                  << std::endl;
+        std::cerr << "\t" << MEMO_STATS
+                  << "\tPrint memoization statistics after evaluation"
+                  << std::endl;
+        std::cerr << "\t" << EVAL_STATS
+                  << "\tPrint statistics of the cache of expressions "
+                     "parsed by `eval` after evaluation"
+                  << std::endl;
     }
 };
 
@@ -194,9 +332,18 @@ void process(
 
         auto program = Program::parse(ast);
         if (mode == Mode::SemanticAnalysis) {
+            auto removed = evaluator.eliminate_dead_code(program);
             std::cout << program << std::endl;
+            std::cout << "; dead code elimination removed " << removed
+                      << " expressions" << std::endl;
+            return;
+        }
+        if (mode == Mode::EmitCpp) {
+            CppEmitter emitter;
+            emitter.emit(program, std::cout);
             return;
         }
+        evaluator.optimize(program);
         auto output = evaluator.evaluate(std::move(program));
 
         if (mode == Mode::PrintResult) {
@@ -281,11 +428,32 @@ int main(int argc, char const** argv) {
         return 0;
     }
 
+    Inliner::enabled = arguments.inline_calls;
+    PassManager::level = arguments.opt_level;
+    PassManager::dump_after = arguments.dump_ir;
+    TypeFeedback::enabled = arguments.type_feedback;
+    TypeFeedback::dumping = arguments.type_profile;
+    BackgroundOptimizer::enabled = arguments.background;
+    Jit::enabled = arguments.jit;
+    Jit::perf_map = arguments.perf_map;
+    MemoTable::automatic = arguments.memoize;
     if (arguments.file) {
         file(arguments.mode, *arguments.file);
     } else {
         repl(arguments.mode);
     }
+    if (arguments.memo_stats) {
+        std::cerr << MemoTable::statistics << std::endl;
+    }
+    if (arguments.eval_stats) {
+        std::cerr << ParseCache::statistics << std::endl;
+    }
+    if (arguments.pass_stats) {
+        std::cerr << PassManager::statistics << std::endl;
+    }
+    if (arguments.type_profile) {
+        std::cerr << TypeFeedback::recorded << std::endl;
+    }
 
     return 0;
 }
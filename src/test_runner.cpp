@@ -1,3 +1,5 @@
+#include <array>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -5,14 +7,22 @@
 #include <string>
 
 #include "ast/element.h"
+#include "evaluator/background_optimizer.h"
 #include "evaluator/error.h"
 #include "evaluator/evaluator.h"
 #include "evaluator/expression.h"
+#include "evaluator/jit.h"
+#include "evaluator/macros.h"
+#include "evaluator/pass_manager.h"
 #include "reader/error.h"
 #include "reader/reader.h"
 
+using evaluator::BackgroundOptimizer;
 using evaluator::EvaluationError;
 using evaluator::Evaluator;
+using evaluator::Jit;
+using evaluator::Macros;
+using evaluator::PassManager;
 using evaluator::Program;
 using reader::Reader;
 using reader::SyntaxError;
@@ -120,6 +130,9 @@ bool test_semantic_file(std::filesystem::path path) {
     buffer << file.rdbuf();
     std::string source(buffer.str());
 
+    // Macros of other files must not expand in this one
+    Macros::clear();
+
     std::vector<std::shared_ptr<ast::Element>> empty_program;
     Program program = Program::parse(empty_program);
 
@@ -128,6 +141,7 @@ bool test_semantic_file(std::filesystem::path path) {
 
     Evaluator evaluator;
 
+    evaluator.optimize(program);
     auto output = evaluator.evaluate(std::move(program));
 
     auto boolean = std::dynamic_pointer_cast<ast::Boolean>(*output);
@@ -143,6 +157,43 @@ bool test_semantic_file(std::filesystem::path path) {
     return boolean->value;
 }
 
+// Runs the program `--emit-cpp` translated the test into, which prints the
+// value of the program.
+bool test_emitted_file(
+    std::filesystem::path const& path, std::filesystem::path const& emitted
+) {
+    auto executable = emitted / path.parent_path().filename() / path.stem();
+    if (!std::filesystem::exists(executable)) {
+        std::cout << "this file was not translated into C++" << std::endl;
+        return false;
+    }
+
+    std::string command = "'";
+    command.append(executable.string()).append("' 2>&1");
+    auto pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        std::cout << "cannot run " << executable << std::endl;
+        return false;
+    }
+
+    std::string output;
+    std::array<char, 256> buffer;
+    while (auto read = std::fread(buffer.data(), 1, buffer.size(), pipe)) {
+        output.append(buffer.data(), read);
+    }
+    auto status = pclose(pipe);
+
+    if (status == 0 && output == "true\n") {
+        return true;
+    }
+    if (output == "false\n") {
+        std::cout << "this expression is evaluated to false\n";
+    } else {
+        std::cout << output;
+    }
+    return false;
+}
+
 std::vector<std::filesystem::path> get_paths(Mode mode) {
     std::vector<std::string_view> subdirectories;
 
@@ -168,11 +219,14 @@ std::vector<std::filesystem::path> get_paths(Mode mode) {
     return paths;
 }
 
-int test_files_semantic(std::vector<std::filesystem::path> paths) {
+int test_files_semantic(
+    std::vector<std::filesystem::path> const& paths,
+    std::string_view configuration
+) {
     int code = 0;
 
     for (auto&& path : paths) {
-        std::cout << path << ": ";
+        std::cout << path << configuration << ": ";
 
         bool passed = false;
         try {
@@ -195,6 +249,47 @@ int test_files_semantic(std::vector<std::filesystem::path> paths) {
     return code;
 }
 
+int test_files_emitted(
+    std::vector<std::filesystem::path> const& paths,
+    std::filesystem::path const& emitted
+) {
+    int code = 0;
+
+    for (auto&& path : paths) {
+        std::cout << path << " --emit-cpp: ";
+
+        if (test_emitted_file(path, emitted)) {
+            std::cout << "passed" << std::endl;
+        } else {
+            code = 1;
+        }
+    }
+
+    return code;
+}
+
+int test_files_semantic(std::vector<std::filesystem::path> const& paths) {
+    int code = 0;
+
+    // Every test is run at every optimization level, with hot functions
+    // optimized in the background, and with hot functions compiled to machine
+    // code
+    for (unsigned level = 0; level <= PassManager::MAX_LEVEL; ++level) {
+        PassManager::level = level;
+        code |= test_files_semantic(paths, " -O" + std::to_string(level));
+    }
+
+    BackgroundOptimizer::enabled = true;
+    code |= test_files_semantic(paths, " --background");
+    BackgroundOptimizer::enabled = false;
+
+    Jit::enabled = true;
+    code |= test_files_semantic(paths, " --jit");
+    Jit::enabled = false;
+
+    return code;
+}
+
 int test_files_syntax(std::vector<std::filesystem::path> paths) {
     int code = 0;
 
@@ -293,12 +388,21 @@ int main(int argc, char const** argv) {
         return 0;
     }
 
+    // Where CMake builds the tests translated into C++ when it's configured
+    // with `EMIT_CPP_TESTS`
+    auto emitted =
+        std::filesystem::path(program_name).parent_path() / "emitted";
+    bool translated = std::filesystem::is_directory(emitted);
+
     int code = 0;
 
     try {
         if (arguments.files.size()) {
             std::cout << "Tests:\n";
             code = test_files_semantic(arguments.files);
+            if (translated) {
+                code |= test_files_emitted(arguments.files, emitted);
+            }
         } else {
             std::cout << "Syntax tests: \n";
             if (test_files_syntax(get_paths(Mode::SYNTAX))) {
@@ -307,7 +411,11 @@ int main(int argc, char const** argv) {
 
             if (arguments.mode == Mode::SEMANTIC) {
                 std::cout << "\nSemantic tests: \n";
-                if (test_files_semantic(get_paths(Mode::SEMANTIC))) {
+                auto paths = get_paths(Mode::SEMANTIC);
+                if (test_files_semantic(paths)) {
+                    code = 1;
+                }
+                if (translated && test_files_emitted(paths, emitted)) {
                     code = 1;
                 }
             }